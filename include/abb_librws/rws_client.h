@@ -38,9 +38,11 @@
 #define RWS_CLIENT_H
 
 #include <deque>
+#include <map>
 #include <sstream>
 #include <vector>
 
+#include "Poco/Condition.h"
 #include "Poco/DOM/DOMParser.h"
 
 #include "rws_common.h"
@@ -85,6 +87,11 @@ public:
      */
     std::string error_message;
 
+    /**
+     * \brief The raw response content (shared with the communication result, i.e. not copied).
+     */
+    SharedBuffer content;
+
     /**
      * \brief A default constructor.
      */
@@ -290,6 +297,21 @@ public:
     ACTIVE ///< \brief Currently active coordinate.
   };
 
+  /**
+   * \brief An enumeration of the resource classes whose responses can be cached.
+   *
+   * A class' cached responses are invalidated when a modifying request to a related resource goes through the client.
+   */
+  enum CacheClass
+  {
+    CACHE_CONTROLLER,       ///< \brief Controller service and RobotWare system information.
+    CACHE_CONFIGURATION,    ///< \brief Configuration instances.
+    CACHE_MECHANICAL_UNITS, ///< \brief Static mechanical unit information.
+    CACHE_RAPID_PROGRAM,    ///< \brief RAPID modules and symbol properties (the tasks are never cached).
+    CACHE_PANEL,            ///< \brief Panel speed ratio (the controller state and operation mode are never cached).
+    CACHE_CLASSES           ///< \brief The number of cache classes (not a class).
+  };
+
   /**
    * \brief A constructor.
    *
@@ -300,7 +322,8 @@ public:
   POCOClient(ip_address,
              SystemConstants::General::DEFAULT_PORT_NUMBER,
              SystemConstants::General::DEFAULT_USERNAME,
-             SystemConstants::General::DEFAULT_PASSWORD)
+             SystemConstants::General::DEFAULT_PASSWORD),
+  modification_generation_(0)
   {}
 
   /**
@@ -315,7 +338,8 @@ public:
   POCOClient(ip_address,
              SystemConstants::General::DEFAULT_PORT_NUMBER,
              username,
-             password)
+             password),
+  modification_generation_(0)
   {}
 
   /**
@@ -329,7 +353,8 @@ public:
   POCOClient(ip_address,
              port,
              SystemConstants::General::DEFAULT_USERNAME,
-             SystemConstants::General::DEFAULT_PASSWORD)
+             SystemConstants::General::DEFAULT_PASSWORD),
+  modification_generation_(0)
   {}
 
   /**
@@ -348,7 +373,31 @@ public:
   POCOClient(ip_address,
              port,
              username,
-             password)
+             password),
+  modification_generation_(0)
+  {}
+
+  /**
+   * \brief A constructor, for a robot controller (or proxy) that may require HTTPS.
+   *
+   * \param ip_address specifying the robot controller's IP address.
+   * \param port for the port used by the RWS server.
+   * \param username for the username to the RWS authentication process.
+   * \param password for the password to the RWS authentication process.
+   * \param tls for the TLS options (i.e. if HTTPS should be used).
+   */
+  RWSClient(const std::string& ip_address,
+            const unsigned short port,
+            const std::string& username,
+            const std::string& password,
+            const TLSOptions& tls)
+  :
+  POCOClient(ip_address,
+             port,
+             username,
+             password,
+             tls),
+  modification_generation_(0)
   {}
 
   /**
@@ -356,6 +405,8 @@ public:
    */
   ~RWSClient()
   {
+    // Stop any session keeper first, so it does not log in again.
+    stopSessionKeeper();
     logout();
   }
 
@@ -453,6 +504,15 @@ public:
    */
   RWSResult getRAPIDSymbolData(const RAPIDResource& resource, RAPIDSymbolDataAbstract* p_data);
 
+  /**
+   * \brief A method for retrieving the data of several RAPID symbols, with the requests pipelined on one connection.
+   *
+   * \param resources specifying the RAPID task, module and symbol names for the RAPID resources.
+   *
+   * \return std::vector<RWSResult> containing the results, in the same order as the resources.
+   */
+  std::vector<RWSResult> getRAPIDSymbolsData(const std::vector<RAPIDResource>& resources);
+
   /**
    * \brief A method for retrieving the properties of a RAPID symbol.
    *
@@ -604,6 +664,18 @@ public:
    */
   RWSResult getFile(const FileResource& resource, std::string* p_file_content);
 
+  /**
+   * \brief A method for retrieving a file from the robot controller, streamed to a sink in fixed-size chunks.
+   *
+   * Note: Use this for large files (e.g. logs and backup archives), since the content is never held in memory.
+   *
+   * \param resource specifying the file's directory and name.
+   * \param sink for the sink to stream the file content to (e.g. a StreamSink or a FileDescriptorSink).
+   *
+   * \return RWSResult containing the result.
+   */
+  RWSResult getFile(const FileResource& resource, ContentSink& sink);
+
   /**
    * \brief A method for uploading a file to the robot controller.
    *
@@ -614,6 +686,19 @@ public:
    */
   RWSResult uploadFile(const FileResource& resource, const std::string& file_content);
 
+  /**
+   * \brief A method for uploading a file to the robot controller, streamed from a source.
+   *
+   * Note: Use this for large files, e.g. with a FileSource (a file path), a FileDescriptorSource or a MemorySource
+   *       (e.g. a memory mapped file), since the content is never copied into a string.
+   *
+   * \param resource specifying the file's directory and name.
+   * \param source for the source of the file's content.
+   *
+   * \return RWSResult containing the result.
+   */
+  RWSResult uploadFile(const FileResource& resource, ContentSource& source);
+
   /**
    * \brief A method for deleting a file from the robot controller.
    *
@@ -623,6 +708,15 @@ public:
    */
   RWSResult deleteFile(const FileResource& resource);
 
+  /**
+   * \brief A method for retrieving a directory listing (i.e. the files, with sizes and modification dates).
+   *
+   * \param directory specifying the directory on the robot controller (e.g. $home/modules).
+   *
+   * \return RWSResult containing the result.
+   */
+  RWSResult getDirectory(const std::string& directory);
+
   /**
    * \brief A method for starting for a subscription.
    *
@@ -694,6 +788,39 @@ public:
                                const std::string& application = SystemConstants::General::EXTERNAL_APPLICATION,
                                const std::string& location = SystemConstants::General::EXTERNAL_LOCATION);
 
+  /**
+   * \brief A method for setting the time to live for a resource class' cached responses.
+   *
+   * Caching is disabled (i.e. the TTL is 0) by default, for all resource classes.
+   *
+   * \param cache_class for the resource class.
+   * \param ttl for the time to live [microseconds]. 0 disables the caching (and clears the class' cache).
+   */
+  void setCacheTTL(const CacheClass cache_class, const Poco::Int64 ttl);
+
+  /**
+   * \brief A method for reading any resource (e.g. on behalf of another client), with GET coalescing and caching.
+   *
+   * The response is cached if the resource belongs to a resource class with caching enabled (see setCacheTTL).
+   *
+   * \param uri for the URI (path and query).
+   *
+   * \return POCOResult containing the (possibly shared, or cached) result.
+   */
+  POCOResult readResource(const std::string& uri);
+
+  /**
+   * \brief A method for invalidating all cached responses.
+   */
+  void invalidateCache();
+
+  /**
+   * \brief A method for invalidating a resource class' cached responses.
+   *
+   * \param cache_class for the resource class.
+   */
+  void invalidateCache(const CacheClass cache_class);
+
   /**
    * \brief Method for parsing a communication result into a XML document.
    *
@@ -751,6 +878,151 @@ private:
     std::vector<Poco::Net::HTTPResponse::HTTPStatus> accepted_outcomes;
   };
 
+  /**
+   * \brief A struct for representing a GET request in flight, which concurrent identical requests can join.
+   */
+  struct InFlightRequest
+  {
+    /**
+     * \brief A constructor.
+     *
+     * \param generation for the modification generation when the request was started.
+     * \param deadline_bound for indicating if the request is limited by its starting thread's deadline.
+     */
+    InFlightRequest(const Poco::UInt64 generation, const bool deadline_bound)
+    :
+    generation(generation),
+    deadline_bound(deadline_bound),
+    done(false)
+    {}
+
+    /**
+     * \brief The modification generation when the request was started.
+     */
+    Poco::UInt64 generation;
+
+    /**
+     * \brief Flag indicating if the request is limited by its starting thread's deadline (i.e. a timeout only applies
+     *        to that thread, and not to the threads that joined the request).
+     */
+    bool deadline_bound;
+
+    /**
+     * \brief Flag indicating if the request has completed.
+     */
+    bool done;
+
+    /**
+     * \brief The request's result (valid when done).
+     */
+    POCOResult result;
+  };
+
+  /**
+   * \brief A struct for representing a cached response.
+   */
+  struct CacheEntry
+  {
+    /**
+     * \brief The cached result.
+     */
+    POCOResult result;
+
+    /**
+     * \brief The time when the entry expires.
+     */
+    Poco::Timestamp expires;
+  };
+
+  /**
+   * \brief A struct for representing the cache of a resource class.
+   */
+  struct ClassCache
+  {
+    /**
+     * \brief A default constructor.
+     */
+    ClassCache() : ttl(0), generation(0) {}
+
+    /**
+     * \brief The time to live for the class' responses [microseconds] (0 if caching is disabled).
+     */
+    Poco::Int64 ttl;
+
+    /**
+     * \brief Counter of invalidations, used to avoid caching responses that were requested before an invalidation.
+     */
+    Poco::UInt64 generation;
+
+    /**
+     * \brief The cached responses, keyed by URI.
+     */
+    std::map<std::string, CacheEntry> entries;
+  };
+
+  /**
+   * \brief A method for sending a HTTP GET request, or using a cached response (if caching is enabled for the class).
+   *
+   * \param uri for the URI (path and query).
+   * \param cache_class for the resource class.
+   *
+   * \return POCOResult containing the (possibly cached) result.
+   */
+  POCOResult cachedGet(const std::string& uri, const CacheClass cache_class);
+
+  /**
+   * \brief A method for finding the resource class of a resource.
+   *
+   * \param uri for the resource's URI (path and query).
+   * \param p_cache_class for storing the resource class.
+   *
+   * \return bool indicating if the resource belongs to a resource class or not.
+   */
+  static bool findCacheClass(const std::string& uri, CacheClass* p_cache_class);
+
+  /**
+   * \brief A method for checking if a modifying request may affect a resource class' responses.
+   *
+   * \param cache_class for the resource class.
+   * \param uri for the modifying request's URI (path and query).
+   *
+   * \return bool indicating if the resource class is affected or not.
+   */
+  static bool affectsCacheClass(const CacheClass cache_class, const std::string& uri);
+
+  /**
+   * \brief A method called before, and after, each request that may modify the controller's resources.
+   *
+   * GET requests in flight are not joined after this, since they may have been read before the modification, and
+   * any affected cached responses are invalidated.
+   *
+   * \param uri for the request's URI (path and query).
+   */
+  void onModifyingRequest(const std::string& uri);
+
+  /**
+   * \brief A method for sending a HTTP GET request, or joining an identical request already in flight.
+   *
+   * Identical requests (same URI and priority) made concurrently by several threads share one round-trip. A request
+   * is only joined if it was started after the latest modifying request made through this client.
+   *
+   * \param uri for the URI (path and query).
+   *
+   * \return POCOResult containing the (shared) result.
+   */
+  POCOResult coalescedGet(const std::string& uri);
+
+  /**
+   * \brief A method for completing an in-flight request, and waking up the threads that joined it.
+   *
+   * \param key for the request's key.
+   * \param p_request for the request.
+   * \param result for the request's result.
+   */
+  void completeInFlightRequest(const std::string& key,
+                               const Poco::SharedPtr<InFlightRequest>& p_request,
+                               const POCOResult& result);
+
   /**
    * \brief Method for checking a communication result against the accepted outcomes.
    *
@@ -830,6 +1102,11 @@ private:
    */
   static const size_t LOG_SIZE = 20;
 
+  /**
+   * \brief Static constant for the maximum number of cached responses, per resource class.
+   */
+  static const size_t MAX_CACHE_ENTRIES = 256;
+
   /**
    * \brief Static constant for the default RWS subscription timeout [microseconds].
    */
@@ -840,6 +1117,41 @@ private:
    */
   std::deque<POCOResult> log_;
 
+  /**
+   * \brief A mutex for protecting the log.
+   */
+  Poco::Mutex log_mutex_;
+
+  /**
+   * \brief A mutex for protecting the in-flight requests and the modification generation.
+   */
+  Poco::Mutex coalescing_mutex_;
+
+  /**
+   * \brief A condition for signaling completed in-flight requests.
+   */
+  Poco::Condition coalescing_condition_;
+
+  /**
+   * \brief GET requests in flight, keyed by priority and URI.
+   */
+  std::map<std::string, Poco::SharedPtr<InFlightRequest> > in_flight_requests_;
+
+  /**
+   * \brief Counter of modifying requests, used to avoid joining GET requests that may be outdated.
+   */
+  Poco::UInt64 modification_generation_;
+
+  /**
+   * \brief A mutex for protecting the response caches.
+   */
+  Poco::Mutex cache_mutex_;
+
+  /**
+   * \brief The response caches, per resource class.
+   */
+  ClassCache caches_[CACHE_CLASSES];
+
   /**
    * \brief A subscription group id.
    */
@@ -0,0 +1,208 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_CLIENT_REGISTRY_H
+#define RWS_CLIENT_REGISTRY_H
+
+#include <map>
+#include <string>
+
+#include "Poco/Mutex.h"
+#include "Poco/SharedPtr.h"
+
+#include "rws_client.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief A class for a process-wide registry of RWS clients, shared per robot controller.
+ *
+ * All shared handles for the same robot controller address, port, credentials and TLS options share one RWS client,
+ * i.e. one authenticated RWS session, connection, cookie jar, response cache and admission control. The client is
+ * created by the first handle, and is logged out and destroyed when the last handle is released. Opening a handle for
+ * an already connected robot controller is therefore nearly free, and does not use another of the controller's RWS
+ * session slots.
+ *
+ * Note: A client has a single subscription (i.e. WebSocket), and a single set of settings (e.g. timeouts, transport
+ *       options, compression, cache time to live, admission control and session keeper). These are not fanned out per
+ *       handle, so a subscription or setting made through one handle would affect all handles of a shared client.
+ *       Users of shared handles (e.g. RWSInterface) must therefore refuse subscriptions and settings, see shared().
+ *       Sharing is opt-in, and a handle that is not shared owns a private client.
+ */
+class RWSClientRegistry
+{
+public:
+  /**
+   * \brief A class for a reference counted handle to a shared RWS client.
+   */
+  class Handle
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param ip_address specifying the robot controller's IP address.
+     * \param port for the port used by the RWS server.
+     * \param username for the username to the RWS authentication process.
+     * \param password for the password to the RWS authentication process.
+     * \param tls for the TLS options (i.e. if HTTPS should be used).
+     * \param shared indicating if the client should be shared (via the registry), or private to the handle.
+     */
+    Handle(const std::string& ip_address,
+           const unsigned short port,
+           const std::string& username,
+           const std::string& password,
+           const POCOClient::TLSOptions& tls = POCOClient::TLSOptions(),
+           const bool shared = true);
+
+    /**
+     * \brief A destructor, which releases the shared client (destroying it if this was the last handle).
+     */
+    ~Handle();
+
+    /**
+     * \brief A method for accessing the shared client.
+     *
+     * \return RWSClient& to the shared client.
+     */
+    RWSClient& client() { return *p_client_; }
+
+    /**
+     * \brief A method for checking if the client is shared (via the registry), or private to the handle.
+     *
+     * \return bool indicating if the client is shared.
+     */
+    bool shared() const { return !key_.empty(); }
+
+  private:
+    /**
+     * \brief Handles can not be copied.
+     */
+    Handle(const Handle&);
+
+    /**
+     * \brief Handles can not be assigned.
+     */
+    Handle& operator=(const Handle&);
+
+    /**
+     * \brief The registry key of the shared client (empty if the client is private).
+     */
+    std::string key_;
+
+    /**
+     * \brief The shared client.
+     */
+    Poco::SharedPtr<RWSClient> p_client_;
+  };
+
+  /**
+   * \brief A method for retrieving the number of handles for a robot controller.
+   *
+   * \param ip_address specifying the robot controller's IP address.
+   * \param port for the port used by the RWS server.
+   * \param username for the username to the RWS authentication process.
+   * \param password for the password to the RWS authentication process.
+   * \param tls for the TLS options.
+   *
+   * \return size_t containing the number of shared handles (0 if there is no shared client).
+   */
+  static size_t handles(const std::string& ip_address,
+                        const unsigned short port,
+                        const std::string& username,
+                        const std::string& password,
+                        const POCOClient::TLSOptions& tls = POCOClient::TLSOptions());
+
+private:
+  /**
+   * \brief A struct for representing a registered client.
+   */
+  struct Entry
+  {
+    /**
+     * \brief A default constructor.
+     */
+    Entry() : handles(0) {}
+
+    /**
+     * \brief The shared client.
+     */
+    Poco::SharedPtr<RWSClient> p_client;
+
+    /**
+     * \brief The number of handles to the client.
+     */
+    size_t handles;
+  };
+
+  /**
+   * \brief A method for generating the registry key of a robot controller.
+   *
+   * \param ip_address specifying the robot controller's IP address.
+   * \param port for the port used by the RWS server.
+   * \param username for the username to the RWS authentication process.
+   * \param password for the password to the RWS authentication process.
+   * \param tls for the TLS options.
+   *
+   * \return std::string containing the key.
+   */
+  static std::string generateKey(const std::string& ip_address,
+                                 const unsigned short port,
+                                 const std::string& username,
+                                 const std::string& password,
+                                 const POCOClient::TLSOptions& tls);
+
+  /**
+   * \brief A method for accessing the registry's mutex.
+   *
+   * \return Poco::Mutex& to the mutex.
+   */
+  static Poco::Mutex& mutex();
+
+  /**
+   * \brief A method for accessing the registered clients.
+   *
+   * \return std::map<std::string, Entry>& to the registered clients, keyed by registry key.
+   */
+  static std::map<std::string, Entry>& entries();
+};
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
@@ -447,6 +447,21 @@ struct SystemConstants
        */
       static const XMLAttribute CLASS_EXCSTATE;
 
+      /**
+       * \brief Class & fs-file (a file in a file service directory listing).
+       */
+      static const XMLAttribute CLASS_FS_FILE;
+
+      /**
+       * \brief Class & fs-mdate (a file's modification date).
+       */
+      static const XMLAttribute CLASS_FS_MDATE;
+
+      /**
+       * \brief Class & fs-size (a file's size).
+       */
+      static const XMLAttribute CLASS_FS_SIZE;
+
       /**
        * \brief Class & ios-signal.
        */
@@ -573,6 +588,21 @@ struct SystemConstants
        */
       static const std::string EXCSTATE;
 
+      /**
+       * \brief File service file.
+       */
+      static const std::string FS_FILE;
+
+      /**
+       * \brief File service file modification date.
+       */
+      static const std::string FS_MDATE;
+
+      /**
+       * \brief File service file size.
+       */
+      static const std::string FS_SIZE;
+
       /**
        * \brief Home directory.
        */
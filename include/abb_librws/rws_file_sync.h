@@ -0,0 +1,342 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_FILE_SYNC_H
+#define RWS_FILE_SYNC_H
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Poco/Mutex.h"
+#include "Poco/Runnable.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Types.h"
+
+#include "rws_client.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief A class for incrementally synchronizing a local directory to a directory on a robot controller.
+ *
+ * A local manifest records, for each synchronized file, the local size, modification time and content hash, together
+ * with the remote modification date. A sync lists the remote directory once, and only uploads files that are missing
+ * remotely, or whose local content or remote state differ from the manifest. The uploads run in parallel, each
+ * uploader with its own RWS session. Unchanged deployments therefore complete with a single listing request.
+ */
+class RWSFileSync
+{
+public:
+  /**
+   * \brief A struct for containing the result of a sync.
+   */
+  struct Result
+  {
+    /**
+     * \brief A default constructor.
+     */
+    Result() : success(false), files_unchanged(0) {}
+
+    /**
+     * \brief Flag indicating if the sync was successful (i.e. the remote directory could be listed, and all changed
+     *        files were uploaded).
+     */
+    bool success;
+
+    /**
+     * \brief Number of files that were already up to date.
+     */
+    size_t files_unchanged;
+
+    /**
+     * \brief Names of the files that were uploaded.
+     */
+    std::vector<std::string> uploaded_files;
+
+    /**
+     * \brief Names of the files that failed to be uploaded.
+     */
+    std::vector<std::string> failed_files;
+  };
+
+  /**
+   * \brief A constructor.
+   *
+   * \param ip_address specifying the robot controller's IP address.
+   * \param port for the port used by the RWS server.
+   * \param username for the username to the RWS authentication process.
+   * \param password for the password to the RWS authentication process.
+   * \param number_of_uploaders for the maximum number of parallel uploads (i.e. RWS sessions).
+   */
+  RWSFileSync(const std::string& ip_address,
+              const unsigned short port,
+              const std::string& username,
+              const std::string& password,
+              const size_t number_of_uploaders = DEFAULT_NUMBER_OF_UPLOADERS);
+
+  /**
+   * \brief A method for synchronizing the files of a local directory (not recursively) to the robot controller.
+   *
+   * \param local_directory for the local directory.
+   * \param remote_directory for the directory on the robot controller (e.g. $home/modules).
+   * \param manifest_path for the path of the local manifest file. It is created if it does not exist.
+   *
+   * \return Result containing the result.
+   */
+  Result sync(const std::string& local_directory,
+              const std::string& remote_directory,
+              const std::string& manifest_path);
+
+private:
+  /**
+   * \brief A struct for representing a manifest entry (i.e. the state of a file after it was last synchronized).
+   */
+  struct ManifestEntry
+  {
+    /**
+     * \brief A default constructor.
+     */
+    ManifestEntry() : size(0), modified(0) {}
+
+    /**
+     * \brief The local file's size [bytes].
+     */
+    Poco::UInt64 size;
+
+    /**
+     * \brief The local file's modification time [microseconds since the epoch].
+     */
+    Poco::Int64 modified;
+
+    /**
+     * \brief The local file's content hash (SHA-1, in hex).
+     */
+    std::string hash;
+
+    /**
+     * \brief The remote file's modification date.
+     */
+    std::string remote_modified;
+  };
+
+  /**
+   * \brief A struct for representing a file in a remote directory listing.
+   */
+  struct RemoteFile
+  {
+    /**
+     * \brief A default constructor.
+     */
+    RemoteFile() : size(0) {}
+
+    /**
+     * \brief The file's size [bytes].
+     */
+    Poco::UInt64 size;
+
+    /**
+     * \brief The file's modification date.
+     */
+    std::string modified;
+  };
+
+  /**
+   * \brief A struct for containing the upload jobs of a sync, shared by the uploaders.
+   */
+  struct UploadJobs
+  {
+    /**
+     * \brief A mutex for protecting the jobs.
+     */
+    Poco::Mutex mutex;
+
+    /**
+     * \brief The local directory.
+     */
+    std::string local_directory;
+
+    /**
+     * \brief The remote directory.
+     */
+    std::string remote_directory;
+
+    /**
+     * \brief Names of the files that remain to be uploaded.
+     */
+    std::deque<std::string> pending;
+
+    /**
+     * \brief Names of the files that were uploaded.
+     */
+    std::vector<std::string> uploaded;
+
+    /**
+     * \brief Names of the files that failed to be uploaded.
+     */
+    std::vector<std::string> failed;
+  };
+
+  /**
+   * \brief A class for an uploader, which uploads pending files (with its own client) until none remain.
+   */
+  class Uploader : public Poco::Runnable
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param client for the client to upload with.
+     * \param jobs for the shared upload jobs.
+     */
+    Uploader(RWSClient& client, UploadJobs& jobs) : client_(client), jobs_(jobs) {}
+
+    /**
+     * \brief The uploader's main loop.
+     */
+    void run();
+
+  private:
+    /**
+     * \brief The client to upload with.
+     */
+    RWSClient& client_;
+
+    /**
+     * \brief The shared upload jobs.
+     */
+    UploadJobs& jobs_;
+  };
+
+  /**
+   * \brief A typedef for a manifest (i.e. entries by file name).
+   */
+  typedef std::map<std::string, ManifestEntry> Manifest;
+
+  /**
+   * \brief A typedef for a remote directory listing (i.e. files by name).
+   */
+  typedef std::map<std::string, RemoteFile> RemoteListing;
+
+  /**
+   * \brief A method for listing a remote directory.
+   *
+   * \param directory for the remote directory.
+   * \param p_listing for storing the listing.
+   *
+   * \return bool indicating if the listing was successful or not.
+   */
+  bool listRemoteDirectory(const std::string& directory, RemoteListing* p_listing);
+
+  /**
+   * \brief A method for uploading files in parallel.
+   *
+   * \param jobs for the upload jobs.
+   */
+  void upload(UploadJobs& jobs);
+
+  /**
+   * \brief A method for loading a manifest. A missing or malformed manifest results in an empty one.
+   *
+   * \param path for the manifest's path.
+   *
+   * \return Manifest containing the loaded entries.
+   */
+  static Manifest loadManifest(const std::string& path);
+
+  /**
+   * \brief A method for saving a manifest.
+   *
+   * \param path for the manifest's path.
+   * \param manifest for the manifest to save.
+   *
+   * \return bool indicating if the manifest was saved or not.
+   */
+  static bool saveManifest(const std::string& path, const Manifest& manifest);
+
+  /**
+   * \brief A method for computing the content hash (SHA-1, in hex) of a file.
+   *
+   * \param path for the file's path.
+   *
+   * \return std::string containing the hash. Empty if the file could not be read.
+   */
+  static std::string hashFile(const std::string& path);
+
+  /**
+   * \brief Static constant for the default maximum number of parallel uploads.
+   */
+  static const size_t DEFAULT_NUMBER_OF_UPLOADERS = 4;
+
+  /**
+   * \brief The robot controller's IP address.
+   */
+  std::string ip_address_;
+
+  /**
+   * \brief The RWS server's port.
+   */
+  unsigned short port_;
+
+  /**
+   * \brief The username to the RWS authentication process.
+   */
+  std::string username_;
+
+  /**
+   * \brief The password to the RWS authentication process.
+   */
+  std::string password_;
+
+  /**
+   * \brief The maximum number of parallel uploads.
+   */
+  size_t number_of_uploaders_;
+
+  /**
+   * \brief The clients (i.e. RWS sessions), created when needed and kept between syncs. The first is also used for
+   *        the listings.
+   */
+  std::vector<Poco::SharedPtr<RWSClient> > clients_;
+};
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
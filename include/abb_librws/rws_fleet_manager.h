@@ -0,0 +1,634 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_FLEET_MANAGER_H
+#define RWS_FLEET_MANAGER_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Poco/Event.h"
+#include "Poco/Mutex.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+
+#include "rws_client.h"
+#include "rws_common.h"
+#include "rws_poco_async_client.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief A class for managing the RWS communication with a fleet of robot controllers, on a bounded number of threads.
+ *
+ * Controllers are registered by address, and resources can be polled periodically (fleet-wide or per controller) and
+ * subscribed to. All controllers share one event loop (see POCOEventLoop) and a limit for the number of requests in
+ * flight, and the polling is scheduled by one thread. The latest result of each polled resource is stored, and can be
+ * retrieved per controller or aggregated over the fleet.
+ *
+ * Listener notifications are delivered from the scheduling thread, and never while any internal lock is held.
+ */
+class RWSFleetManager
+{
+public:
+  /**
+   * \brief Typedef for controller identifiers.
+   */
+  typedef size_t ControllerId;
+
+  /**
+   * \brief A struct for containing the latest result for a resource.
+   */
+  struct ResourceSnapshot
+  {
+    /**
+     * \brief A default constructor.
+     */
+    ResourceSnapshot() : success(false), status(Poco::Net::HTTPResponse::HTTP_OK), timestamp(0) {}
+
+    /**
+     * \brief Flag indicating if the latest request succeeded (i.e. was responded to with HTTP 200 OK).
+     */
+    bool success;
+
+    /**
+     * \brief The latest HTTP response status.
+     */
+    Poco::Net::HTTPResponse::HTTPStatus status;
+
+    /**
+     * \brief The latest response content (shared with the communication result, i.e. not copied).
+     */
+    SharedBuffer content;
+
+    /**
+     * \brief The latest error message (if the request failed).
+     */
+    std::string error_message;
+
+    /**
+     * \brief Time when the latest result was received.
+     */
+    Poco::Timestamp timestamp;
+  };
+
+  /**
+   * \brief A struct for containing fleet-wide statistics.
+   */
+  struct Statistics
+  {
+    /**
+     * \brief A default constructor.
+     */
+    Statistics()
+    :
+    requests_sent(0),
+    requests_succeeded(0),
+    requests_failed(0),
+    polls_deferred(0),
+    subscription_events(0),
+    requests_in_flight(0)
+    {}
+
+    /**
+     * \brief Number of sent requests.
+     */
+    Poco::UInt64 requests_sent;
+
+    /**
+     * \brief Number of requests that succeeded.
+     */
+    Poco::UInt64 requests_succeeded;
+
+    /**
+     * \brief Number of requests that failed.
+     */
+    Poco::UInt64 requests_failed;
+
+    /**
+     * \brief Number of due polls that were deferred, because of the limit for requests in flight.
+     */
+    Poco::UInt64 polls_deferred;
+
+    /**
+     * \brief Number of received subscription events.
+     */
+    Poco::UInt64 subscription_events;
+
+    /**
+     * \brief Number of requests currently in flight.
+     */
+    size_t requests_in_flight;
+  };
+
+  /**
+   * \brief An interface for receiving fleet notifications. The default implementations ignore the notifications.
+   */
+  class Listener
+  {
+  public:
+    /**
+     * \brief A destructor.
+     */
+    virtual ~Listener() {}
+
+    /**
+     * \brief A method called when a new result for a polled resource has been received.
+     *
+     * \param id for the controller's id.
+     * \param uri for the resource's URI.
+     * \param snapshot containing the result.
+     */
+    virtual void onResourceUpdate(const ControllerId id, const std::string& uri, const ResourceSnapshot& snapshot) {}
+
+    /**
+     * \brief A method called when a subscription event (or failure) has been received.
+     *
+     * \param id for the controller's id.
+     * \param result containing the received WebSocket frame (or the failure).
+     */
+    virtual void onSubscriptionEvent(const ControllerId id, const POCOClient::POCOResult& result) {}
+  };
+
+  /**
+   * \brief A constructor.
+   *
+   * \param number_of_threads specifying the number of event loop threads, shared by all controllers.
+   * \param max_requests_in_flight specifying the fleet-wide limit for the number of requests in flight.
+   */
+  RWSFleetManager(const size_t number_of_threads = 2, const size_t max_requests_in_flight = 128);
+
+  /**
+   * \brief A destructor, which stops the manager.
+   */
+  ~RWSFleetManager();
+
+  /**
+   * \brief A method for starting the event loop and the scheduling.
+   */
+  void start();
+
+  /**
+   * \brief A method for stopping the scheduling and the event loop, and closing all connections.
+   */
+  void stop();
+
+  /**
+   * \brief A method for setting the listener for fleet notifications.
+   *
+   * \param p_listener for the listener (null to disable notifications).
+   */
+  void setListener(Listener* p_listener);
+
+  /**
+   * \brief A method for registering a controller.
+   *
+   * \param ip_address for the controller's IP address.
+   * \param port for the controller's RWS port.
+   * \param username for the username to the controller's authentication process.
+   * \param password for the password to the controller's authentication process.
+   *
+   * \return ControllerId containing the controller's id.
+   */
+  ControllerId registerController(const std::string& ip_address,
+                                  const unsigned short port = SystemConstants::General::DEFAULT_PORT_NUMBER,
+                                  const std::string& username = SystemConstants::General::DEFAULT_USERNAME,
+                                  const std::string& password = SystemConstants::General::DEFAULT_PASSWORD);
+
+  /**
+   * \brief A method for unregistering a controller. Its connections are closed.
+   *
+   * \param id for the controller's id.
+   */
+  void unregisterController(const ControllerId id);
+
+  /**
+   * \brief A method for retrieving the ids of all registered controllers.
+   *
+   * \return std::vector<ControllerId> containing the ids.
+   */
+  std::vector<ControllerId> getControllers();
+
+  /**
+   * \brief A method for polling a resource periodically on all (current and future) controllers.
+   *
+   * \param uri for the resource's URI (path and query).
+   * \param period for the polling period [microseconds].
+   */
+  void addPolledResource(const std::string& uri, const Poco::Int64 period);
+
+  /**
+   * \brief A method for polling a resource periodically on one controller.
+   *
+   * \param id for the controller's id.
+   * \param uri for the resource's URI (path and query).
+   * \param period for the polling period [microseconds].
+   */
+  void addPolledResource(const ControllerId id, const std::string& uri, const Poco::Int64 period);
+
+  /**
+   * \brief A method for stopping the polling of a resource on all controllers.
+   *
+   * \param uri for the resource's URI.
+   */
+  void removePolledResource(const std::string& uri);
+
+  /**
+   * \brief A method for starting a subscription on one controller. The events are delivered to the listener.
+   *
+   * \param id for the controller's id.
+   * \param resources specifying the resources to subscribe to.
+   */
+  void startSubscription(const ControllerId id, const RWSClient::SubscriptionResources& resources);
+
+  /**
+   * \brief A method for ending a subscription on one controller.
+   *
+   * \param id for the controller's id.
+   */
+  void endSubscription(const ControllerId id);
+
+  /**
+   * \brief A method for retrieving the latest result of a polled resource on one controller.
+   *
+   * \param id for the controller's id.
+   * \param uri for the resource's URI.
+   * \param p_snapshot for storing the result.
+   *
+   * \return bool indicating if a result was available or not.
+   */
+  bool getSnapshot(const ControllerId id, const std::string& uri, ResourceSnapshot* p_snapshot);
+
+  /**
+   * \brief A method for retrieving the latest results of a polled resource on all controllers.
+   *
+   * \param uri for the resource's URI.
+   *
+   * \return std::map<ControllerId, ResourceSnapshot> containing the results (for controllers with a result).
+   */
+  std::map<ControllerId, ResourceSnapshot> getFleetSnapshot(const std::string& uri);
+
+  /**
+   * \brief A method for retrieving the fleet-wide statistics.
+   *
+   * \return Statistics containing the statistics.
+   */
+  Statistics getStatistics();
+
+private:
+  /**
+   * \brief An enum for the kinds of HTTP requests that the manager makes.
+   */
+  enum RequestKind
+  {
+    POLL,        ///< A poll of a resource.
+    SUBSCRIBE,   ///< A subscription request.
+    UNSUBSCRIBE, ///< A subscription removal request.
+    WEBSOCKET    ///< A WebSocket handshake (for a subscription).
+  };
+
+  /**
+   * \brief A struct for representing a polled resource.
+   */
+  struct PolledResource
+  {
+    /**
+     * \brief A constructor.
+     *
+     * \param uri for the resource's URI.
+     * \param period for the polling period [microseconds].
+     */
+    PolledResource(const std::string& uri, const Poco::Int64 period) : uri(uri), period(period), outstanding(false) {}
+
+    /**
+     * \brief The resource's URI.
+     */
+    std::string uri;
+
+    /**
+     * \brief The polling period [microseconds].
+     */
+    Poco::Int64 period;
+
+    /**
+     * \brief Time of the next poll.
+     */
+    Poco::Timestamp next_poll;
+
+    /**
+     * \brief Flag indicating if a poll is in flight.
+     */
+    bool outstanding;
+
+    /**
+     * \brief The latest result.
+     */
+    ResourceSnapshot snapshot;
+  };
+
+  /**
+   * \brief A class for representing a registered controller.
+   */
+  class Controller : public POCOAsyncClient::Listener
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param manager for the owning manager.
+     * \param id for the controller's id.
+     * \param ip_address for the controller's IP address.
+     * \param port for the controller's RWS port.
+     * \param username for the username to the controller's authentication process.
+     * \param password for the password to the controller's authentication process.
+     */
+    Controller(RWSFleetManager& manager,
+               const ControllerId id,
+               const std::string& ip_address,
+               const unsigned short port,
+               const std::string& username,
+               const std::string& password);
+
+    /**
+     * \brief A method called when a HTTP request has been completed.
+     *
+     * \param request_id for the request's id.
+     * \param result containing the result.
+     */
+    void onHTTPResult(const Poco::UInt64 request_id, const POCOClient::POCOResult& result);
+
+    /**
+     * \brief A method called when a WebSocket frame has been received, or the WebSocket has failed.
+     *
+     * \param result containing the result.
+     */
+    void onWebSocketFrame(const POCOClient::POCOResult& result);
+
+    /**
+     * \brief The owning manager.
+     */
+    RWSFleetManager& manager;
+
+    /**
+     * \brief The controller's id.
+     */
+    ControllerId id;
+
+    /**
+     * \brief Flag indicating if the controller is still registered.
+     */
+    bool active;
+
+    /**
+     * \brief The controller's polled resources.
+     */
+    std::vector<PolledResource> resources;
+
+    /**
+     * \brief The HTTP requests in flight, i.e. their kinds and URIs, by request id.
+     */
+    std::map<Poco::UInt64, std::pair<RequestKind, std::string> > requests_in_flight;
+
+    /**
+     * \brief The request being made, since a request that fails directly is completed before its id is known.
+     */
+    std::pair<RequestKind, std::string> request_being_made;
+
+    /**
+     * \brief Flag indicating if the request being made has already been completed.
+     */
+    bool request_being_made_completed;
+
+    /**
+     * \brief Id of the current WebSocket handshake request in flight (0 if none).
+     */
+    Poco::UInt64 websocket_request_id;
+
+    /**
+     * \brief Id of the active subscription group (empty if none).
+     */
+    std::string subscription_group_id;
+
+    /**
+     * \brief The controller's asynchronous client.
+     */
+    POCOAsyncClient client;
+  };
+
+  /**
+   * \brief A struct for representing a pending listener notification.
+   */
+  struct Notification
+  {
+    /**
+     * \brief A default constructor.
+     */
+    Notification() : id(0), subscription_event(false) {}
+
+    /**
+     * \brief The controller's id.
+     */
+    ControllerId id;
+
+    /**
+     * \brief Flag indicating if the notification is a subscription event.
+     */
+    bool subscription_event;
+
+    /**
+     * \brief The resource's URI (for resource updates).
+     */
+    std::string uri;
+
+    /**
+     * \brief The resource's result (for resource updates).
+     */
+    ResourceSnapshot snapshot;
+
+    /**
+     * \brief The subscription event (for subscription events).
+     */
+    POCOClient::POCOResult result;
+  };
+
+  /**
+   * \brief The scheduling thread's main method.
+   */
+  void run();
+
+  /**
+   * \brief A method for releasing unregistered controllers (their clients have been closed by then).
+   *
+   * The controllers are released without holding the mutex, since their clients wait for callbacks in progress.
+   */
+  void releaseRetiredControllers();
+
+  /**
+   * \brief A method for issuing the due polls.
+   */
+  void schedulePolls();
+
+  /**
+   * \brief A method for making a HTTP request to a controller, and keeping track of it until it has been completed.
+   *
+   * \param controller for the controller.
+   * \param kind for the request's kind.
+   * \param uri for the request's URI.
+   * \param content for the request's content (for subscription requests).
+   */
+  void makeRequest(Controller& controller,
+                   const RequestKind kind,
+                   const std::string& uri,
+                   const std::string& content = "");
+
+  /**
+   * \brief A method for delivering the pending notifications to the listener.
+   */
+  void deliverNotifications();
+
+  /**
+   * \brief A method for handling the completion of a HTTP request to a controller.
+   *
+   * \param controller for the controller.
+   * \param request_id for the request's id.
+   * \param result containing the result.
+   */
+  void handleHTTPResult(Controller& controller, const Poco::UInt64 request_id, const POCOClient::POCOResult& result);
+
+  /**
+   * \brief A method for handling a WebSocket frame (or failure) from a controller.
+   *
+   * \param controller for the controller.
+   * \param result containing the result.
+   */
+  void handleWebSocketFrame(Controller& controller, const POCOClient::POCOResult& result);
+
+  /**
+   * \brief Static constant for the scheduling interval [milliseconds].
+   */
+  static const long SCHEDULING_INTERVAL = 5;
+
+  /**
+   * \brief Static constant for the WebSocket protocol used for subscriptions.
+   */
+  static const char* const SUBSCRIPTION_PROTOCOL;
+
+  /**
+   * \brief A mutex for protecting the manager's resources.
+   */
+  Poco::Mutex mutex_;
+
+  /**
+   * \brief The event loop shared by all controllers.
+   */
+  POCOEventLoop event_loop_;
+
+  /**
+   * \brief The fleet-wide limit for the number of requests in flight.
+   */
+  size_t max_requests_in_flight_;
+
+  /**
+   * \brief The registered controllers.
+   */
+  std::map<ControllerId, Poco::SharedPtr<Controller> > controllers_;
+
+  /**
+   * \brief Unregistered controllers, which are kept until the next scheduling round (see releaseRetiredControllers).
+   */
+  std::vector<Poco::SharedPtr<Controller> > retired_controllers_;
+
+  /**
+   * \brief Fleet-wide polled resources (URI and period), applied to all controllers.
+   */
+  std::vector<std::pair<std::string, Poco::Int64> > fleet_resources_;
+
+  /**
+   * \brief Id of the latest registered controller.
+   */
+  ControllerId last_id_;
+
+  /**
+   * \brief Index of the controller to start the next scheduling round with (for fairness under the request limit).
+   */
+  size_t scheduling_offset_;
+
+  /**
+   * \brief The fleet-wide statistics.
+   */
+  Statistics statistics_;
+
+  /**
+   * \brief Pending listener notifications.
+   */
+  std::vector<Notification> notifications_;
+
+  /**
+   * \brief The listener for fleet notifications.
+   */
+  Listener* p_listener_;
+
+  /**
+   * \brief Flag indicating if the manager is running.
+   */
+  bool running_;
+
+  /**
+   * \brief Event for stopping the scheduling thread.
+   */
+  Poco::Event stop_event_;
+
+  /**
+   * \brief Adapter for running the scheduling thread's main method.
+   */
+  Poco::RunnableAdapter<RWSFleetManager> runnable_;
+
+  /**
+   * \brief The scheduling thread.
+   */
+  Poco::Thread thread_;
+};
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
@@ -39,6 +39,7 @@
 
 #include "rws_cfg.h"
 #include "rws_client.h"
+#include "rws_client_registry.h"
 
 namespace abb
 {
@@ -344,6 +345,48 @@ public:
     bool rws_connected;
   };
 
+  /**
+   * \brief A class for limiting the duration of the interface's calls made by the current thread, while in scope.
+   *
+   * See POCOClient::Deadline. A call that misses the deadline fails (as for a timeout), while the connection to the
+   * robot controller is kept.
+   */
+  class Deadline : public POCOClient::Deadline
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param interface for the interface to limit.
+     * \param timeout for the time until the deadline [microseconds].
+     */
+    Deadline(RWSInterface& interface, const Poco::Int64 timeout)
+    :
+    POCOClient::Deadline(interface.rws_client_, timeout)
+    {}
+  };
+
+  /**
+   * \brief A class for setting the priority of the calls made by the current thread, while in scope.
+   *
+   * See POCOClient::PriorityScope. E.g. calls made with POCOClient::CONTROL priority use their own connection (and
+   * RWS session), and are never queued behind file transfers (which use POCOClient::BULK priority by default).
+   */
+  class PriorityScope : public POCOClient::PriorityScope
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param interface for the interface.
+     * \param priority for the priority of the calls.
+     */
+    PriorityScope(RWSInterface& interface, const POCOClient::Priority priority)
+    :
+    POCOClient::PriorityScope(interface.rws_client_, priority)
+    {}
+  };
+
   /**
    * \brief A constructor.
    *
@@ -351,10 +394,13 @@ public:
    */
   RWSInterface(const std::string& ip_address)
   :
-  rws_client_(ip_address,
-              SystemConstants::General::DEFAULT_PORT_NUMBER,
-              SystemConstants::General::DEFAULT_USERNAME,
-              SystemConstants::General::DEFAULT_PASSWORD)
+  rws_client_handle_(ip_address,
+                     SystemConstants::General::DEFAULT_PORT_NUMBER,
+                     SystemConstants::General::DEFAULT_USERNAME,
+                     SystemConstants::General::DEFAULT_PASSWORD,
+                     POCOClient::TLSOptions(),
+                     false),
+  rws_client_(rws_client_handle_.client())
   {}
 
   /**
@@ -366,10 +412,13 @@ public:
    */
   RWSInterface(const std::string& ip_address, const std::string& username, const std::string& password)
   :
-  rws_client_(ip_address,
-              SystemConstants::General::DEFAULT_PORT_NUMBER,
-              username,
-              password)
+  rws_client_handle_(ip_address,
+                     SystemConstants::General::DEFAULT_PORT_NUMBER,
+                     username,
+                     password,
+                     POCOClient::TLSOptions(),
+                     false),
+  rws_client_(rws_client_handle_.client())
   {}
 
   /**
@@ -380,10 +429,13 @@ public:
    */
   RWSInterface(const std::string& ip_address, const unsigned short port)
   :
-  rws_client_(ip_address,
-              port,
-              SystemConstants::General::DEFAULT_USERNAME,
-              SystemConstants::General::DEFAULT_PASSWORD)
+  rws_client_handle_(ip_address,
+                     port,
+                     SystemConstants::General::DEFAULT_USERNAME,
+                     SystemConstants::General::DEFAULT_PASSWORD,
+                     POCOClient::TLSOptions(),
+                     false),
+  rws_client_(rws_client_handle_.client())
   {}
 
   /**
@@ -399,10 +451,41 @@ public:
                const std::string& username,
                const std::string& password)
   :
-  rws_client_(ip_address,
-              port,
-              username,
-              password)
+  rws_client_handle_(ip_address,
+                     port,
+                     username,
+                     password,
+                     POCOClient::TLSOptions(),
+                     false),
+  rws_client_(rws_client_handle_.client())
+  {}
+
+  /**
+   * \brief A constructor, for a robot controller (or proxy) that may require HTTPS.
+   *
+   * \param ip_address specifying the robot controller's IP address.
+   * \param port for the port used by the RWS server.
+   * \param username for the username to the RWS authentication process.
+   * \param password for the password to the RWS authentication process.
+   * \param tls for the TLS options (i.e. if HTTPS should be used).
+   * \param share_client indicating if the RWS client (i.e. the RWS session) should be shared with all other sharing
+   *                     interfaces to the same robot controller (see RWSClientRegistry). A sharing interface refuses
+   *                     subscriptions and client settings, since these would affect all the sharing interfaces.
+   */
+  RWSInterface(const std::string& ip_address,
+               const unsigned short port,
+               const std::string& username,
+               const std::string& password,
+               const POCOClient::TLSOptions& tls,
+               const bool share_client = false)
+  :
+  rws_client_handle_(ip_address,
+                     port,
+                     username,
+                     password,
+                     tls,
+                     share_client),
+  rws_client_(rws_client_handle_.client())
   {}
 
   /**
@@ -774,6 +857,16 @@ public:
    */
   bool getFile(const RWSClient::FileResource& resource, std::string* p_file_content);
 
+  /**
+   * \brief A method for retrieving a file from the robot controller, streamed to a sink in fixed-size chunks.
+   *
+   * \param resource specifying the file's directory and name.
+   * \param sink for the sink to stream the file content to.
+   *
+   * \return bool indicating if the communication was successful or not.
+   */
+  bool getFile(const RWSClient::FileResource& resource, POCOClient::ContentSink& sink);
+
   /**
    * \brief A method for uploading a file to the robot controller.
    *
@@ -784,6 +877,16 @@ public:
    */
   bool uploadFile(const RWSClient::FileResource& resource, const std::string& file_content);
 
+  /**
+   * \brief A method for uploading a file to the robot controller, streamed from a source.
+   *
+   * \param resource specifying the file's directory and name.
+   * \param source for the source of the file's content (e.g. a POCOClient::FileSource).
+   *
+   * \return bool indicating if the communication was successful or not.
+   */
+  bool uploadFile(const RWSClient::FileResource& resource, POCOClient::ContentSource& source);
+
   /**
    * \brief A method for deleting a file from the robot controller.
    *
@@ -798,14 +901,14 @@ public:
    *
    * \param resources specifying the resources to subscribe to.
    *
-   * \return bool indicating if the communication was successful or not.
+   * \return bool indicating if the communication was successful or not (always false if the RWS client is shared).
    */
   bool startSubscription(const RWSClient::SubscriptionResources& resources);
 
   /**
    * \brief A method for waiting for a subscription event (use if the event content is irrelevant).
    *
-   * \return bool indicating if the communication was successful or not.
+   * \return bool indicating if the communication was successful or not (always false if the RWS client is shared).
    */
   bool waitForSubscriptionEvent();
 
@@ -814,14 +917,14 @@ public:
    *
    * \param p_xml_document for storing the data received in the subscription event.
    *
-   * \return bool indicating if the communication was successful or not.
+   * \return bool indicating if the communication was successful or not (always false if the RWS client is shared).
    */
   bool waitForSubscriptionEvent(Poco::AutoPtr<Poco::XML::Document>* p_xml_document);
 
   /**
    * \brief A method for ending a active subscription.
    *
-   * \return bool indicating if the communication was successful or not.
+   * \return bool indicating if the communication was successful or not (always false if the RWS client is shared).
    */
   bool endSubscription();
 
@@ -835,7 +938,8 @@ public:
    * endSubscription(). This function can be used to force the connection to close immediately in
    * case the robot controller is not responding.
    *
-   * This function blocks until an active waitForSubscriptionEvent() has finished.
+   * This function blocks until an active waitForSubscriptionEvent() has finished. It does nothing if the RWS client
+   * is shared.
    */
   void forceCloseSubscription();
 
@@ -887,10 +991,147 @@ public:
    * \brief A method for setting the HTTP communication timeout.
    *
    * \param timeout for the HTTP communication timeout [microseconds].
+   *
+   * \return bool indicating if the timeout was set (not if the RWS client is shared).
    */
-  void setHTTPTimeout(const Poco::Int64 timeout)
+  bool setHTTPTimeout(const Poco::Int64 timeout)
   {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
     rws_client_.setHTTPTimeout(timeout);
+    return true;
+  }
+
+  /**
+   * \brief A method for setting the socket level transport options.
+   *
+   * \param options for the transport options.
+   *
+   * \return bool indicating if the options were set (not if the RWS client is shared).
+   */
+  bool setTransportOptions(const POCOClient::TransportOptions& options)
+  {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
+    rws_client_.setTransportOptions(options);
+    return true;
+  }
+
+  /**
+   * \brief A method for enabling or disabling compressed (gzip/deflate) HTTP contents (see POCOClient::setCompression).
+   *
+   * \param responses for indicating if compressed responses should be accepted.
+   * \param requests for indicating if large request contents should be sent compressed.
+   *
+   * \return bool indicating if the compression was set (not if the RWS client is shared).
+   */
+  bool setCompression(const bool responses, const bool requests = false)
+  {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
+    rws_client_.setCompression(responses, requests);
+    return true;
+  }
+
+  /**
+   * \brief A method for setting the time to live for a resource class' cached responses (see RWSClient::setCacheTTL).
+   *
+   * \param cache_class for the resource class.
+   * \param ttl for the time to live [microseconds]. 0 disables the caching.
+   *
+   * \return bool indicating if the time to live was set (not if the RWS client is shared).
+   */
+  bool setCacheTTL(const RWSClient::CacheClass cache_class, const Poco::Int64 ttl)
+  {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
+    rws_client_.setCacheTTL(cache_class, ttl);
+    return true;
+  }
+
+  /**
+   * \brief A method for invalidating all cached responses (also allowed if the RWS client is shared, since it only
+   *        causes fresh reads).
+   */
+  void invalidateCache()
+  {
+    rws_client_.invalidateCache();
+  }
+
+  /**
+   * \brief A method for enabling admission control, i.e. rate and concurrency limiting of the requests to the robot
+   *        controller (see POCOClient::setAdmissionControl).
+   *
+   * \param options for the admission control options.
+   *
+   * \return bool indicating if the admission control was set (not if the RWS client is shared).
+   */
+  bool setAdmissionControl(const POCOClient::AdmissionOptions& options)
+  {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
+    rws_client_.setAdmissionControl(options);
+    return true;
+  }
+
+  /**
+   * \brief A method for retrieving the admission control metrics (e.g. queue depth and wait times).
+   *
+   * \return POCOClient::AdmissionMetrics containing the metrics.
+   */
+  POCOClient::AdmissionMetrics getAdmissionMetrics()
+  {
+    return rws_client_.getAdmissionMetrics();
+  }
+
+  /**
+   * \brief A method for starting a background session keeper, which keeps the connection to the robot controller
+   *        warm and authenticated (see POCOClient::startSessionKeeper).
+   *
+   * \param refresh_interval for the refresh interval [microseconds].
+   *
+   * \return bool indicating if the session keeper was started (not if the RWS client is shared).
+   */
+  bool startSessionKeeper(const Poco::Int64 refresh_interval = POCOClient::DEFAULT_SESSION_KEEPER_INTERVAL)
+  {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
+    rws_client_.startSessionKeeper(SystemConstants::RWS::Resources::RW_PANEL_CTRLSTATE, refresh_interval);
+    return true;
+  }
+
+  /**
+   * \brief A method for stopping the background session keeper (if started).
+   *
+   * \return bool indicating if the session keeper was stopped (not if the RWS client is shared).
+   */
+  bool stopSessionKeeper()
+  {
+    if (rws_client_handle_.shared())
+    {
+      return false;
+    }
+
+    rws_client_.stopSessionKeeper();
+    return true;
   }
 
 protected:
@@ -908,9 +1149,14 @@ protected:
                                const std::string& compare_string);
 
   /**
-   * \brief The RWS client used to communicate with the robot controller.
+   * \brief The handle to the RWS client, which is private unless sharing was requested (see RWSClientRegistry).
+   */
+  RWSClientRegistry::Handle rws_client_handle_;
+
+  /**
+   * \brief The RWS client used to communicate with the robot controller (possibly shared, see RWSClientRegistry).
    */
-  RWSClient rws_client_;
+  RWSClient& rws_client_;
 };
 
 } // end namespace rws
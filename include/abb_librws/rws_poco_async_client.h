@@ -0,0 +1,754 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_POCO_ASYNC_CLIENT_H
+#define RWS_POCO_ASYNC_CLIENT_H
+
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Poco/AutoPtr.h"
+#include "Poco/Condition.h"
+#include "Poco/Event.h"
+#include "Poco/Mutex.h"
+#include "Poco/Net/HTTPCredentials.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/NameValueCollection.h"
+#include "Poco/Net/SocketNotification.h"
+#include "Poco/Net/SocketReactor.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+
+#include "rws_poco_client.h"
+
+namespace abb
+{
+namespace rws
+{
+class POCOAsyncClient;
+
+/**
+ * \brief A class for an event loop, which multiplexes the sockets of many asynchronous clients on a few threads.
+ *
+ * Each thread runs a POCO socket reactor, and the clients are distributed over the reactors in a round-robin manner.
+ * I.e. the number of threads is independent of the number of clients (and of the number of requests in flight).
+ *
+ * An additional thread checks the clients' request timeouts periodically, since a reactor only reports idleness when
+ * none of its sockets have any events.
+ */
+class POCOEventLoop
+{
+  friend class POCOAsyncClient;
+
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param number_of_threads specifying the number of threads (and socket reactors) to use.
+   */
+  POCOEventLoop(const size_t number_of_threads = 1);
+
+  /**
+   * \brief A destructor, which stops the event loop.
+   */
+  ~POCOEventLoop();
+
+  /**
+   * \brief A method for starting the event loop's threads.
+   */
+  void start();
+
+  /**
+   * \brief A method for stopping the event loop's threads. Blocks until the threads have finished.
+   */
+  void stop();
+
+  /**
+   * \brief A method for retrieving the socket reactor, that a new client should be assigned to.
+   *
+   * \return Poco::Net::SocketReactor& for the assigned reactor.
+   */
+  Poco::Net::SocketReactor& assignReactor();
+
+private:
+  /**
+   * \brief A method for adding a client to the periodic timeout checks.
+   *
+   * \param p_client for the client.
+   */
+  void addClient(POCOAsyncClient* p_client);
+
+  /**
+   * \brief A method for removing a client from the periodic timeout checks. A check in progress is not waited for.
+   *
+   * \param p_client for the client.
+   */
+  void removeClient(POCOAsyncClient* p_client);
+
+  /**
+   * \brief A method for running the periodic timeout checks, until the event loop is stopped.
+   */
+  void runTimeoutChecks();
+
+  /**
+   * \brief Static constant for the reactors' poll timeout [microseconds].
+   */
+  static const Poco::Int64 POLL_TIMEOUT = 50e3;
+
+  /**
+   * \brief Static constant for the interval between the clients' timeout checks [milliseconds].
+   */
+  static const long TIMEOUT_CHECK_INTERVAL = 50;
+
+  /**
+   * \brief A mutex for protecting the event loop's resources.
+   */
+  Poco::Mutex mutex_;
+
+  /**
+   * \brief A mutex for protecting the set of clients (separate, since the clients are checked while stopping).
+   */
+  Poco::Mutex clients_mutex_;
+
+  /**
+   * \brief The clients assigned to the event loop.
+   */
+  std::set<POCOAsyncClient*> clients_;
+
+  /**
+   * \brief The socket reactors.
+   */
+  std::vector<Poco::SharedPtr<Poco::Net::SocketReactor> > reactors_;
+
+  /**
+   * \brief The threads running the socket reactors.
+   */
+  std::vector<Poco::SharedPtr<Poco::Thread> > threads_;
+
+  /**
+   * \brief Index of the next reactor to assign.
+   */
+  size_t next_reactor_;
+
+  /**
+   * \brief Flag indicating if the threads are running or not.
+   */
+  bool running_;
+
+  /**
+   * \brief Event for stopping the timeout checks.
+   */
+  Poco::Event timeout_checks_stop_event_;
+
+  /**
+   * \brief Runnable for the timeout checks.
+   */
+  Poco::RunnableAdapter<POCOEventLoop> timeout_checks_runnable_;
+
+  /**
+   * \brief The thread running the timeout checks.
+   */
+  Poco::Thread timeout_checks_thread_;
+};
+
+/**
+ * \brief A class for an asynchronous (non-blocking) client based on POCO.
+ *
+ * The client offers the same communication as POCOClient (HTTP requests, with authentication and cookie handling, and
+ * a WebSocket for subscriptions), but never blocks the calling thread. Instead the results are delivered to a
+ * listener, from the event loop thread that the client has been assigned to.
+ *
+ * HTTP requests are queued and sent one at a time on a kept-alive connection, and the WebSocket uses a separate
+ * connection (sharing the session cookies).
+ *
+ * \note The listener must not destroy the client from within a callback. The destructor waits for callbacks in
+ *       progress to finish, so it must neither be called while holding a lock that the listener takes.
+ */
+class POCOAsyncClient
+{
+  friend class POCOEventLoop;
+
+public:
+  /**
+   * \brief An interface for receiving the results of an asynchronous client.
+   */
+  class Listener
+  {
+  public:
+    /**
+     * \brief A destructor.
+     */
+    virtual ~Listener() {}
+
+    /**
+     * \brief A method called when a HTTP request (including a WebSocket handshake) has been completed.
+     *
+     * \param id for the request's id (as returned when the request was made).
+     * \param result containing the result.
+     */
+    virtual void onHTTPResult(const Poco::UInt64 id, const POCOClient::POCOResult& result) = 0;
+
+    /**
+     * \brief A method called when a (non-ping) WebSocket frame has been received, or the WebSocket has failed.
+     *
+     * \param result containing the result.
+     */
+    virtual void onWebSocketFrame(const POCOClient::POCOResult& result) = 0;
+  };
+
+  /**
+   * \brief A constructor.
+   *
+   * \param event_loop for the event loop to run the client on.
+   * \param ip_address for the remote server's IP address.
+   * \param port for the remote server's port.
+   * \param username for the username to the remote server's authentication process.
+   * \param password for the password to the remote server's authentication process.
+   * \param p_listener for the listener to deliver the results to.
+   */
+  POCOAsyncClient(POCOEventLoop& event_loop,
+                  const std::string& ip_address,
+                  const Poco::UInt16 port,
+                  const std::string& username,
+                  const std::string& password,
+                  Listener* p_listener);
+
+  /**
+   * \brief A destructor, which closes the client's connections, and waits for callbacks in progress to finish.
+   */
+  ~POCOAsyncClient();
+
+  /**
+   * \brief A method for queueing a HTTP GET request.
+   *
+   * \param uri for the URI (path and query).
+   *
+   * \return Poco::UInt64 containing the request's id.
+   */
+  Poco::UInt64 httpGet(const std::string& uri);
+
+  /**
+   * \brief A method for queueing a HTTP POST request.
+   *
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   *
+   * \return Poco::UInt64 containing the request's id.
+   */
+  Poco::UInt64 httpPost(const std::string& uri, const std::string& content = "");
+
+  /**
+   * \brief A method for queueing a HTTP PUT request.
+   *
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   *
+   * \return Poco::UInt64 containing the request's id.
+   */
+  Poco::UInt64 httpPut(const std::string& uri, const std::string& content = "");
+
+  /**
+   * \brief A method for queueing a HTTP DELETE request.
+   *
+   * \param uri for the URI (path and query).
+   *
+   * \return Poco::UInt64 containing the request's id.
+   */
+  Poco::UInt64 httpDelete(const std::string& uri);
+
+  /**
+   * \brief A method for connecting a WebSocket. Any existing WebSocket is closed first.
+   *
+   * The handshake's result is delivered as a HTTP result, and received frames are delivered as WebSocket frames.
+   *
+   * \param uri for the URI (path and query).
+   * \param protocol for the WebSocket protocol.
+   *
+   * \return Poco::UInt64 containing the handshake request's id.
+   */
+  Poco::UInt64 webSocketConnect(const std::string& uri, const std::string& protocol);
+
+  /**
+   * \brief A method for shutting down the WebSocket connection (if any).
+   */
+  void webSocketShutdown();
+
+  /**
+   * \brief A method for checking if the WebSocket is open.
+   *
+   * \return bool flag indicating if the WebSocket is open or not.
+   */
+  bool webSocketExist();
+
+  /**
+   * \brief A method for setting the HTTP communication timeout.
+   *
+   * \param timeout for the HTTP communication timeout [microseconds].
+   */
+  void setHTTPTimeout(const Poco::Int64 timeout);
+
+  /**
+   * \brief A method for setting the socket level transport options, applied to new connections.
+   *
+   * \param options for the transport options.
+   */
+  void setTransportOptions(const POCOClient::TransportOptions& options);
+
+  /**
+   * \brief A method for closing all connections. Pending requests are failed.
+   */
+  void close();
+
+private:
+  /**
+   * \brief A class for entering a callback for the duration of a scope (see enterCallback).
+   */
+  class CallbackScope
+  {
+  public:
+    /**
+     * \brief A constructor, which enters the callback.
+     *
+     * \param client for the client.
+     */
+    explicit CallbackScope(POCOAsyncClient& client) : client_(client), entered_(client.enterCallback()) {}
+
+    /**
+     * \brief A destructor, which leaves the callback (if it was entered).
+     */
+    ~CallbackScope()
+    {
+      if (entered_)
+      {
+        client_.leaveCallback();
+      }
+    }
+
+    /**
+     * \brief A method for checking if the callback was entered.
+     *
+     * \return bool indicating if the callback may proceed or not.
+     */
+    bool entered() const { return entered_; }
+
+  private:
+    CallbackScope(const CallbackScope&);
+    CallbackScope& operator=(const CallbackScope&);
+
+    /**
+     * \brief The client.
+     */
+    POCOAsyncClient& client_;
+
+    /**
+     * \brief Flag indicating if the callback was entered.
+     */
+    bool entered_;
+  };
+
+  /**
+   * \brief A struct for representing a queued HTTP request.
+   */
+  struct PendingRequest
+  {
+    /**
+     * \brief A default constructor.
+     */
+    PendingRequest() : id(0), authenticated(false), websocket(false) {}
+
+    /**
+     * \brief The request's id.
+     */
+    Poco::UInt64 id;
+
+    /**
+     * \brief The HTTP request.
+     */
+    Poco::SharedPtr<Poco::Net::HTTPRequest> p_request;
+
+    /**
+     * \brief The request's content.
+     */
+    std::string content;
+
+    /**
+     * \brief Flag indicating if credentials have been added to the request.
+     */
+    bool authenticated;
+
+    /**
+     * \brief Flag indicating if the request is a WebSocket handshake.
+     */
+    bool websocket;
+  };
+
+  /**
+   * \brief A struct for representing one of the client's connections.
+   */
+  struct Channel
+  {
+    /**
+     * \brief A default constructor.
+     */
+    Channel() : open(false), connected(false), writing(false), busy(false), websocket(false) {}
+
+    /**
+     * \brief The connection's socket.
+     */
+    Poco::Net::StreamSocket socket;
+
+    /**
+     * \brief Flag indicating if the socket has been opened (and registered with the reactor).
+     */
+    bool open;
+
+    /**
+     * \brief Flag indicating if the socket's (non-blocking) connect has completed.
+     */
+    bool connected;
+
+    /**
+     * \brief Flag indicating if the channel waits for the socket to become writable.
+     */
+    bool writing;
+
+    /**
+     * \brief Flag indicating if a request is in flight.
+     */
+    bool busy;
+
+    /**
+     * \brief Flag indicating if the connection has been upgraded to a WebSocket.
+     */
+    bool websocket;
+
+    /**
+     * \brief Queued requests. The front request is in flight, if the channel is busy.
+     */
+    std::deque<PendingRequest> queue;
+
+    /**
+     * \brief Received, but not yet processed, bytes.
+     */
+    std::string input;
+
+    /**
+     * \brief Bytes that have not yet been sent.
+     */
+    std::string output;
+
+    /**
+     * \brief Start time of the request in flight.
+     */
+    Poco::Timestamp request_start;
+  };
+
+  /**
+   * \brief A struct for representing a result, which is delivered to the listener after the mutex is released.
+   */
+  struct Delivery
+  {
+    /**
+     * \brief A default constructor.
+     */
+    Delivery() : id(0), websocket_frame(false) {}
+
+    /**
+     * \brief The request's id (for HTTP results).
+     */
+    Poco::UInt64 id;
+
+    /**
+     * \brief Flag indicating if the result is a WebSocket frame.
+     */
+    bool websocket_frame;
+
+    /**
+     * \brief The result.
+     */
+    POCOClient::POCOResult result;
+  };
+
+  /**
+   * \brief A method for queueing a request on a channel, and starting it if the channel is idle.
+   *
+   * \param p_channel for the channel.
+   * \param method for the request's method.
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   * \param websocket_protocol for the WebSocket protocol (empty for ordinary HTTP requests).
+   *
+   * \return Poco::UInt64 containing the request's id.
+   */
+  Poco::UInt64 queueRequest(Channel* p_channel,
+                            const std::string& method,
+                            const std::string& uri,
+                            const std::string& content,
+                            const std::string& websocket_protocol = "");
+
+  /**
+   * \brief A method for starting the next queued request on a channel (connecting first if necessary).
+   *
+   * \param p_channel for the channel.
+   * \param p_deliveries for collecting results to deliver.
+   */
+  void startNext(Channel* p_channel, std::vector<Delivery>* p_deliveries);
+
+  /**
+   * \brief A method for sending buffered output on a channel, as far as the socket accepts it.
+   *
+   * \param p_channel for the channel.
+   */
+  void flushOutput(Channel* p_channel);
+
+  /**
+   * \brief A method for processing received HTTP bytes on a channel.
+   *
+   * \param p_channel for the channel.
+   * \param connection_closed indicating if the server has closed the connection.
+   * \param p_deliveries for collecting results to deliver.
+   */
+  void processHTTPInput(Channel* p_channel, const bool connection_closed, std::vector<Delivery>* p_deliveries);
+
+  /**
+   * \brief A method for processing received WebSocket bytes.
+   *
+   * \param p_deliveries for collecting results to deliver.
+   */
+  void processWebSocketInput(std::vector<Delivery>* p_deliveries);
+
+  /**
+   * \brief A method for closing a channel's socket, without failing any requests.
+   *
+   * A request in flight is kept first in the queue, and is sent again when the channel is restarted. The socket is
+   * detached, and unregistered from the reactor (and closed) when the mutex has been released (see releaseSockets).
+   *
+   * \param p_channel for the channel.
+   */
+  void resetSocket(Channel* p_channel);
+
+  /**
+   * \brief A method for unregistering and closing detached sockets. Must be called without holding the mutex.
+   *
+   * The reactor's observers are disabled when unregistered, which waits for their notifications in progress. Those
+   * may be waiting for the mutex, so the sockets can not be unregistered while holding it.
+   */
+  void releaseSockets();
+
+  /**
+   * \brief A method for closing a channel, and failing its queued requests (and its WebSocket, if open).
+   *
+   * \param p_channel for the channel.
+   * \param status for the status to fail the requests with.
+   * \param message for the exception message to fail the requests with.
+   * \param p_deliveries for collecting results to deliver.
+   */
+  void closeChannel(Channel* p_channel,
+                    const POCOClient::POCOResult::GeneralStatus status,
+                    const std::string& message,
+                    std::vector<Delivery>* p_deliveries);
+
+  /**
+   * \brief A method for failing requests in flight, that have exceeded the HTTP communication timeout.
+   *
+   * \param p_deliveries for collecting results to deliver.
+   */
+  void checkTimeouts(std::vector<Delivery>* p_deliveries);
+
+  /**
+   * \brief A method for delivering collected results to the listener (after releasing any detached sockets).
+   *
+   * \param deliveries containing the results to deliver.
+   */
+  void deliver(const std::vector<Delivery>& deliveries);
+
+  /**
+   * \brief A method for entering a callback (from the reactor or the event loop's timeout checks).
+   *
+   * \return bool indicating if the callback may proceed, i.e. if the client is not being destroyed.
+   */
+  bool enterCallback();
+
+  /**
+   * \brief A method for leaving a callback, that was entered.
+   */
+  void leaveCallback();
+
+  /**
+   * \brief Event loop callback for the periodic timeout checks (called in an entered callback).
+   */
+  void onTimeoutCheck();
+
+  /**
+   * \brief A method for finding the channel that a socket belongs to.
+   *
+   * \param socket for the socket.
+   *
+   * \return Channel* for the channel (null if none).
+   */
+  Channel* findChannel(const Poco::Net::Socket& socket);
+
+  /**
+   * \brief Reactor callback for readable sockets.
+   *
+   * \param p_notification for the notification.
+   */
+  void onReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification>& p_notification);
+
+  /**
+   * \brief Reactor callback for writable sockets.
+   *
+   * \param p_notification for the notification.
+   */
+  void onWritable(const Poco::AutoPtr<Poco::Net::WritableNotification>& p_notification);
+
+  /**
+   * \brief Reactor callback for socket errors.
+   *
+   * \param p_notification for the notification.
+   */
+  void onError(const Poco::AutoPtr<Poco::Net::ErrorNotification>& p_notification);
+
+  /**
+   * \brief Static constant for the default HTTP communication timeout [microseconds].
+   */
+  static const Poco::Int64 DEFAULT_HTTP_TIMEOUT = 400e3;
+
+  /**
+   * \brief Static constant for the size of the receive buffer.
+   */
+  static const size_t BUFFER_SIZE = 4096;
+
+  /**
+   * \brief A mutex for protecting the client's resources.
+   */
+  Poco::Mutex mutex_;
+
+  /**
+   * \brief A mutex for protecting the callback accounting.
+   */
+  Poco::Mutex callback_mutex_;
+
+  /**
+   * \brief A condition for signaling that a callback has been left.
+   */
+  Poco::Condition callback_condition_;
+
+  /**
+   * \brief Number of callbacks in progress.
+   */
+  size_t callbacks_;
+
+  /**
+   * \brief Flag indicating if the client is being destroyed (i.e. no more callbacks may be entered).
+   */
+  bool closing_;
+
+  /**
+   * \brief The event loop that the client is assigned to.
+   */
+  POCOEventLoop& event_loop_;
+
+  /**
+   * \brief The socket reactor that the client is assigned to.
+   */
+  Poco::Net::SocketReactor& reactor_;
+
+  /**
+   * \brief The remote server's IP address.
+   */
+  std::string ip_address_;
+
+  /**
+   * \brief The remote server's port.
+   */
+  Poco::UInt16 port_;
+
+  /**
+   * \brief HTTP credentials for the remote server's access authentication process.
+   */
+  Poco::Net::HTTPCredentials http_credentials_;
+
+  /**
+   * \brief A container for cookies received from the server.
+   */
+  Poco::Net::NameValueCollection cookies_;
+
+  /**
+   * \brief The listener to deliver results to.
+   */
+  Listener* p_listener_;
+
+  /**
+   * \brief The HTTP communication timeout [microseconds].
+   */
+  Poco::Int64 http_timeout_;
+
+  /**
+   * \brief The socket level transport options.
+   */
+  POCOClient::TransportOptions transport_options_;
+
+  /**
+   * \brief Id of the latest request.
+   */
+  Poco::UInt64 last_id_;
+
+  /**
+   * \brief The channel for HTTP requests.
+   */
+  Channel http_channel_;
+
+  /**
+   * \brief The channel for the WebSocket.
+   */
+  Channel websocket_channel_;
+
+  /**
+   * \brief Sockets that have been detached from their channels, but not yet unregistered from the reactor.
+   */
+  std::vector<Poco::Net::StreamSocket> detached_sockets_;
+};
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
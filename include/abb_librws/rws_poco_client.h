@@ -37,12 +37,26 @@
 #ifndef RWS_POCO_CLIENT_H
 #define RWS_POCO_CLIENT_H
 
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Poco/Condition.h"
+#include "Poco/Event.h"
 #include "Poco/Mutex.h"
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPCredentials.h"
 #include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/StreamSocket.h"
 #include "Poco/Net/WebSocket.h"
+#include "Poco/RunnableAdapter.h"
 #include "Poco/SharedPtr.h"
+#include "Poco/Thread.h"
+#include "Poco/Timestamp.h"
+
+#include "rws_shared_buffer.h"
 
 namespace abb
 {
@@ -54,6 +68,27 @@ namespace rws
 class POCOClient
 {
 public:
+  /**
+   * \brief Static constant for the default refresh interval of the session keeper [microseconds].
+   *
+   * Shorter than the HTTP client session's default keep-alive timeout (8 s).
+   */
+  static const Poco::Int64 DEFAULT_SESSION_KEEPER_INTERVAL = 5e6;
+
+  /**
+   * \brief Priority classes for HTTP requests.
+   *
+   * Each priority class has its own lane (i.e. HTTP session, and RWS session), so requests of one class never wait
+   * behind requests of another class. The dedicated lanes are created when first used.
+   */
+  enum Priority
+  {
+    CONTROL,     ///< Latency critical requests (e.g. stop commands, IO signals and heartbeats).
+    INTERACTIVE, ///< Regular requests (the default), on the client's own session.
+    BULK         ///< Large transfers (e.g. files and configuration listings).
+  };
+
+
   /**
    * \brief A struct for containing the result of a communication.
    */
@@ -70,7 +105,8 @@ public:
       EXCEPTION_POCO_INVALID_ARGUMENT, ///< POCO invalid argument exception
       EXCEPTION_POCO_TIMEOUT,          ///< POCO timeout exception.
       EXCEPTION_POCO_NET,              ///< POCO net exception.
-      EXCEPTION_POCO_WEBSOCKET         ///< POCO WebSocket exception.
+      EXCEPTION_POCO_WEBSOCKET,        ///< POCO WebSocket exception.
+      TRANSFER_ABORTED                 ///< The content transfer was aborted (e.g. by a content sink).
     };
 
     /**
@@ -114,20 +150,115 @@ public:
            */
           Poco::Net::HTTPResponse::HTTPStatus status;
 
+          /**
+           * \brief A class for presenting response headers as text ("name=value" lines).
+           *
+           * The headers are shared with the received response (i.e. they are neither copied per response, nor when
+           * copying the result), and the text is only constructed when it is requested.
+           */
+          class HeaderInfo
+          {
+          public:
+            /**
+             * \brief A default constructor (no headers).
+             */
+            HeaderInfo() {}
+
+            /**
+             * \brief A constructor.
+             *
+             * \param p_headers for the shared headers.
+             */
+            explicit HeaderInfo(const Poco::SharedPtr<const Poco::Net::NameValueCollection>& p_headers)
+            :
+            p_headers_(p_headers)
+            {}
+
+            /**
+             * \brief A method for retrieving the headers.
+             *
+             * \return const Poco::Net::NameValueCollection* pointing to the headers, or 0 if there are none.
+             */
+            const Poco::Net::NameValueCollection* headers() const { return p_headers_.get(); }
+
+            /**
+             * \brief A method for checking if there are no headers.
+             *
+             * \return bool indicating if the text representation is empty.
+             */
+            bool empty() const { return p_headers_.isNull() || p_headers_->empty(); }
+
+            /**
+             * \brief A method for constructing the text representation.
+             *
+             * \return std::string containing one "name=value" line per header.
+             */
+            std::string str() const;
+
+            /**
+             * \brief Conversion to the text representation (for code treating the header info as a string).
+             *
+             * \return std::string containing one "name=value" line per header.
+             */
+            operator std::string() const { return str(); }
+
+            /**
+             * \brief Operator for writing the text representation to a stream.
+             *
+             * \param stream for the stream.
+             * \param header_info for the header info.
+             *
+             * \return std::ostream& referencing the stream.
+             */
+            friend std::ostream& operator<<(std::ostream& stream, const HeaderInfo& header_info)
+            {
+              return stream << header_info.str();
+            }
+
+          private:
+            /**
+             * \brief The shared headers.
+             */
+            Poco::SharedPtr<const Poco::Net::NameValueCollection> p_headers_;
+          };
+
           /**
            * \brief Response header info.
            */
-          std::string header_info;
+          HeaderInfo header_info;
 
           /**
-           * \brief Response content.
+           * \brief Response content (shared, i.e. copying the result does not copy the content).
            */
-          std::string content;
+          SharedBuffer content;
 
           /**
            * \brief A default constructor.
            */
           ResponseInfo() : status(Poco::Net::HTTPResponse::HTTP_OK) {}
+
+          /**
+           * \brief A method for retrieving a response header's value.
+           *
+           * \param name for the header's name (case insensitive).
+           *
+           * \return std::string containing the (first) value, or an empty string if the header is missing.
+           */
+          std::string header(const std::string& name) const;
+
+          /**
+           * \brief A method for retrieving the response's "Location" header.
+           *
+           * \return std::string containing the location, or an empty string if the header is missing.
+           */
+          std::string location() const;
+
+          /**
+           * \brief A method for retrieving the response's "Set-Cookie" headers.
+           *
+           * \return std::vector<std::string> containing the values.
+           */
+          std::vector<std::string> setCookies() const;
         };
 
         /**
@@ -202,13 +333,32 @@ public:
     void addHTTPRequestInfo(const Poco::Net::HTTPRequest& request, const std::string& request_content = "");
 
     /**
-     * \brief A method for adding info from a HTTP response.
+     * \brief A method for adding info from a HTTP response (the headers are copied).
      *
      * \param response for the HTTP response.
      * \param response_content for the HTTP response's content.
      */
     void addHTTPResponseInfo(const Poco::Net::HTTPResponse& response, const std::string& response_content = "");
 
+    /**
+     * \brief A method for adding info from a HTTP response, sharing (i.e. not copying) the response's content (the
+     *        headers are copied).
+     *
+     * \param response for the HTTP response.
+     * \param response_content for the HTTP response's content.
+     */
+    void addHTTPResponseInfo(const Poco::Net::HTTPResponse& response, const SharedBuffer& response_content);
+
+    /**
+     * \brief A method for adding info from a HTTP response, sharing (i.e. not copying) the response's headers and
+     *        content. The response must not be modified afterwards.
+     *
+     * \param p_response for the HTTP response.
+     * \param response_content for the HTTP response's content.
+     */
+    void addHTTPResponseInfo(const Poco::SharedPtr<Poco::Net::HTTPResponse>& p_response,
+                             const SharedBuffer& response_content);
+
     /**
      * \brief A method for adding info from a received WebSocket frame.
      *
@@ -243,200 +393,1152 @@ public:
   };
 
   /**
-   * \brief A constructor.
+   * \brief A struct for containing socket level options, applied to the HTTP and WebSocket connections.
    *
-   * \param ip_address for the remote server's IP address.
-   * \param port for the remote server's port.
-   * \param username for the username to the remote server's authentication process.
-   * \param password for the password to the remote server's authentication process.
+   * The defaults leave the operating system's settings unchanged. Options that the platform does not support are
+   * skipped.
    */
-  POCOClient(const std::string& ip_address,
-             const Poco::UInt16 port,
-             const std::string& username,
-             const std::string& password)
-  :
-  http_client_session_(ip_address, port),
-  http_credentials_(username, password)
+  struct TransportOptions
   {
-    http_client_session_.setKeepAlive(true);
-    http_client_session_.setTimeout(Poco::Timespan(DEFAULT_HTTP_TIMEOUT));
-  }
+    /**
+     * \brief A default constructor.
+     */
+    TransportOptions()
+    :
+    no_delay(false),
+    keep_alive(false),
+    keep_alive_idle(0),
+    keep_alive_interval(0),
+    keep_alive_count(0),
+    send_buffer_size(0),
+    receive_buffer_size(0),
+    dscp(-1),
+    quick_ack(false)
+    {}
 
-  /**
-   * \brief A destructor.
-   */
-  ~POCOClient() {}
+    /**
+     * \brief A method for applying the options to a (connected) socket.
+     *
+     * \param socket for the socket to apply the options to.
+     */
+    void applyTo(Poco::Net::StreamSocket& socket) const;
 
-  /**
-   * \brief A method for sending a HTTP GET request.
-   *
-   * \param uri for the URI (path and query).
-   *
-   * \return POCOResult containing the result.
-   */
-  POCOResult httpGet(const std::string& uri);
+    /**
+     * \brief A method for re-arming the options that the operating system clears during a connection's lifetime.
+     *
+     * I.e. TCP_QUICKACK on Linux, which should be re-armed before each response is awaited.
+     *
+     * \param socket for the socket to re-arm the options on.
+     */
+    void rearm(Poco::Net::StreamSocket& socket) const;
 
-  /**
-   * \brief A method for sending a HTTP POST request.
-   *
-   * \param uri for the URI (path and query).
-   * \param content for the request's content.
-   *
-   * \return POCOResult containing the result.
-   */
-  POCOResult httpPost(const std::string& uri, const std::string& content = "");
+    /**
+     * \brief Flag indicating if Nagle's algorithm should be disabled (TCP_NODELAY).
+     */
+    bool no_delay;
 
-  /**
-   * \brief A method for sending a HTTP PUT request.
-   *
-   * \param uri for the URI (path and query).
-   * \param content for the request's content.
-   *
-   * \return POCOResult containing the result.
-   */
-  POCOResult httpPut(const std::string& uri, const std::string& content = "");
+    /**
+     * \brief Flag indicating if TCP keepalive probes should be sent (SO_KEEPALIVE).
+     */
+    bool keep_alive;
 
-  /**
-   * \brief A method for sending a HTTP DELETE request.
-   *
-   * \param uri for the URI (path and query).
-   *
-   * \return POCOResult containing the result.
-   */
-  POCOResult httpDelete(const std::string& uri);
+    /**
+     * \brief Idle time before the first keepalive probe [s]. 0 means the system default.
+     */
+    int keep_alive_idle;
 
-  /**
-   * \brief A method for setting the HTTP communication timeout.
-   *
-   * \note This method resets the internal HTTP client session, causing the
-   *       RWS server (robot controller) to send a new cookie. The RWS
-   *       session id is not changed.
-   *
-   * \param timeout for the HTTP communication timeout [microseconds].
-   */
-  void setHTTPTimeout(const Poco::Int64 timeout)
-  {
-    http_client_session_.setTimeout(Poco::Timespan(timeout));
-    http_client_session_.reset();
-  }
+    /**
+     * \brief Interval between keepalive probes [s]. 0 means the system default.
+     */
+    int keep_alive_interval;
 
-  /**
-   * \brief A method for checking if the WebSocket exist.
-   *
-   * \return bool flag indicating if the WebSocket exist or not.
-   */
-  bool webSocketExist() { return !p_websocket_.isNull(); }
+    /**
+     * \brief Number of unanswered keepalive probes before the connection is dropped. 0 means the system default.
+     */
+    int keep_alive_count;
 
-  /**
-   * \brief A method for connecting a WebSocket.
-   *
-   * \param uri for the URI (path and query).
-   * \param protocol for the WebSocket protocol.
-   * \param timeout for the WebSocket communication timeout [microseconds].
-   *
-   * \return POCOResult containing the result.
-   */
-  POCOResult webSocketConnect(const std::string& uri, const std::string& protocol, const Poco::Int64 timeout);
+    /**
+     * \brief Size of the socket's send buffer [bytes]. 0 means the system default.
+     */
+    int send_buffer_size;
 
-  /**
-   * \brief A method for receiving a WebSocket frame.
-   *
-   * \return POCOResult containing the result.
-   */
-  POCOResult webSocketReceiveFrame();
+    /**
+     * \brief Size of the socket's receive buffer [bytes]. 0 means the system default.
+     */
+    int receive_buffer_size;
 
-  /**
-   * \brief Forcibly shut down the websocket connection.
-   *
-   * The connection is shut down immediately.
-   * Subsequently, the function will block until a current call to webSocketReceiveFrame() has finished,
-   * before cleaning up the local state.
-   *
-   * Note that since mutexes do not guarantee the order of acquisition for multiple contenders,
-   * it is undefined how many calls to webSocketReceiveFrame() will still attempt to use the shut down
-   * connection before the local state is cleaned. Those invocation will throw a runtime error.
-   */
-  void webSocketShutdown();
+    /**
+     * \brief Differentiated services code point (0-63) to mark the traffic with. -1 means no marking.
+     */
+    int dscp;
 
-  /**
-   * \brief A method for retrieving a substring in a string.
-   *
-   * \param whole_string for the string containing the substring.
-   * \param substring_start start of the substring.
-   * \param substring_end end of the substring.
-   *
-   * \return string containing the substring.
-   */
-  std::string findSubstringContent(const std::string& whole_string,
-                                   const std::string& substring_start,
-                                   const std::string& substring_end);
+    /**
+     * \brief Flag indicating if ACKs should be sent immediately (TCP_QUICKACK, Linux only).
+     */
+    bool quick_ack;
+  };
 
-private:
   /**
-   * \brief A method for making a HTTP request.
-   *
-   * \param method for the request's method.
-   * \param uri for the URI (path and query).
-   * \param content for the request's content.
+   * \brief An interface for receiving a HTTP response's content in chunks, instead of as a whole string.
    *
-   * \return POCOResult containing the result.
+   * Only the content of successful (200 OK) responses is streamed to a sink.
    */
-  POCOResult makeHTTPRequest(const std::string& method,
-                             const std::string& uri = "/",
-                             const std::string& content = "");
+  class ContentSink
+  {
+  public:
+    /**
+     * \brief A destructor.
+     */
+    virtual ~ContentSink() {}
 
-  /**
-   * \brief A method for sending and receiving HTTP messages.
-   *
-   * \param result for the result.
-   * \param request for the HTTP request.
-   * \param response for the HTTP response.
-   * \param request_content for the request's content.
-   */
-  void sendAndReceive(POCOResult& result,
-                      Poco::Net::HTTPRequest& request,
-                      Poco::Net::HTTPResponse& response,
-                      const std::string& request_content);
+    /**
+     * \brief A method for writing a chunk of the content.
+     *
+     * \param data for the chunk's data.
+     * \param size for the chunk's size [bytes].
+     *
+     * \return bool indicating if the transfer should continue or not (i.e. be aborted).
+     */
+    virtual bool write(const char* data, const size_t size) = 0;
 
-  /**
-   * \brief A method for performing authentication.
-   *
-   * \param result for the result.
-   * \param request for the HTTP request.
-   * \param response for the HTTP response.
-   * \param request_content for the request's content.
-   */
-  void authenticate(POCOResult& result,
-                    Poco::Net::HTTPRequest& request,
-                    Poco::Net::HTTPResponse& response,
-                    const std::string& request_content);
+    /**
+     * \brief A method for reporting the transfer's progress, called after each chunk.
+     *
+     * \param transferred for the number of bytes transferred so far.
+     * \param total for the total number of bytes, or -1 if it is not known in advance.
+     */
+    virtual void onProgress(const Poco::UInt64 transferred, const Poco::Int64 total) {}
+  };
 
   /**
-   * \brief A method for extracting and storing information from a cookie string.
-   *
-   * \param cookie_string for the cookie string.
+   * \brief A content sink that writes to an output stream.
    */
-  void extractAndStoreCookie(const std::string& cookie_string);
+  class StreamSink : public ContentSink
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param stream for the output stream to write to.
+     */
+    StreamSink(std::ostream& stream) : stream_(stream) {}
 
-  /**
-   * \brief Static constant for the default HTTP communication timeout [microseconds].
-   */
-  static const Poco::Int64 DEFAULT_HTTP_TIMEOUT = 400e3;
+    /**
+     * \brief A method for writing a chunk of the content.
+     *
+     * \param data for the chunk's data.
+     * \param size for the chunk's size [bytes].
+     *
+     * \return bool indicating if the stream is still good or not.
+     */
+    bool write(const char* data, const size_t size);
 
-  /**
-   * \brief Static constant for the socket's buffer size.
-   */
-  static const size_t BUFFER_SIZE = 1024;
+  private:
+    /**
+     * \brief The output stream.
+     */
+    std::ostream& stream_;
+  };
 
   /**
-   * \brief A mutex for protecting the clients's HTTP resources.
+   * \brief A content sink that writes to a (file) descriptor.
    */
-  Poco::Mutex http_mutex_;
+  class FileDescriptorSink : public ContentSink
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param fd for the descriptor to write to. It is not closed by the sink.
+     */
+    FileDescriptorSink(const int fd) : fd_(fd) {}
+
+    /**
+     * \brief A method for writing a chunk of the content.
+     *
+     * \param data for the chunk's data.
+     * \param size for the chunk's size [bytes].
+     *
+     * \return bool indicating if the whole chunk was written or not.
+     */
+    bool write(const char* data, const size_t size);
+
+  private:
+    /**
+     * \brief The descriptor.
+     */
+    int fd_;
+  };
 
   /**
-   * \brief A mutex for protecting the client's WebSocket pointer.
+   * \brief An interface for providing a HTTP request's content in chunks, instead of as a whole string.
    *
-   * This mutex must be held while setting or invalidating the p_websocket_ member.
+   * Sources with a known size are sent with a content length (and directly from memory or, on Linux, with sendfile
+   * from a file descriptor), otherwise with chunked transfer encoding.
+   */
+  class ContentSource
+  {
+  public:
+    /**
+     * \brief A destructor.
+     */
+    virtual ~ContentSource() {}
+
+    /**
+     * \brief A method for retrieving the content's size.
+     *
+     * \return Poco::Int64 with the size [bytes], or -1 if it is not known in advance.
+     */
+    virtual Poco::Int64 size() const = 0;
+
+    /**
+     * \brief A method for restarting the content from the beginning (e.g. before the request is retried).
+     *
+     * \return bool indicating if the content could be restarted or not.
+     */
+    virtual bool rewind() = 0;
+
+    /**
+     * \brief A method for reading the next chunk of the content.
+     *
+     * \param data for storing the chunk's data.
+     * \param size for the maximum chunk size [bytes].
+     *
+     * \return size_t with the chunk's size [bytes]. 0 indicates the end of the content.
+     */
+    virtual size_t read(char* data, const size_t size) = 0;
+
+    /**
+     * \brief A method for retrieving the whole content as a region of memory, if the source has it.
+     *
+     * \return const char* to the content, or 0 if it is not available in memory.
+     */
+    virtual const char* memory() const { return 0; }
+
+    /**
+     * \brief A method for retrieving the whole content as a region of a file, if the source has it.
+     *
+     * \param p_offset for storing the region's offset in the file [bytes].
+     *
+     * \return int with the file descriptor, or -1 if the content is not available as a file region.
+     */
+    virtual int fileRegion(Poco::Int64* p_offset) const { return -1; }
+
+    /**
+     * \brief A method for reporting the transfer's progress, called after each chunk.
+     *
+     * \param transferred for the number of bytes transferred so far.
+     * \param total for the total number of bytes, or -1 if it is not known in advance.
+     */
+    virtual void onProgress(const Poco::UInt64 transferred, const Poco::Int64 total) {}
+  };
+
+  /**
+   * \brief A content source for a region of memory (e.g. a memory mapped file). The memory is not copied.
+   */
+  class MemorySource : public ContentSource
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param data for the content. It must stay valid while the source is used.
+     * \param size for the content's size [bytes].
+     */
+    MemorySource(const char* data, const size_t size) : data_(data), size_(size), position_(0) {}
+
+    Poco::Int64 size() const { return static_cast<Poco::Int64>(size_); }
+    bool rewind() { position_ = 0; return true; }
+    size_t read(char* data, const size_t size);
+    const char* memory() const { return data_; }
+
+  private:
+    /**
+     * \brief The content.
+     */
+    const char* data_;
+
+    /**
+     * \brief The content's size [bytes].
+     */
+    size_t size_;
+
+    /**
+     * \brief The current read position [bytes].
+     */
+    size_t position_;
+  };
+
+  /**
+   * \brief A content source for a region of an open file descriptor. The descriptor is not closed by the source.
+   */
+  class FileDescriptorSource : public ContentSource
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param fd for the file descriptor.
+     * \param offset for the region's offset in the file [bytes].
+     * \param size for the region's size [bytes], or -1 for the rest of the file.
+     */
+    FileDescriptorSource(const int fd, const Poco::Int64 offset = 0, const Poco::Int64 size = -1);
+
+    Poco::Int64 size() const { return size_; }
+    bool rewind() { position_ = 0; return true; }
+    size_t read(char* data, const size_t size);
+    int fileRegion(Poco::Int64* p_offset) const;
+
+  protected:
+    /**
+     * \brief A default constructor, for sources that open the descriptor themselves.
+     */
+    FileDescriptorSource() : fd_(-1), offset_(0), size_(-1), position_(0) {}
+
+    /**
+     * \brief A method for setting the descriptor, and the region (i.e. the rest of the file).
+     *
+     * \param fd for the file descriptor.
+     * \param offset for the region's offset in the file [bytes].
+     * \param size for the region's size [bytes], or -1 for the rest of the file.
+     */
+    void setRegion(const int fd, const Poco::Int64 offset, const Poco::Int64 size);
+
+    /**
+     * \brief The file descriptor.
+     */
+    int fd_;
+
+  private:
+    /**
+     * \brief The region's offset in the file [bytes].
+     */
+    Poco::Int64 offset_;
+
+    /**
+     * \brief The region's size [bytes].
+     */
+    Poco::Int64 size_;
+
+    /**
+     * \brief The current read position, relative to the region [bytes].
+     */
+    Poco::Int64 position_;
+  };
+
+  /**
+   * \brief A content source for a whole file, which is opened (and closed) by the source.
+   */
+  class FileSource : public FileDescriptorSource
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param path for the file's path.
+     *
+     * \throw Poco::OpenFileException if the file could not be opened.
+     */
+    FileSource(const std::string& path);
+
+    /**
+     * \brief A destructor, which closes the file.
+     */
+    ~FileSource();
+
+  private:
+    /**
+     * \brief File sources own their descriptor, and can not be copied.
+     */
+    FileSource(const FileSource&);
+
+    /**
+     * \brief File sources own their descriptor, and can not be assigned.
+     */
+    FileSource& operator=(const FileSource&);
+  };
+
+  /**
+   * \brief A struct for containing TLS (HTTPS) options.
+   *
+   * HTTPS requires that the library is built with the ABB_LIBRWS_WITH_NETSSL option.
+   */
+  struct TLSOptions
+  {
+    /**
+     * \brief A default constructor.
+     */
+    TLSOptions()
+    :
+    enabled(false),
+    verify_peer(true),
+    session_resumption(true)
+    {}
+
+    /**
+     * \brief Flag indicating if HTTPS should be used.
+     */
+    bool enabled;
+
+    /**
+     * \brief Path of a file or directory with trusted CA certificates. If empty, the system's defaults are used.
+     */
+    std::string ca_location;
+
+    /**
+     * \brief Flag indicating if the server's certificate should be verified.
+     */
+    bool verify_peer;
+
+    /**
+     * \brief Flag indicating if TLS sessions should be resumed on reconnects (avoiding full handshakes).
+     */
+    bool session_resumption;
+  };
+
+  /**
+   * \brief A struct for containing admission control options, which limit the load that the client puts on the server.
+   *
+   * Requests are admitted by a token bucket (limiting the request rate), and by a concurrency limit (limiting the
+   * number of requests in progress). The concurrency limit adapts to the response latency: it is decreased
+   * multiplicatively when the latency exceeds the target, and increased additively otherwise. Waiting requests are
+   * admitted in priority order (CONTROL, INTERACTIVE, BULK), and in arrival order within a priority.
+   *
+   * CONTROL requests are exempt from the concurrency limit (but not from the rate limit), so they never wait behind
+   * long transfers. Streamed and BULK requests do not affect the latency estimate, since their latency depends on the
+   * transferred size rather than on the server's load.
+   */
+  struct AdmissionOptions
+  {
+    /**
+     * \brief A default constructor.
+     */
+    AdmissionOptions()
+    :
+    rate(0.0),
+    burst(1.0),
+    min_concurrency(1),
+    max_concurrency(4),
+    latency_target(0)
+    {}
+
+    /**
+     * \brief The sustained request rate [requests/s]. 0 means that the rate is not limited.
+     */
+    double rate;
+
+    /**
+     * \brief The token bucket's capacity, i.e. the number of requests that can be made in a burst.
+     */
+    double burst;
+
+    /**
+     * \brief The lower bound for the adaptive concurrency limit.
+     */
+    unsigned int min_concurrency;
+
+    /**
+     * \brief The upper bound for the adaptive concurrency limit (and the initial limit).
+     */
+    unsigned int max_concurrency;
+
+    /**
+     * \brief The response latency target [microseconds]. 0 means that the concurrency limit is fixed at the maximum.
+     */
+    Poco::Int64 latency_target;
+  };
+
+  /**
+   * \brief A struct for containing admission control metrics.
+   */
+  struct AdmissionMetrics
+  {
+    /**
+     * \brief A default constructor.
+     */
+    AdmissionMetrics()
+    :
+    queue_depth(0),
+    in_flight(0),
+    concurrency_limit(0),
+    admitted(0),
+    last_wait(0),
+    average_wait(0),
+    max_wait(0)
+    {}
+
+    /**
+     * \brief The number of requests waiting for admission.
+     */
+    size_t queue_depth;
+
+    /**
+     * \brief The number of admitted requests in progress.
+     */
+    size_t in_flight;
+
+    /**
+     * \brief The current (adaptive) concurrency limit.
+     */
+    unsigned int concurrency_limit;
+
+    /**
+     * \brief The total number of admitted requests.
+     */
+    Poco::UInt64 admitted;
+
+    /**
+     * \brief The most recent wait time for admission [microseconds].
+     */
+    Poco::Int64 last_wait;
+
+    /**
+     * \brief The exponentially weighted average wait time for admission [microseconds].
+     */
+    Poco::Int64 average_wait;
+
+    /**
+     * \brief The longest wait time for admission [microseconds].
+     */
+    Poco::Int64 max_wait;
+  };
+
+  /**
+   * \brief A class for limiting the duration of the HTTP communication made by the current thread, while in scope.
+   *
+   * All HTTP requests that the thread makes through the client (including retries and re-authentication) must be
+   * completed before the deadline, otherwise they fail with a timeout. The deadline replaces the HTTP communication
+   * timeout (i.e. it can both shorten and extend it), and the socket timeouts are adjusted per request, so the
+   * kept-alive session is not reset. Nested deadlines are allowed, and the earliest deadline applies.
+   *
+   * Example: "POCOClient::Deadline deadline(client, 8000);" limits the following calls to 8 ms in total.
+   */
+  class Deadline
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param client for the client to limit.
+     * \param timeout for the time until the deadline [microseconds].
+     */
+    Deadline(POCOClient& client, const Poco::Int64 timeout);
+
+    /**
+     * \brief A destructor, which restores any previous (outer) deadline.
+     */
+    ~Deadline();
+
+  private:
+    /**
+     * \brief Deadlines are scoped, and can not be copied.
+     */
+    Deadline(const Deadline&);
+
+    /**
+     * \brief Deadlines are scoped, and can not be assigned.
+     */
+    Deadline& operator=(const Deadline&);
+
+    /**
+     * \brief The limited client.
+     */
+    POCOClient& client_;
+
+    /**
+     * \brief Flag indicating if there was a previous (outer) deadline.
+     */
+    bool had_previous_;
+
+    /**
+     * \brief The previous (outer) deadline.
+     */
+    Poco::Timestamp previous_;
+  };
+
+  /**
+   * \brief A class for setting the priority of the HTTP requests made by the current thread, while in scope.
+   *
+   * Example: "POCOClient::PriorityScope priority(client, POCOClient::CONTROL);" makes the following calls on the
+   * control lane. Nested scopes are allowed, and the innermost scope applies.
+   */
+  class PriorityScope
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param client for the client.
+     * \param priority for the priority of the requests.
+     */
+    PriorityScope(POCOClient& client, const Priority priority);
+
+    /**
+     * \brief A destructor, which restores any previous (outer) priority.
+     */
+    ~PriorityScope();
+
+  private:
+    /**
+     * \brief Priority scopes can not be copied.
+     */
+    PriorityScope(const PriorityScope&);
+
+    /**
+     * \brief Priority scopes can not be assigned.
+     */
+    PriorityScope& operator=(const PriorityScope&);
+
+    /**
+     * \brief The client.
+     */
+    POCOClient& client_;
+
+    /**
+     * \brief Flag indicating if there was a previous (outer) priority.
+     */
+    bool had_previous_;
+
+    /**
+     * \brief The previous (outer) priority.
+     */
+    Priority previous_;
+  };
+
+  /**
+   * \brief A constructor.
+   *
+   * \param ip_address for the remote server's IP address.
+   * \param port for the remote server's port.
+   * \param username for the username to the remote server's authentication process.
+   * \param password for the password to the remote server's authentication process.
+   */
+  POCOClient(const std::string& ip_address,
+             const Poco::UInt16 port,
+             const std::string& username,
+             const std::string& password)
+  :
+  POCOClient(ip_address, port, username, password, TLSOptions())
+  {}
+
+  /**
+   * \brief A constructor, for a server that may require HTTPS.
+   *
+   * \param ip_address for the remote server's IP address.
+   * \param port for the remote server's port.
+   * \param username for the username to the remote server's authentication process.
+   * \param password for the password to the remote server's authentication process.
+   * \param tls for the TLS options (i.e. if HTTPS should be used).
+   *
+   * \throw Poco::NotImplementedException if TLS is enabled, but the library was built without HTTPS support.
+   */
+  POCOClient(const std::string& ip_address,
+             const Poco::UInt16 port,
+             const std::string& username,
+             const std::string& password,
+             const TLSOptions& tls)
+  :
+  p_http_client_session_(createSession(ip_address, port, tls)),
+  http_client_session_(*p_http_client_session_),
+  p_kept_alive_session_(dynamic_cast<KeptAliveSession*>(p_http_client_session_.get())),
+  http_credentials_(username, password),
+  http_timeout_(DEFAULT_HTTP_TIMEOUT),
+  deadline_applied_(false),
+  accept_compressed_responses_(false),
+  compress_requests_(false),
+  keeper_interval_(DEFAULT_SESSION_KEEPER_INTERVAL),
+  keeper_running_(false),
+  keeper_runnable_(*this, &POCOClient::keepSession),
+  spare_ready_(false),
+  ip_address_(ip_address),
+  port_(port),
+  username_(username),
+  password_(password),
+  tls_(tls),
+  p_root_(0),
+  admission_enabled_(false),
+  next_ticket_(0),
+  tokens_(0.0),
+  concurrency_limit_(0.0),
+  control_in_flight_(0)
+  {
+    http_client_session_.setKeepAlive(true);
+    http_client_session_.setTimeout(Poco::Timespan(DEFAULT_HTTP_TIMEOUT));
+  }
+
+  /**
+   * \brief A destructor.
+   */
+  virtual ~POCOClient()
+  {
+    stopSessionKeeper();
+  }
+
+  /**
+   * \brief A method for sending a HTTP GET request.
+   *
+   * \param uri for the URI (path and query).
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult httpGet(const std::string& uri);
+
+  /**
+   * \brief A method for sending a HTTP GET request, and streaming a successful response's content to a sink.
+   *
+   * The content is read in fixed-size chunks, so the memory use is bounded regardless of the content's size. The
+   * result does not contain the streamed content.
+   *
+   * \param uri for the URI (path and query).
+   * \param sink for the sink to stream the content to.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult httpGet(const std::string& uri, ContentSink& sink);
+
+  /**
+   * \brief A method for sending a HTTP POST request.
+   *
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult httpPost(const std::string& uri, const std::string& content = "");
+
+  /**
+   * \brief A method for sending a HTTP PUT request.
+   *
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult httpPut(const std::string& uri, const std::string& content = "");
+
+  /**
+   * \brief A method for sending a HTTP PUT request, with the content streamed from a source.
+   *
+   * \param uri for the URI (path and query).
+   * \param source for the source of the request's content.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult httpPut(const std::string& uri, ContentSource& source);
+
+  /**
+   * \brief A method for sending a HTTP DELETE request.
+   *
+   * \param uri for the URI (path and query).
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult httpDelete(const std::string& uri);
+
+  /**
+   * \brief A method for sending several HTTP GET requests, pipelined on the kept-alive connection.
+   *
+   * The requests are written back-to-back (in windows of at most MAX_PIPELINE_DEPTH requests), and the responses are
+   * read in order. If the server misbehaves (e.g. closes the connection, responds without a known content length,
+   * requires re-authentication or reports a server error), then the session is reset and the remaining requests are
+   * sent serially, as with httpGet(...).
+   *
+   * \param uris for the URIs (paths and queries).
+   *
+   * \return std::vector<POCOResult> containing the results, in the same order as the URIs.
+   */
+  std::vector<POCOResult> httpGetPipelined(const std::vector<std::string>& uris);
+
+  /**
+   * \brief A method for setting the HTTP communication timeout.
+   *
+   * \note The timeout is applied to the kept-alive connection directly, so the HTTP client session is not reset.
+   *       Use a Deadline for limiting individual calls.
+   *
+   * \param timeout for the HTTP communication timeout [microseconds].
+   */
+  void setHTTPTimeout(const Poco::Int64 timeout);
+
+  /**
+   * \brief A method for setting the socket level transport options.
+   *
+   * The options are applied to the current HTTP connection directly, and to the WebSocket when it is next connected.
+   *
+   * \param options for the transport options.
+   */
+  void setTransportOptions(const TransportOptions& options);
+
+  /**
+   * \brief A method for enabling or disabling compressed (gzip/deflate) HTTP contents.
+   *
+   * \note Compressed requests are only understood by servers that accept a "Content-Encoding: gzip" request.
+   *
+   * \param responses for indicating if compressed responses should be accepted (and inflated while they are read).
+   * \param requests for indicating if large request contents should be sent compressed.
+   */
+  void setCompression(const bool responses, const bool requests = false);
+
+  /**
+   * \brief A method for checking if a priority class' dedicated lane has been created (i.e. used).
+   *
+   * \param priority for the priority class.
+   *
+   * \return bool indicating if the lane exists or not. INTERACTIVE always exists.
+   */
+  bool laneExists(const Priority priority);
+
+  /**
+   * \brief A method for enabling admission control (rate and concurrency limiting) for the client and its lanes.
+   *
+   * \param options for the admission control options.
+   */
+  void setAdmissionControl(const AdmissionOptions& options);
+
+  /**
+   * \brief A method for disabling admission control (the default).
+   */
+  void disableAdmissionControl();
+
+  /**
+   * \brief A method for retrieving the admission control metrics.
+   *
+   * \return AdmissionMetrics containing the metrics.
+   */
+  AdmissionMetrics getAdmissionMetrics();
+
+  /**
+   * \brief A method for starting a background session keeper.
+   *
+   * The keeper connects and authenticates the session up front, and refreshes it (with a GET request) whenever it
+   * has been idle for the refresh interval, so the server does not close it. It also keeps a spare connection warm,
+   * which is swapped in if a request fails on a kept-alive connection that the server has closed.
+   *
+   * \param uri for the URI (path and query) of a cheap resource to refresh the session with.
+   * \param refresh_interval for the refresh interval [microseconds]. Should be shorter than the server's idle timeout.
+   */
+  void startSessionKeeper(const std::string& uri,
+                          const Poco::Int64 refresh_interval = DEFAULT_SESSION_KEEPER_INTERVAL);
+
+  /**
+   * \brief A method for stopping the background session keeper (if started).
+   */
+  void stopSessionKeeper();
+
+  /**
+   * \brief A method for checking if the WebSocket exist.
+   *
+   * \return bool flag indicating if the WebSocket exist or not.
+   */
+  bool webSocketExist() { return !p_websocket_.isNull(); }
+
+  /**
+   * \brief A method for connecting a WebSocket.
+   *
+   * \param uri for the URI (path and query).
+   * \param protocol for the WebSocket protocol.
+   * \param timeout for the WebSocket communication timeout [microseconds].
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult webSocketConnect(const std::string& uri, const std::string& protocol, const Poco::Int64 timeout);
+
+  /**
+   * \brief A method for receiving a WebSocket frame.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult webSocketReceiveFrame();
+
+  /**
+   * \brief Forcibly shut down the websocket connection.
+   *
+   * The connection is shut down immediately.
+   * Subsequently, the function will block until a current call to webSocketReceiveFrame() has finished,
+   * before cleaning up the local state.
+   *
+   * Note that since mutexes do not guarantee the order of acquisition for multiple contenders,
+   * it is undefined how many calls to webSocketReceiveFrame() will still attempt to use the shut down
+   * connection before the local state is cleaned. Those invocation will throw a runtime error.
+   */
+  void webSocketShutdown();
+
+  /**
+   * \brief A method for retrieving a substring in a string.
+   *
+   * \param whole_string for the string containing the substring.
+   * \param substring_start start of the substring.
+   * \param substring_end end of the substring.
+   *
+   * \return string containing the substring.
+   */
+  std::string findSubstringContent(const std::string& whole_string,
+                                   const std::string& substring_start,
+                                   const std::string& substring_end);
+
+protected:
+  /**
+   * \brief A method called before, and after, each request that may modify the server's resources (i.e. not GET).
+   *
+   * Derived clients can override it, e.g. to invalidate cached or in-flight reads.
+   *
+   * \param uri for the request's URI (path and query).
+   */
+  virtual void onModifyingRequest(const std::string& uri) {}
+
+  /**
+   * \brief A method for retrieving the current thread's priority.
+   *
+   * \return Priority of the thread's requests (INTERACTIVE if no priority scope is active).
+   */
+  Priority findPriority();
+
+  /**
+   * \brief A method for retrieving the current thread's deadline (if any).
+   *
+   * \param p_deadline for storing the deadline.
+   *
+   * \return bool indicating if the thread has a deadline or not.
+   */
+  bool findDeadline(Poco::Timestamp* p_deadline);
+
+private:
+  /**
+   * \brief A method for making a HTTP request, on the lane for the current thread's priority.
+   *
+   * \param method for the request's method.
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   * \param p_sink for an optional sink to stream a successful response's content to.
+   * \param p_source for an optional source to stream the request's content from.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult makeHTTPRequest(const std::string& method,
+                             const std::string& uri = "/",
+                             const std::string& content = "",
+                             ContentSink* p_sink = 0,
+                             ContentSource* p_source = 0);
+
+  /**
+   * \brief A method for performing a HTTP request on this client's own session.
+   *
+   * \param method for the request's method.
+   * \param uri for the URI (path and query).
+   * \param content for the request's content.
+   * \param p_sink for an optional sink to stream a successful response's content to.
+   * \param p_source for an optional source to stream the request's content from.
+   *
+   * \return POCOResult containing the result.
+   */
+  POCOResult performHTTPRequest(const std::string& method,
+                                const std::string& uri,
+                                const std::string& content,
+                                ContentSink* p_sink,
+                                ContentSource* p_source);
+
+  /**
+   * \brief A method for sending and receiving HTTP messages.
+   *
+   * \param result for the result.
+   * \param request for the HTTP request.
+   * \param p_response for the HTTP response (shared with the result).
+   * \param request_content for the request's content.
+   * \param p_sink for an optional sink to stream a successful response's content to.
+   * \param p_source for an optional source to stream the request's content from (instead of request_content).
+   */
+  void sendAndReceive(POCOResult& result,
+                      Poco::Net::HTTPRequest& request,
+                      const Poco::SharedPtr<Poco::Net::HTTPResponse>& p_response,
+                      const std::string& request_content,
+                      ContentSink* p_sink = 0,
+                      ContentSource* p_source = 0);
+
+  /**
+   * \brief A method for sending a request's content from a source.
+   *
+   * \param request_stream for the request's stream.
+   * \param source for the source.
+   *
+   * \throw Poco::IOException if the source fails, or does not match its size.
+   */
+  void sendContent(std::ostream& request_stream, ContentSource& source);
+
+  /**
+   * \brief A method for performing authentication.
+   *
+   * \param result for the result.
+   * \param request for the HTTP request.
+   * \param p_response for the HTTP response (shared with the result).
+   * \param request_content for the request's content.
+   * \param p_sink for an optional sink to stream a successful response's content to.
+   * \param p_source for an optional source to stream the request's content from (it is rewound before resending).
+   */
+  void authenticate(POCOResult& result,
+                    Poco::Net::HTTPRequest& request,
+                    const Poco::SharedPtr<Poco::Net::HTTPResponse>& p_response,
+                    const std::string& request_content,
+                    ContentSink* p_sink = 0,
+                    ContentSource* p_source = 0);
+
+  /**
+   * \brief A method for applying the current thread's deadline (if any) to the session's timeouts.
+   *
+   * \throw Poco::TimeoutException if the deadline has passed.
+   */
+  void applyDeadline();
+
+  /**
+   * \brief A method for restoring the session's timeouts, after a deadline has been applied.
+   */
+  void restoreTimeout();
+
+  /**
+   * \brief A method for applying a timeout to the session, and to its connection (if connected).
+   *
+   * \param timeout for the timeout [microseconds].
+   */
+  void applyTimeout(const Poco::Int64 timeout);
+
+  /**
+   * \brief A method for waiting until a request is admitted (if admission control is enabled).
+   *
+   * \param cost for the number of requests to admit together (e.g. a pipelined batch).
+   * \param p_admitted for indicating if the request was counted (and must be released), or not.
+   *
+   * \return bool indicating if the request may proceed, or not (i.e. the thread's deadline passed while waiting).
+   */
+  bool acquireAdmission(const size_t cost, bool* p_admitted);
+
+  /**
+   * \brief A method for releasing an admitted request, and adapting the concurrency limit to its latency.
+   *
+   * \param latency for the request's latency [microseconds].
+   * \param sample_latency indicating if the latency is representative of the server's load (i.e. not for a stream).
+   */
+  void releaseAdmission(const Poco::Int64 latency, const bool sample_latency);
+
+  /**
+   * \brief A method for refilling the token bucket, according to the elapsed time.
+   */
+  void refillTokens();
+
+  /**
+   * \brief A method for finding the lane (i.e. client) for the current thread's priority, creating it if needed.
+   *
+   * \return POCOClient* to the lane. This client for INTERACTIVE priority, and for lanes themselves.
+   */
+  POCOClient* findLane();
+
+  /**
+   * \brief A method for retrieving the dedicated lanes that have been created.
+   *
+   * \return std::vector<Poco::SharedPtr<POCOClient> > containing the lanes.
+   */
+  std::vector<Poco::SharedPtr<POCOClient> > createdLanes();
+
+  /**
+   * \brief A method for creating a HTTP client session (plain or secure).
+   *
+   * \param ip_address for the remote server's IP address.
+   * \param port for the remote server's port.
+   * \param tls for the TLS options.
+   *
+   * \return Poco::Net::HTTPClientSession* to the new session.
+   *
+   * \throw Poco::NotImplementedException if TLS is enabled, but the library was built without HTTPS support.
+   */
+  static Poco::Net::HTTPClientSession* createSession(const std::string& ip_address,
+                                                     const Poco::UInt16 port,
+                                                     const TLSOptions& tls);
+
+  /**
+   * \brief A method for replacing the session's connection, with the spare connection if one is ready.
+   */
+  void replaceConnection();
+
+  /**
+   * \brief The session keeper's main loop.
+   */
+  void keepSession();
+
+  /**
+   * \brief A method for refreshing the session, if it has been idle for the refresh interval.
+   */
+  void refreshSession();
+
+  /**
+   * \brief A method for (re)connecting the spare connection, if it is missing or old.
+   */
+  void refreshSpareConnection();
+
+  /**
+   * \brief A method for extracting and storing information from a cookie string.
+   *
+   * \param cookie_string for the cookie string.
+   */
+  void extractAndStoreCookie(const std::string& cookie_string);
+
+  /**
+   * \brief A method for storing (adding or updating) the cookies received in a HTTP response.
+   *
+   * \param response for the HTTP response.
+   */
+  void storeCookies(const Poco::Net::HTTPResponse& response);
+
+  /**
+   * \brief A HTTP client session, which can adopt an already connected socket.
+   */
+  class KeptAliveSession : public Poco::Net::HTTPClientSession
+  {
+  public:
+    /**
+     * \brief A constructor.
+     *
+     * \param host for the remote server's host.
+     * \param port for the remote server's port.
+     */
+    KeptAliveSession(const std::string& host, const Poco::UInt16 port)
+    :
+    Poco::Net::HTTPClientSession(host, port)
+    {}
+
+    using Poco::Net::HTTPClientSession::attachSocket;
+  };
+
+  /**
+   * \brief Static constant for the default HTTP communication timeout [microseconds].
+   */
+  static const Poco::Int64 DEFAULT_HTTP_TIMEOUT = 400e3;
+
+  /**
+   * \brief Static constant for the socket's buffer size.
+   */
+  static const size_t BUFFER_SIZE = 1024;
+
+  /**
+   * \brief Static constant for the maximum number of pipelined HTTP requests in flight.
+   */
+  static const size_t MAX_PIPELINE_DEPTH = 8;
+
+  /**
+   * \brief Static constant for the chunk size used when streaming contents [bytes].
+   */
+  static const size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+  /**
+   * \brief Static constant for the minimum size of a request content to compress [bytes].
+   */
+  static const size_t MIN_COMPRESSED_REQUEST_SIZE = 1024;
+
+  /**
+   * \brief A mutex for protecting the clients's HTTP resources.
+   */
+  Poco::Mutex http_mutex_;
+
+  /**
+   * \brief A mutex for protecting the client's WebSocket pointer.
+   *
+   * This mutex must be held while setting or invalidating the p_websocket_ member.
    * Note that the websocket_use_mutex_ must also be held while invalidating the pointer,
    * since someone may be using it otherwise.
    *
@@ -457,9 +1559,29 @@ private:
   Poco::Mutex websocket_use_mutex_;
 
   /**
-   * \brief A HTTP client session.
+   * \brief A mutex for protecting the deadlines.
+   */
+  Poco::Mutex deadlines_mutex_;
+
+  /**
+   * \brief Active deadlines, per thread.
+   */
+  std::map<Poco::Thread::TID, Poco::Timestamp> deadlines_;
+
+  /**
+   * \brief The HTTP client session (owned).
    */
-  Poco::Net::HTTPClientSession http_client_session_;
+  Poco::SharedPtr<Poco::Net::HTTPClientSession> p_http_client_session_;
+
+  /**
+   * \brief A HTTP client session (plain or secure).
+   */
+  Poco::Net::HTTPClientSession& http_client_session_;
+
+  /**
+   * \brief The HTTP client session, if it is plain (i.e. can adopt spare connections and use sendfile), otherwise 0.
+   */
+  KeptAliveSession* p_kept_alive_session_;
 
   /**
    * \brief HTTP credentials for the remote server's access authentication process.
@@ -471,6 +1593,197 @@ private:
    */
   Poco::Net::NameValueCollection cookies_;
 
+  /**
+   * \brief The HTTP communication timeout [microseconds], used when no deadline applies.
+   */
+  Poco::Int64 http_timeout_;
+
+  /**
+   * \brief Flag indicating if a deadline has been applied to the session's timeouts.
+   */
+  bool deadline_applied_;
+
+  /**
+   * \brief The socket level transport options.
+   */
+  TransportOptions transport_options_;
+
+  /**
+   * \brief Flag indicating if compressed responses are accepted.
+   */
+  bool accept_compressed_responses_;
+
+  /**
+   * \brief Flag indicating if large request contents are compressed.
+   */
+  bool compress_requests_;
+
+  /**
+   * \brief A mutex for protecting the settings copied by new lanes (the HTTP timeout, the transport options and the
+   *        compression flags). The setters write them under both this mutex and the object's mutex.
+   */
+  Poco::FastMutex settings_mutex_;
+
+  /**
+   * \brief Time of the latest HTTP request.
+   */
+  Poco::Timestamp last_activity_;
+
+  /**
+   * \brief URI (path and query) used by the session keeper for refreshing the session.
+   */
+  std::string keeper_uri_;
+
+  /**
+   * \brief The session keeper's refresh interval [microseconds].
+   */
+  Poco::Int64 keeper_interval_;
+
+  /**
+   * \brief Flag indicating if the session keeper is running.
+   */
+  bool keeper_running_;
+
+  /**
+   * \brief Event for stopping the session keeper.
+   */
+  Poco::Event keeper_stop_event_;
+
+  /**
+   * \brief Runnable for the session keeper.
+   */
+  Poco::RunnableAdapter<POCOClient> keeper_runnable_;
+
+  /**
+   * \brief The session keeper's thread.
+   */
+  Poco::Thread keeper_thread_;
+
+  /**
+   * \brief A spare, already connected, socket to the remote server.
+   */
+  Poco::Net::StreamSocket spare_socket_;
+
+  /**
+   * \brief Flag indicating if the spare socket is connected and ready.
+   */
+  bool spare_ready_;
+
+  /**
+   * \brief Time when the spare socket was connected.
+   */
+  Poco::Timestamp spare_connected_;
+
+  /**
+   * \brief The remote server's IP address.
+   */
+  std::string ip_address_;
+
+  /**
+   * \brief The remote server's port.
+   */
+  Poco::UInt16 port_;
+
+  /**
+   * \brief The username to the remote server's authentication process.
+   */
+  std::string username_;
+
+  /**
+   * \brief The password to the remote server's authentication process.
+   */
+  std::string password_;
+
+  /**
+   * \brief The TLS options.
+   */
+  TLSOptions tls_;
+
+  /**
+   * \brief The client that owns this client as a lane (0 if this client is not a lane).
+   */
+  POCOClient* p_root_;
+
+  /**
+   * \brief A mutex for protecting the lanes and priorities (never held while communicating).
+   */
+  Poco::Mutex lanes_mutex_;
+
+  /**
+   * \brief Active priorities, per thread.
+   */
+  std::map<Poco::Thread::TID, Priority> priorities_;
+
+  /**
+   * \brief The dedicated lane for CONTROL requests (created when first used).
+   */
+  Poco::SharedPtr<POCOClient> p_control_lane_;
+
+  /**
+   * \brief The dedicated lane for BULK requests (created when first used).
+   */
+  Poco::SharedPtr<POCOClient> p_bulk_lane_;
+
+  /**
+   * \brief A mutex for protecting the admission control state.
+   */
+  Poco::Mutex admission_mutex_;
+
+  /**
+   * \brief A condition for signaling changes of the admission control state.
+   */
+  Poco::Condition admission_condition_;
+
+  /**
+   * \brief Flag indicating if admission control is enabled.
+   */
+  bool admission_enabled_;
+
+  /**
+   * \brief The admission control options.
+   */
+  AdmissionOptions admission_options_;
+
+  /**
+   * \brief Requests waiting for admission, ordered by priority and then by ticket number.
+   */
+  std::set<std::pair<int, Poco::UInt64> > admission_queue_;
+
+  /**
+   * \brief The next admission ticket number.
+   */
+  Poco::UInt64 next_ticket_;
+
+  /**
+   * \brief The tokens currently available in the token bucket.
+   */
+  double tokens_;
+
+  /**
+   * \brief The time of the latest token bucket refill.
+   */
+  Poco::Timestamp last_refill_;
+
+  /**
+   * \brief The current (adaptive) concurrency limit.
+   */
+  double concurrency_limit_;
+
+  /**
+   * \brief The time of the latest concurrency limit decrease.
+   */
+  Poco::Timestamp last_decrease_;
+
+  /**
+   * \brief The number of admitted CONTROL requests in progress (which are exempt from the concurrency limit).
+   */
+  size_t control_in_flight_;
+
+  /**
+   * \brief The admission control metrics.
+   */
+  AdmissionMetrics admission_metrics_;
+
   /**
    * \brief A buffer for a WebSocket.
    */
@@ -0,0 +1,198 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+/**
+ * The intention of this file is to provide batch kernels for common pose calculations,
+ * operating on the structure-of-arrays containers in rws_rapid_batch.h.
+ *
+ * The kernels use AVX or SSE instructions when the library is compiled with support for them
+ * (e.g. with -mavx or -msse2), and otherwise fall back to plain scalar code.
+ *
+ * Conventions (same as in RAPID):
+ * - Quaternions are stored as [q1, q2, q3, q4] = [w, x, y, z].
+ * - Positions are in [mm], unless converted with scalePositions(...).
+ */
+
+#ifndef RWS_POSE_MATH_H
+#define RWS_POSE_MATH_H
+
+#include <vector>
+
+#include "rws_rapid.h"
+#include "rws_rapid_batch.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief Scale factor for converting positions from [mm] to [m].
+ */
+const float MM_TO_M = 0.001f;
+
+/**
+ * \brief Scale factor for converting positions from [m] to [mm].
+ */
+const float M_TO_MM = 1000.0f;
+
+/**
+ * \brief A function for retrieving the name of the instruction set used by the batch kernels.
+ *
+ * \return const char* containing "AVX", "SSE" or "scalar".
+ */
+const char* poseMathInstructionSet();
+
+/**
+ * \brief A function for composing two poses, i.e. calculating a * b.
+ *
+ * \param a for the left hand side pose (e.g. a frame).
+ * \param b for the right hand side pose (e.g. a pose expressed in the frame).
+ *
+ * \return Pose containing the composed pose.
+ */
+Pose composePose(const Pose& a, const Pose& b);
+
+/**
+ * \brief A function for inverting a pose.
+ *
+ * \param pose for the pose to invert (the rotation quaternion is assumed to be normalized).
+ *
+ * \return Pose containing the inverted pose.
+ */
+Pose invertPose(const Pose& pose);
+
+/**
+ * \brief A function for normalizing quaternions in place.
+ *
+ * Quaternions with zero norm are left unchanged.
+ *
+ * \param p_orient for the quaternions to normalize.
+ */
+void normalizeOrientations(OrientBatch* p_orient);
+
+/**
+ * \brief A function for scaling positions in place (e.g. by MM_TO_M or M_TO_MM).
+ *
+ * \param p_pos for the positions to scale.
+ * \param factor specifying the scale factor.
+ */
+void scalePositions(PosBatch* p_pos, const float factor);
+
+/**
+ * \brief A function for transforming poses into another frame, i.e. calculating frame * pose[i] in place.
+ *
+ * \param frame specifying the frame which the poses are currently expressed in.
+ * \param p_pos for the positions to transform.
+ * \param p_orient for the orientations to transform.
+ */
+void transformPoses(const Pose& frame, PosBatch* p_pos, OrientBatch* p_orient);
+
+/**
+ * \brief A function for applying a frame offset to poses, i.e. calculating pose[i] * frame in place.
+ *
+ * \param p_pos for the positions to transform.
+ * \param p_orient for the orientations to transform.
+ * \param frame specifying the offset frame (expressed in each pose's frame).
+ */
+void offsetPoses(PosBatch* p_pos, OrientBatch* p_orient, const Pose& frame);
+
+/**
+ * \brief A function for transforming poses into another frame, i.e. calculating frame * pose[i] in place.
+ *
+ * \param frame specifying the frame which the poses are currently expressed in.
+ * \param p_poses for the poses to transform.
+ */
+void transformPoses(const Pose& frame, PoseBatch* p_poses);
+
+/**
+ * \brief A function for transforming robtargets, expressed in a work object, into the work object's parent frame.
+ *
+ * I.e. calculating uframe * oframe * robtarget[i] in place. The work object is assumed to be stationary.
+ *
+ * \param wobj specifying the work object which the robtargets are expressed in.
+ * \param p_robtargets for the robtargets to transform.
+ */
+void transformFromWObj(const WObjData& wobj, RobTargetBatch* p_robtargets);
+
+/**
+ * \brief A function for transforming robtargets, expressed in a parent frame, into a work object.
+ *
+ * I.e. calculating inverse(uframe * oframe) * robtarget[i] in place. The work object is assumed to be stationary.
+ *
+ * \param wobj specifying the work object to express the robtargets in.
+ * \param p_robtargets for the robtargets to transform.
+ */
+void transformToWObj(const WObjData& wobj, RobTargetBatch* p_robtargets);
+
+/**
+ * \brief A function for converting tool center point (TCP) robtargets into robot flange (tool0) robtargets.
+ *
+ * I.e. calculating robtarget[i] * inverse(tframe) in place.
+ *
+ * \param tool specifying the tool which the robtargets refer to.
+ * \param p_robtargets for the robtargets to convert.
+ */
+void removeTool(const ToolData& tool, RobTargetBatch* p_robtargets);
+
+/**
+ * \brief A function for converting robot flange (tool0) robtargets into tool center point (TCP) robtargets.
+ *
+ * I.e. calculating robtarget[i] * tframe in place.
+ *
+ * \param tool specifying the tool which the robtargets should refer to.
+ * \param p_robtargets for the robtargets to convert.
+ */
+void applyTool(const ToolData& tool, RobTargetBatch* p_robtargets);
+
+/**
+ * \brief A function for checking that positions are finite and that quaternions are normalized.
+ *
+ * \param pos for the positions to check.
+ * \param orient for the orientations to check (must have the same size as pos).
+ * \param tolerance specifying the accepted deviation of the squared quaternion norm from 1.
+ * \param p_valid for optionally storing a flag (1 or 0) for each pose. Can be null.
+ *
+ * \return size_t containing the number of invalid poses.
+ */
+size_t validatePoses(const PosBatch& pos,
+                     const OrientBatch& orient,
+                     const float tolerance = 1e-3f,
+                     std::vector<unsigned char>* p_valid = 0);
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
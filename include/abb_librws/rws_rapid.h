@@ -37,9 +37,11 @@
 #ifndef RWS_RAPID_H
 #define RWS_RAPID_H
 
+#include <locale>
 #include <string>
 #include <vector>
 #include <sstream>
+#include <utility>
 
 #include "Poco/SharedPtr.h"
 
@@ -47,6 +49,8 @@ namespace abb
 {
 namespace rws
 {
+class RAPIDBinaryReader;
+
 /**
  * \brief An enum for different RAPID atomic data types.
  */
@@ -84,6 +88,69 @@ public:
    * \return std::string containing the constructed string.
    */
   virtual std::string constructString() const = 0;
+
+  /**
+   * \brief A method for checking if the symbol's data type has a specific name, without allocating any strings.
+   *
+   * The default implementation compares against the result of getType().
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the data type has the specified name or not.
+   */
+  virtual bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing a RAPID symbol data value string, directly from a character buffer.
+   *
+   * The default implementation copies the characters and calls parseString(...).
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  virtual void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending a RAPID symbol data value string to a buffer.
+   *
+   * The default implementation appends the result of constructString().
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  virtual void appendTo(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for appending the data's compact binary encoding to a buffer.
+   *
+   * The default implementation encodes the RAPID symbol data value string. Atomic data and records override it
+   * with a fixed binary layout. See rws_rapid_binary.h for details.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  virtual void appendBinary(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for decoding the data from its compact binary encoding.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the decoding was successful or not.
+   */
+  virtual bool parseBinary(RAPIDBinaryReader* p_reader);
+
+  /**
+   * \brief A method for skipping the data's compact binary encoding, without decoding it (i.e. for validating that the
+   *        encoding is complete, before any data is modified).
+   *
+   * The default implementation skips an encoded value string. Types that override parseBinary(...) must also
+   * override this method.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the encoding was complete or not.
+   */
+  virtual bool skipBinary(RAPIDBinaryReader* p_reader) const;
 };
 
 /**
@@ -96,11 +163,14 @@ public:
   /**
    * \brief A method for parsing a RAPID symbol data value string.
    *
+   * Note: The string is parsed with the classic "C" locale, since RAPID always uses '.' as decimal point.
+   *
    * \param value_string containing the string to parse.
    */
   void parseString(const std::string& value_string)
   {
     std::stringstream ss(value_string);
+    ss.imbue(std::locale::classic());
     ss >> value;
   }
 
@@ -156,6 +226,56 @@ struct RAPIDAtomic<RAPID_BOOL> : public RAPIDAtomicTemplate<bool>
    * \return std::string containing the constructed string.
    */
   std::string constructString() const;
+
+  /**
+   * \brief A method for checking if the symbol's data type has a specific name, without allocating any strings.
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the data type has the specified name or not.
+   */
+  bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing a RAPID symbol data value string, directly from a character buffer.
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending a RAPID symbol data value string to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendTo(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for appending the data's binary encoding (one byte) to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendBinary(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for decoding the data from its binary encoding.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the decoding was successful or not.
+   */
+  bool parseBinary(RAPIDBinaryReader* p_reader);
+
+  /**
+   * \brief A method for skipping the data's binary encoding, without decoding it.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the encoding was complete or not.
+   */
+  bool skipBinary(RAPIDBinaryReader* p_reader) const;
 };
 
 /**
@@ -184,6 +304,56 @@ struct RAPIDAtomic<RAPID_NUM> : public RAPIDAtomicTemplate<float>
    * \return std::string containing the constructed string.
    */
   std::string constructString() const;
+
+  /**
+   * \brief A method for checking if the symbol's data type has a specific name, without allocating any strings.
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the data type has the specified name or not.
+   */
+  bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing a RAPID symbol data value string, directly from a character buffer.
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending a RAPID symbol data value string to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendTo(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for appending the data's binary encoding (a four byte IEEE 754 value) to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendBinary(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for decoding the data from its binary encoding.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the decoding was successful or not.
+   */
+  bool parseBinary(RAPIDBinaryReader* p_reader);
+
+  /**
+   * \brief A method for skipping the data's binary encoding, without decoding it.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the encoding was complete or not.
+   */
+  bool skipBinary(RAPIDBinaryReader* p_reader) const;
 };
 
 /**
@@ -212,6 +382,56 @@ struct RAPIDAtomic<RAPID_DNUM> : public RAPIDAtomicTemplate<double>
    * \return std::string containing the constructed string.
    */
   std::string constructString() const;
+
+  /**
+   * \brief A method for checking if the symbol's data type has a specific name, without allocating any strings.
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the data type has the specified name or not.
+   */
+  bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing a RAPID symbol data value string, directly from a character buffer.
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending a RAPID symbol data value string to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendTo(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for appending the data's binary encoding (a eight byte IEEE 754 value) to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendBinary(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for decoding the data from its binary encoding.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the decoding was successful or not.
+   */
+  bool parseBinary(RAPIDBinaryReader* p_reader);
+
+  /**
+   * \brief A method for skipping the data's binary encoding, without decoding it.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the encoding was complete or not.
+   */
+  bool skipBinary(RAPIDBinaryReader* p_reader) const;
 };
 
 /**
@@ -247,6 +467,56 @@ struct RAPIDAtomic<RAPID_STRING> : public RAPIDAtomicTemplate<std::string>
    * \return std::string containing the constructed string.
    */
   std::string constructString() const;
+
+  /**
+   * \brief A method for checking if the symbol's data type has a specific name, without allocating any strings.
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the data type has the specified name or not.
+   */
+  bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing a RAPID symbol data value string, directly from a character buffer.
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending a RAPID symbol data value string to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendTo(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for appending the data's binary encoding (length prefixed characters) to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendBinary(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for decoding the data from its binary encoding.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the decoding was successful or not.
+   */
+  bool parseBinary(RAPIDBinaryReader* p_reader);
+
+  /**
+   * \brief A method for skipping the data's binary encoding, without decoding it.
+   *
+   * \param p_reader for the reader positioned at the start of the data's encoding.
+   *
+   * \return bool indicating if the encoding was complete or not.
+   */
+  bool skipBinary(RAPIDBinaryReader* p_reader) const;
 };
 
 /**
@@ -289,6 +559,31 @@ public:
    */
   std::string constructString() const;
 
+  /**
+   * \brief A method for checking if the symbol's data type has a specific name, without allocating any strings.
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the data type has the specified name or not.
+   */
+  bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing a RAPID symbol data value string, directly from a character buffer.
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending a RAPID symbol data value string to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendTo(std::string* p_buffer) const;
+
   /**
    * \brief A method for parsing a RAPID symbol data value string.
    *
@@ -303,6 +598,31 @@ public:
    */
   std::string getType() const;
 
+  /**
+   * \brief A method for appending the record's binary encoding (its components' encodings, in order) to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendBinary(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for decoding the record from its binary encoding.
+   *
+   * \param p_reader for the reader positioned at the start of the record's encoding.
+   *
+   * \return bool indicating if the decoding was successful or not.
+   */
+  bool parseBinary(RAPIDBinaryReader* p_reader);
+
+  /**
+   * \brief A method for skipping the record's binary encoding (its components' encodings), without decoding it.
+   *
+   * \param p_reader for the reader positioned at the start of the record's encoding.
+   *
+   * \return bool indicating if the encoding was complete or not.
+   */
+  bool skipBinary(RAPIDBinaryReader* p_reader) const;
+
   /**
    * \brief Operator for copying the RAPID record to another RAPID record.
    *
@@ -343,6 +663,125 @@ protected:
   std::vector<RAPIDSymbolDataAbstract*> components_;
 };
 
+/**
+ * \brief A struct, for representing the data of a RAPID record symbol, which is decoded on demand.
+ *
+ * Parsing only stores the raw value string and indexes the boundaries of its top level fields (in one scan). A field
+ * is converted first when it is accessed, so partial reads of large records (e.g. EGM settings, or user defined
+ * records with many fields) only cost in proportion to the fields that are used.
+ */
+struct RAPIDLazyRecord : public RAPIDSymbolDataAbstract
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param record_type_name specifying the name of the RAPID record type (i.e. its name in the RAPID code).
+   */
+  RAPIDLazyRecord(const std::string& record_type_name);
+
+  /**
+   * \brief A method for getting the type of the RAPID record.
+   *
+   * \return std::string containing the type.
+   */
+  std::string getType() const;
+
+  /**
+   * \brief A method for parsing (i.e. storing and indexing) a RAPID symbol data value string.
+   *
+   * \param value_string containing the string to parse.
+   */
+  void parseString(const std::string& value_string);
+
+  /**
+   * \brief A method for constructing a RAPID symbol data value string (i.e. the stored raw string).
+   *
+   * \return std::string containing the constructed string.
+   */
+  std::string constructString() const;
+
+  /**
+   * \brief A method for checking if the record's type has a specific name, without allocating any strings.
+   *
+   * \param p_type_name for the characters of the type name to check.
+   * \param length specifying the number of characters.
+   *
+   * \return bool indicating if the record type has the specified name or not.
+   */
+  bool isType(const char* p_type_name, const size_t length) const;
+
+  /**
+   * \brief A method for parsing (i.e. storing and indexing) a RAPID symbol data value string from a character buffer.
+   *
+   * \param p_value for the characters to parse (need not be null terminated).
+   * \param length specifying the number of characters.
+   */
+  void parse(const char* p_value, const size_t length);
+
+  /**
+   * \brief A method for appending the stored raw value string to a buffer.
+   *
+   * \param p_buffer for the buffer to append to.
+   */
+  void appendTo(std::string* p_buffer) const;
+
+  /**
+   * \brief A method for retrieving the number of top level fields in the stored value string.
+   *
+   * \return size_t containing the number of fields.
+   */
+  size_t getFieldCount() const;
+
+  /**
+   * \brief A method for retrieving the raw value string of a top level field.
+   *
+   * \param index specifying the field's index.
+   *
+   * \return std::string containing the field's value string (empty if the index is out of range).
+   */
+  std::string getFieldString(const size_t index) const;
+
+  /**
+   * \brief A method for decoding a top level field into a RAPID data struct.
+   *
+   * \param index specifying the field's index.
+   * \param p_data for storing the decoded field.
+   *
+   * \return bool indicating if the field exists or not.
+   */
+  bool getField(const size_t index, RAPIDSymbolDataAbstract* p_data) const;
+
+  /**
+   * \brief A method for decoding a nested field into a RAPID data struct.
+   *
+   * Only the records along the path are scanned, e.g. the path {1, 0, 2} refers to the third field of the first
+   * field of the second top level field.
+   *
+   * \param path containing the field indices, starting at the top level.
+   * \param p_data for storing the decoded field.
+   *
+   * \return bool indicating if the field exists or not.
+   */
+  bool getField(const std::vector<size_t>& path, RAPIDSymbolDataAbstract* p_data) const;
+
+private:
+  /**
+   * \brief The record's type name.
+   */
+  std::string record_type_name_;
+
+  /**
+   * \brief The record's raw value string.
+   */
+  std::string value_;
+
+  /**
+   * \brief Offsets and lengths of the top level fields in the raw value string.
+   */
+  std::vector<std::pair<size_t, size_t> > fields_;
+};
+
 /**
  * \brief A struct, for representing a RAPID robjoint record.
  */
@@ -0,0 +1,712 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_RAPID_BATCH_H
+#define RWS_RAPID_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "rws_rapid.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief A struct, for storing many RAPID pos records in a structure-of-arrays layout.
+ *
+ * Each component is kept in its own contiguous array, i.e. element i of all arrays belong to the same record.
+ */
+struct PosBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return x.size(); }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param pos containing the record to copy.
+   */
+  void set(const size_t index, const Pos& pos);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_pos for storing the copied record.
+   */
+  void get(const size_t index, Pos* p_pos) const;
+
+  /**
+   * \brief X-values of the positions.
+   */
+  std::vector<float> x;
+
+  /**
+   * \brief Y-values of the positions.
+   */
+  std::vector<float> y;
+
+  /**
+   * \brief Z-values of the positions.
+   */
+  std::vector<float> z;
+};
+
+/**
+ * \brief A struct, for storing many RAPID orient records in a structure-of-arrays layout.
+ */
+struct OrientBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return q1.size(); }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param orient containing the record to copy.
+   */
+  void set(const size_t index, const Orient& orient);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_orient for storing the copied record.
+   */
+  void get(const size_t index, Orient* p_orient) const;
+
+  /**
+   * \brief Quaternion 1 values.
+   */
+  std::vector<float> q1;
+
+  /**
+   * \brief Quaternion 2 values.
+   */
+  std::vector<float> q2;
+
+  /**
+   * \brief Quaternion 3 values.
+   */
+  std::vector<float> q3;
+
+  /**
+   * \brief Quaternion 4 values.
+   */
+  std::vector<float> q4;
+};
+
+/**
+ * \brief A struct, for storing many RAPID pose records in a structure-of-arrays layout.
+ */
+struct PoseBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return pos.size(); }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for appending a record to the batch.
+   *
+   * \param pose containing the record to append.
+   */
+  void push_back(const Pose& pose);
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param pose containing the record to copy.
+   */
+  void set(const size_t index, const Pose& pose);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_pose for storing the copied record.
+   */
+  void get(const size_t index, Pose* p_pose) const;
+
+  /**
+   * \brief Positions (x, y, z) [mm].
+   */
+  PosBatch pos;
+
+  /**
+   * \brief Rotation quaternions.
+   */
+  OrientBatch rot;
+};
+
+/**
+ * \brief A struct, for storing many RAPID confdata records in a structure-of-arrays layout.
+ */
+struct ConfDataBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return cf1.size(); }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param robconf containing the record to copy.
+   */
+  void set(const size_t index, const ConfData& robconf);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_robconf for storing the copied record.
+   */
+  void get(const size_t index, ConfData* p_robconf) const;
+
+  /**
+   * \brief Quadrant numbers for axis 1.
+   */
+  std::vector<float> cf1;
+
+  /**
+   * \brief Quadrant numbers for axis 4.
+   */
+  std::vector<float> cf4;
+
+  /**
+   * \brief Quadrant numbers for axis 6.
+   */
+  std::vector<float> cf6;
+
+  /**
+   * \brief Robot configuration numbers (0-7).
+   */
+  std::vector<float> cfx;
+};
+
+/**
+ * \brief A struct, for storing many RAPID robjoint records in a structure-of-arrays layout.
+ */
+struct RobJointBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return rax_1.size(); }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param robax containing the record to copy.
+   */
+  void set(const size_t index, const RobJoint& robax);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_robax for storing the copied record.
+   */
+  void get(const size_t index, RobJoint* p_robax) const;
+
+  /**
+   * \brief First robot axis values.
+   */
+  std::vector<float> rax_1;
+
+  /**
+   * \brief Second robot axis values.
+   */
+  std::vector<float> rax_2;
+
+  /**
+   * \brief Third robot axis values.
+   */
+  std::vector<float> rax_3;
+
+  /**
+   * \brief Fourth robot axis values.
+   */
+  std::vector<float> rax_4;
+
+  /**
+   * \brief Fifth robot axis values.
+   */
+  std::vector<float> rax_5;
+
+  /**
+   * \brief Sixth robot axis values.
+   */
+  std::vector<float> rax_6;
+};
+
+/**
+ * \brief A struct, for storing many RAPID extjoint records in a structure-of-arrays layout.
+ */
+struct ExtJointBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return eax_a.size(); }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param extax containing the record to copy.
+   */
+  void set(const size_t index, const ExtJoint& extax);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_extax for storing the copied record.
+   */
+  void get(const size_t index, ExtJoint* p_extax) const;
+
+  /**
+   * \brief External axis a values.
+   */
+  std::vector<float> eax_a;
+
+  /**
+   * \brief External axis b values.
+   */
+  std::vector<float> eax_b;
+
+  /**
+   * \brief External axis c values.
+   */
+  std::vector<float> eax_c;
+
+  /**
+   * \brief External axis d values.
+   */
+  std::vector<float> eax_d;
+
+  /**
+   * \brief External axis e values.
+   */
+  std::vector<float> eax_e;
+
+  /**
+   * \brief External axis f values.
+   */
+  std::vector<float> eax_f;
+};
+
+/**
+ * \brief A struct, for storing many RAPID robtarget records in a structure-of-arrays layout.
+ *
+ * Compared to a std::vector<RobTarget>, there are no per record vtables or component pointers, and
+ * each component is stored contiguously. This makes the layout suitable for vectorized batch processing.
+ */
+struct RobTargetBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return pos.size(); }
+
+  /**
+   * \brief A method for checking if the batch is empty.
+   *
+   * \return bool indicating if the batch is empty or not.
+   */
+  bool empty() const { return pos.size() == 0; }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for appending a record to the batch.
+   *
+   * \param robtarget containing the record to append.
+   */
+  void push_back(const RobTarget& robtarget);
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param robtarget containing the record to copy.
+   */
+  void set(const size_t index, const RobTarget& robtarget);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_robtarget for storing the copied record.
+   */
+  void get(const size_t index, RobTarget* p_robtarget) const;
+
+  /**
+   * \brief A method for parsing a RAPID robtarget value string into a record in the batch.
+   *
+   * The string has the same format as accepted by RobTarget::parseString(...), but it is parsed
+   * directly into the component arrays without creating any intermediate record objects.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param value_string containing the string to parse.
+   *
+   * \return bool indicating if the string contained exactly one robtarget's worth of values or not.
+   */
+  bool parseString(const size_t index, const std::string& value_string);
+
+  /**
+   * \brief A method for constructing a RAPID robtarget value string from a record in the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   *
+   * \return std::string containing the constructed string (same format as RobTarget::constructString()).
+   */
+  std::string constructString(const size_t index) const;
+
+  /**
+   * \brief A method for parsing many RAPID robtarget value strings, replacing the batch's content.
+   *
+   * \param value_strings containing the strings to parse.
+   *
+   * \return size_t containing the number of strings that failed to parse (the corresponding records are zeroed).
+   */
+  size_t parseStrings(const std::vector<std::string>& value_strings);
+
+  /**
+   * \brief A method for constructing RAPID robtarget value strings for all records in the batch.
+   *
+   * \return std::vector<std::string> containing the constructed strings.
+   */
+  std::vector<std::string> constructStrings() const;
+
+  /**
+   * \brief Positions for the tool center point [mm].
+   */
+  PosBatch pos;
+
+  /**
+   * \brief Orientation quaternions for the tool.
+   */
+  OrientBatch orient;
+
+  /**
+   * \brief Robot axis configurations.
+   */
+  ConfDataBatch robconf;
+
+  /**
+   * \brief External axes.
+   */
+  ExtJointBatch extax;
+};
+
+/**
+ * \brief A struct, for storing many RAPID jointtarget records in a structure-of-arrays layout.
+ */
+struct JointTargetBatch
+{
+public:
+  /**
+   * \brief A method for retrieving the number of stored records.
+   *
+   * \return size_t containing the number of records.
+   */
+  size_t size() const { return robax.size(); }
+
+  /**
+   * \brief A method for checking if the batch is empty.
+   *
+   * \return bool indicating if the batch is empty or not.
+   */
+  bool empty() const { return robax.size() == 0; }
+
+  /**
+   * \brief A method for resizing all component arrays.
+   *
+   * \param size specifying the new number of records.
+   */
+  void resize(const size_t size);
+
+  /**
+   * \brief A method for reserving capacity in all component arrays.
+   *
+   * \param capacity specifying the number of records to reserve space for.
+   */
+  void reserve(const size_t capacity);
+
+  /**
+   * \brief A method for removing all records.
+   */
+  void clear();
+
+  /**
+   * \brief A method for appending a record to the batch.
+   *
+   * \param jointtarget containing the record to append.
+   */
+  void push_back(const JointTarget& jointtarget);
+
+  /**
+   * \brief A method for copying a record into the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param jointtarget containing the record to copy.
+   */
+  void set(const size_t index, const JointTarget& jointtarget);
+
+  /**
+   * \brief A method for copying a record out of the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param p_jointtarget for storing the copied record.
+   */
+  void get(const size_t index, JointTarget* p_jointtarget) const;
+
+  /**
+   * \brief A method for parsing a RAPID jointtarget value string into a record in the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   * \param value_string containing the string to parse.
+   *
+   * \return bool indicating if the string contained exactly one jointtarget's worth of values or not.
+   */
+  bool parseString(const size_t index, const std::string& value_string);
+
+  /**
+   * \brief A method for constructing a RAPID jointtarget value string from a record in the batch.
+   *
+   * \param index specifying the record's position in the batch.
+   *
+   * \return std::string containing the constructed string (same format as JointTarget::constructString()).
+   */
+  std::string constructString(const size_t index) const;
+
+  /**
+   * \brief A method for parsing many RAPID jointtarget value strings, replacing the batch's content.
+   *
+   * \param value_strings containing the strings to parse.
+   *
+   * \return size_t containing the number of strings that failed to parse (the corresponding records are zeroed).
+   */
+  size_t parseStrings(const std::vector<std::string>& value_strings);
+
+  /**
+   * \brief A method for constructing RAPID jointtarget value strings for all records in the batch.
+   *
+   * \return std::vector<std::string> containing the constructed strings.
+   */
+  std::vector<std::string> constructStrings() const;
+
+  /**
+   * \brief Robot axes.
+   */
+  RobJointBatch robax;
+
+  /**
+   * \brief External axes.
+   */
+  ExtJointBatch extax;
+};
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
@@ -0,0 +1,368 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+/**
+ * The intention of this file is to provide a compact, versioned, binary encoding of RAPID data,
+ * as an alternative to the RAPID value string format (e.g. for logging or inter-process communication).
+ *
+ * Encoding of the data (all multi-byte values are little-endian):
+ * - bool:    one byte (0 or 1).
+ * - num:     four byte IEEE 754 value.
+ * - dnum:    eight byte IEEE 754 value.
+ * - string:  four byte length, followed by the characters (without quotes).
+ * - records: the components' encodings, in declaration order (i.e. no per field overhead).
+ * - other:   the RAPID value string, encoded as a string (default for custom RAPIDSymbolDataAbstract types).
+ *
+ * Layout of an encoded message (see encodeRAPIDBinary(...)):
+ * - magic:   four bytes "RWSB".
+ * - version: one byte (RAPID_BINARY_VERSION).
+ * - flags:   one byte (reserved, zero).
+ * - type:    two byte length, followed by the RAPID data type name (e.g. "robtarget").
+ * - payload: four byte length, followed by the encoded data.
+ */
+
+#ifndef RWS_RAPID_BINARY_H
+#define RWS_RAPID_BINARY_H
+
+#include <string>
+
+#include "Poco/Types.h"
+
+#include "rws_rapid.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief Current version of the binary message layout.
+ */
+const Poco::UInt8 RAPID_BINARY_VERSION = 1;
+
+/**
+ * \brief A class for reading binary encoded RAPID data directly from a buffer (i.e. without copying it).
+ */
+class RAPIDBinaryReader
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param p_data for the buffer to read from (it must outlive the reader).
+   * \param size for the buffer's size.
+   */
+  RAPIDBinaryReader(const char* p_data, const size_t size)
+  :
+  p_begin_(p_data),
+  p_current_(p_data),
+  p_end_(p_data + size)
+  {}
+
+  /**
+   * \brief A method for reading an unsigned 8-bit value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readUInt8(Poco::UInt8* p_value);
+
+  /**
+   * \brief A method for reading an unsigned 16-bit value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readUInt16(Poco::UInt16* p_value);
+
+  /**
+   * \brief A method for reading an unsigned 32-bit value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readUInt32(Poco::UInt32* p_value);
+
+  /**
+   * \brief A method for reading an unsigned 64-bit value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readUInt64(Poco::UInt64* p_value);
+
+  /**
+   * \brief A method for reading a four byte floating point value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readFloat(float* p_value);
+
+  /**
+   * \brief A method for reading an eight byte floating point value.
+   *
+   * \param p_value for storing the value.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readDouble(double* p_value);
+
+  /**
+   * \brief A method for reading a length prefixed string, without copying it.
+   *
+   * \param pp_characters for storing a pointer to the string's characters (inside the reader's buffer).
+   * \param p_length for storing the string's length.
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readString(const char** pp_characters, Poco::UInt32* p_length);
+
+  /**
+   * \brief A method for reading a number of raw bytes, without copying them.
+   *
+   * \param size specifying the number of bytes.
+   * \param pp_bytes for storing a pointer to the bytes (inside the reader's buffer).
+   *
+   * \return bool indicating if the read was successful or not (i.e. enough data).
+   */
+  bool readBytes(const size_t size, const char** pp_bytes);
+
+  /**
+   * \brief A method for retrieving the number of bytes that have been read.
+   *
+   * \return size_t containing the number of bytes.
+   */
+  size_t position() const { return p_current_ - p_begin_; }
+
+  /**
+   * \brief A method for retrieving the number of bytes that are left to read.
+   *
+   * \return size_t containing the number of bytes.
+   */
+  size_t remaining() const { return p_end_ - p_current_; }
+
+private:
+  /**
+   * \brief Start of the buffer.
+   */
+  const char* p_begin_;
+
+  /**
+   * \brief Current read position.
+   */
+  const char* p_current_;
+
+  /**
+   * \brief End of the buffer.
+   */
+  const char* p_end_;
+};
+
+/**
+ * \brief A struct for containing a decoded message header. The pointers refer into the decoded buffer.
+ */
+struct RAPIDBinaryHeader
+{
+  /**
+   * \brief A default constructor.
+   */
+  RAPIDBinaryHeader()
+  :
+  version(0),
+  p_type_name(0),
+  type_name_length(0),
+  p_payload(0),
+  payload_size(0)
+  {}
+
+  /**
+   * \brief A method for checking if the message contains a specific RAPID data type.
+   *
+   * \param type_name specifying the data type name to compare with.
+   *
+   * \return bool indicating if the type names are equal or not.
+   */
+  bool isType(const std::string& type_name) const
+  {
+    return type_name.compare(0, std::string::npos, p_type_name, type_name_length) == 0;
+  }
+
+  /**
+   * \brief The message's layout version.
+   */
+  Poco::UInt8 version;
+
+  /**
+   * \brief The RAPID data type name (not null terminated).
+   */
+  const char* p_type_name;
+
+  /**
+   * \brief Length of the RAPID data type name.
+   */
+  Poco::UInt16 type_name_length;
+
+  /**
+   * \brief The encoded data.
+   */
+  const char* p_payload;
+
+  /**
+   * \brief Size of the encoded data.
+   */
+  Poco::UInt32 payload_size;
+};
+
+/**
+ * \brief A function for appending an unsigned 8-bit value to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value for the value to append.
+ */
+void binaryAppendUInt8(std::string* p_buffer, const Poco::UInt8 value);
+
+/**
+ * \brief A function for appending an unsigned 16-bit value (little-endian) to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value for the value to append.
+ */
+void binaryAppendUInt16(std::string* p_buffer, const Poco::UInt16 value);
+
+/**
+ * \brief A function for appending an unsigned 32-bit value (little-endian) to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value for the value to append.
+ */
+void binaryAppendUInt32(std::string* p_buffer, const Poco::UInt32 value);
+
+/**
+ * \brief A function for appending an unsigned 64-bit value (little-endian) to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value for the value to append.
+ */
+void binaryAppendUInt64(std::string* p_buffer, const Poco::UInt64 value);
+
+/**
+ * \brief A function for appending a four byte floating point value (little-endian) to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value for the value to append.
+ */
+void binaryAppendFloat(std::string* p_buffer, const float value);
+
+/**
+ * \brief A function for appending an eight byte floating point value (little-endian) to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value for the value to append.
+ */
+void binaryAppendDouble(std::string* p_buffer, const double value);
+
+/**
+ * \brief A function for appending a length prefixed string to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param p_characters for the string's characters.
+ * \param length for the string's length.
+ */
+void binaryAppendString(std::string* p_buffer, const char* p_characters, const Poco::UInt32 length);
+
+/**
+ * \brief A function for encoding RAPID data into a binary message, appended to a buffer.
+ *
+ * Reusing the same buffer (after clearing it) avoids repeated allocations when encoding many messages.
+ *
+ * \param data for the RAPID data to encode.
+ * \param p_buffer for the buffer to append the message to.
+ */
+void encodeRAPIDBinary(const RAPIDSymbolDataAbstract& data, std::string* p_buffer);
+
+/**
+ * \brief A function for encoding RAPID data into a binary message.
+ *
+ * \param data for the RAPID data to encode.
+ *
+ * \return std::string containing the message.
+ */
+std::string encodeRAPIDBinary(const RAPIDSymbolDataAbstract& data);
+
+/**
+ * \brief A function for decoding the header of a binary message, without copying any data.
+ *
+ * \param p_message for the message.
+ * \param size for the size of the buffer containing the message.
+ * \param p_header for storing the decoded header.
+ *
+ * \return size_t containing the total size of the message, or 0 if the buffer did not contain a valid message.
+ */
+size_t decodeRAPIDBinaryHeader(const char* p_message, const size_t size, RAPIDBinaryHeader* p_header);
+
+/**
+ * \brief A function for decoding a binary message into RAPID data.
+ *
+ * The data is decoded directly from the message buffer. The message's RAPID data type must match the data's type. If
+ * the decoding fails, then the data is left unchanged.
+ *
+ * \param p_message for the message.
+ * \param size for the size of the buffer containing the message.
+ * \param p_data for storing the decoded data.
+ *
+ * \return size_t containing the total size of the decoded message, or 0 if the decoding failed.
+ */
+size_t decodeRAPIDBinary(const char* p_message, const size_t size, RAPIDSymbolDataAbstract* p_data);
+
+/**
+ * \brief A function for decoding a binary message into RAPID data. The string must contain exactly one message.
+ *
+ * \param message containing the message.
+ * \param p_data for storing the decoded data.
+ *
+ * \return bool indicating if the decoding was successful or not.
+ */
+bool decodeRAPIDBinary(const std::string& message, RAPIDSymbolDataAbstract* p_data);
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
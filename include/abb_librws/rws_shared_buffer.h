@@ -0,0 +1,408 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_SHARED_BUFFER_H
+#define RWS_SHARED_BUFFER_H
+
+#include <ostream>
+#include <string>
+
+#include "Poco/SharedPtr.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief A release policy for Poco::SharedPtr, which returns released strings to a pool (for reuse of their memory).
+ */
+class BufferPoolReleasePolicy
+{
+public:
+  /**
+   * \brief A method for releasing a string, i.e. returning it to the pool (or deleting it, if the pool is full).
+   *
+   * \param p_string for the string to release.
+   */
+  static void release(std::string* p_string);
+};
+
+/**
+ * \brief A class for an immutable, reference counted byte buffer (e.g. a HTTP response body).
+ *
+ * Copying a buffer only increments a reference count, so the same bytes can be passed from the socket, through the
+ * communication results and the log, to the XML parser without being copied. The memory is taken from, and returned
+ * to, a small pool of strings.
+ *
+ * A buffer converts implicitly to a const std::string&, and offers the const part of std::string's interface (e.g.
+ * c_str(), find() and substr()), for compatibility with code that expects a string.
+ */
+class SharedBuffer
+{
+public:
+  /**
+   * \brief Type for sizes and positions.
+   */
+  typedef std::string::size_type size_type;
+
+  /**
+   * \brief Type for iterators (the contents can not be modified).
+   */
+  typedef std::string::const_iterator const_iterator;
+
+  /**
+   * \brief Type for reverse iterators (the contents can not be modified).
+   */
+  typedef std::string::const_reverse_iterator const_reverse_iterator;
+
+  /**
+   * \brief Static constant for "not found" (or "until the end"), as for std::string.
+   */
+  static const size_type npos = std::string::npos;
+
+  /**
+   * \brief A default constructor, for an empty buffer.
+   */
+  SharedBuffer() {}
+
+  /**
+   * \brief A constructor, which copies a string into a new buffer.
+   *
+   * \param value for the string to copy.
+   */
+  SharedBuffer(const std::string& value);
+
+  /**
+   * \brief A constructor, which copies a null terminated string into a new buffer.
+   *
+   * \param p_value for the string to copy.
+   */
+  SharedBuffer(const char* p_value);
+
+  /**
+   * \brief A method for replacing the buffer with a new (empty) pooled buffer, to be filled by the caller.
+   *
+   * \note The returned string must only be modified before the buffer is copied (i.e. shared).
+   *
+   * \param capacity specifying the capacity to reserve.
+   *
+   * \return std::string* for the new buffer's string.
+   */
+  std::string* reset(const size_t capacity = 0);
+
+  /**
+   * \brief A method for retrieving the buffer's contents.
+   *
+   * \return const std::string& for the contents.
+   */
+  const std::string& str() const;
+
+  /**
+   * \brief Operator for converting the buffer to a string.
+   *
+   * \return const std::string& for the contents.
+   */
+  operator const std::string&() const { return str(); }
+
+  /**
+   * \brief A method for retrieving a pointer to the buffer's bytes.
+   *
+   * \return const char* for the bytes.
+   */
+  const char* data() const { return str().data(); }
+
+  /**
+   * \brief A method for retrieving the buffer's size.
+   *
+   * \return size_t containing the number of bytes.
+   */
+  size_t size() const { return str().size(); }
+
+  /**
+   * \brief A method for checking if the buffer is empty.
+   *
+   * \return bool indicating if the buffer is empty or not.
+   */
+  bool empty() const { return str().empty(); }
+
+  /**
+   * \brief A method for retrieving the buffer's contents as a null terminated string.
+   *
+   * \return const char* for the contents.
+   */
+  const char* c_str() const { return str().c_str(); }
+
+  /**
+   * \brief A method for retrieving the buffer's size.
+   *
+   * \return size_type containing the number of bytes.
+   */
+  size_type length() const { return str().length(); }
+
+  /**
+   * \brief A method for retrieving an iterator to the first byte.
+   *
+   * \return const_iterator for the first byte.
+   */
+  const_iterator begin() const { return str().begin(); }
+
+  /**
+   * \brief A method for retrieving an iterator past the last byte.
+   *
+   * \return const_iterator past the last byte.
+   */
+  const_iterator end() const { return str().end(); }
+
+  /**
+   * \brief A method for retrieving a reverse iterator to the last byte.
+   *
+   * \return const_reverse_iterator for the last byte.
+   */
+  const_reverse_iterator rbegin() const { return str().rbegin(); }
+
+  /**
+   * \brief A method for retrieving a reverse iterator before the first byte.
+   *
+   * \return const_reverse_iterator before the first byte.
+   */
+  const_reverse_iterator rend() const { return str().rend(); }
+
+  /**
+   * \brief Operator for accessing a byte (unchecked).
+   *
+   * \param pos for the byte's position.
+   *
+   * \return const char& for the byte.
+   */
+  const char& operator[](const size_type pos) const { return str()[pos]; }
+
+  /**
+   * \brief A method for accessing a byte.
+   *
+   * \param pos for the byte's position.
+   *
+   * \return const char& for the byte.
+   *
+   * \throw std::out_of_range if the position is outside the buffer.
+   */
+  const char& at(const size_type pos) const { return str().at(pos); }
+
+  /**
+   * \brief A method for finding the first occurrence of a string.
+   *
+   * \param value for the string to find.
+   * \param pos for the position to start searching at.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find(const std::string& value, const size_type pos = 0) const { return str().find(value, pos); }
+
+  /**
+   * \brief A method for finding the first occurrence of a null terminated string.
+   *
+   * \param p_value for the string to find.
+   * \param pos for the position to start searching at.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find(const char* p_value, const size_type pos = 0) const { return str().find(p_value, pos); }
+
+  /**
+   * \brief A method for finding the first occurrence of a character.
+   *
+   * \param value for the character to find.
+   * \param pos for the position to start searching at.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find(const char value, const size_type pos = 0) const { return str().find(value, pos); }
+
+  /**
+   * \brief A method for finding the last occurrence of a string.
+   *
+   * \param value for the string to find.
+   * \param pos for the position to start searching backwards from.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type rfind(const std::string& value, const size_type pos = npos) const { return str().rfind(value, pos); }
+
+  /**
+   * \brief A method for finding the last occurrence of a character.
+   *
+   * \param value for the character to find.
+   * \param pos for the position to start searching backwards from.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type rfind(const char value, const size_type pos = npos) const { return str().rfind(value, pos); }
+
+  /**
+   * \brief A method for finding the first character that is in a set.
+   *
+   * \param set for the set of characters.
+   * \param pos for the position to start searching at.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find_first_of(const std::string& set, const size_type pos = 0) const
+  {
+    return str().find_first_of(set, pos);
+  }
+
+  /**
+   * \brief A method for finding the last character that is in a set.
+   *
+   * \param set for the set of characters.
+   * \param pos for the position to start searching backwards from.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find_last_of(const std::string& set, const size_type pos = npos) const
+  {
+    return str().find_last_of(set, pos);
+  }
+
+  /**
+   * \brief A method for finding the first character that is not in a set.
+   *
+   * \param set for the set of characters.
+   * \param pos for the position to start searching at.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find_first_not_of(const std::string& set, const size_type pos = 0) const
+  {
+    return str().find_first_not_of(set, pos);
+  }
+
+  /**
+   * \brief A method for finding the last character that is not in a set.
+   *
+   * \param set for the set of characters.
+   * \param pos for the position to start searching backwards from.
+   *
+   * \return size_type containing the position, or npos if not found.
+   */
+  size_type find_last_not_of(const std::string& set, const size_type pos = npos) const
+  {
+    return str().find_last_not_of(set, pos);
+  }
+
+  /**
+   * \brief A method for copying a part of the buffer into a new string.
+   *
+   * \param pos for the part's position.
+   * \param count for the part's maximum length.
+   *
+   * \return std::string containing the part.
+   *
+   * \throw std::out_of_range if the position is outside the buffer.
+   */
+  std::string substr(const size_type pos = 0, const size_type count = npos) const { return str().substr(pos, count); }
+
+  /**
+   * \brief A method for comparing the buffer with a string.
+   *
+   * \param value for the string to compare with.
+   *
+   * \return int which is negative, zero or positive, as for std::string::compare.
+   */
+  int compare(const std::string& value) const { return str().compare(value); }
+
+  /**
+   * \brief A method for comparing the buffer with a null terminated string.
+   *
+   * \param p_value for the string to compare with.
+   *
+   * \return int which is negative, zero or positive, as for std::string::compare.
+   */
+  int compare(const char* p_value) const { return str().compare(p_value); }
+
+private:
+  /**
+   * \brief Static constant for an empty string, used by empty buffers.
+   */
+  static const std::string EMPTY;
+
+  /**
+   * \brief The shared string.
+   */
+  Poco::SharedPtr<std::string, Poco::ReferenceCounter, BufferPoolReleasePolicy> p_string_;
+};
+
+/**
+ * \brief Operator for writing a buffer to an output stream.
+ *
+ * \param stream for the output stream.
+ * \param buffer for the buffer to write.
+ *
+ * \return std::ostream& for the output stream.
+ */
+inline std::ostream& operator<<(std::ostream& stream, const SharedBuffer& buffer)
+{
+  return stream.write(buffer.data(), buffer.size());
+}
+
+/**
+ * \brief Comparison operators between buffers, strings and null terminated strings (which compare the contents).
+ */
+inline bool operator==(const SharedBuffer& lhs, const SharedBuffer& rhs) { return lhs.str() == rhs.str(); }
+inline bool operator==(const SharedBuffer& lhs, const std::string& rhs) { return lhs.str() == rhs; }
+inline bool operator==(const std::string& lhs, const SharedBuffer& rhs) { return lhs == rhs.str(); }
+inline bool operator==(const SharedBuffer& lhs, const char* rhs) { return lhs.str() == rhs; }
+inline bool operator==(const char* lhs, const SharedBuffer& rhs) { return lhs == rhs.str(); }
+inline bool operator!=(const SharedBuffer& lhs, const SharedBuffer& rhs) { return lhs.str() != rhs.str(); }
+inline bool operator!=(const SharedBuffer& lhs, const std::string& rhs) { return lhs.str() != rhs; }
+inline bool operator!=(const std::string& lhs, const SharedBuffer& rhs) { return lhs != rhs.str(); }
+inline bool operator!=(const SharedBuffer& lhs, const char* rhs) { return lhs.str() != rhs; }
+inline bool operator!=(const char* lhs, const SharedBuffer& rhs) { return lhs != rhs.str(); }
+inline bool operator<(const SharedBuffer& lhs, const SharedBuffer& rhs) { return lhs.str() < rhs.str(); }
+inline bool operator<(const SharedBuffer& lhs, const std::string& rhs) { return lhs.str() < rhs; }
+inline bool operator<(const std::string& lhs, const SharedBuffer& rhs) { return lhs < rhs.str(); }
+
+/**
+ * \brief Concatenation operators between buffers, strings and null terminated strings (which create new strings).
+ */
+inline std::string operator+(const SharedBuffer& lhs, const std::string& rhs) { return lhs.str() + rhs; }
+inline std::string operator+(const std::string& lhs, const SharedBuffer& rhs) { return lhs + rhs.str(); }
+inline std::string operator+(const SharedBuffer& lhs, const char* rhs) { return lhs.str() + rhs; }
+inline std::string operator+(const char* lhs, const SharedBuffer& rhs) { return lhs + rhs.str(); }
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
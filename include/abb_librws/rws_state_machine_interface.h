@@ -772,6 +772,32 @@ public:
   services_(this)
   {}
 
+  /**
+   * \brief A constructor, for a robot controller (or proxy) that may require HTTPS.
+   *
+   * \param ip_address specifying the robot controller's IP address.
+   * \param port for the port used by the RWS server.
+   * \param username for the username to the RWS authentication process.
+   * \param password for the password to the RWS authentication process.
+   * \param tls for the TLS options (i.e. if HTTPS should be used).
+   * \param share_client indicating if the RWS client should be shared (see RWSInterface).
+   */
+  RWSStateMachineInterface(const std::string& ip_address,
+                           const unsigned short port,
+                           const std::string& username,
+                           const std::string& password,
+                           const POCOClient::TLSOptions& tls,
+                           const bool share_client = false)
+  :
+  RWSInterface(ip_address,
+               port,
+               username,
+               password,
+               tls,
+               share_client),
+  services_(this)
+  {}
+
   /**
    * \brief Services provided by the StateMachine AddIn.
    *
@@ -0,0 +1,484 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#ifndef RWS_STATE_PUBLISHER_H
+#define RWS_STATE_PUBLISHER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Poco/Event.h"
+#include "Poco/Mutex.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/SharedMemory.h"
+#include "Poco/Thread.h"
+#include "Poco/Types.h"
+
+#include "rws_interface.h"
+
+namespace abb
+{
+namespace rws
+{
+/**
+ * \brief A struct for the published controller state, with a fixed binary layout (see SharedStateHeader::VERSION).
+ *
+ * All members are plain data, with natural alignment, so the layout is the same for all local processes built for
+ * the same architecture. Strings are null terminated (and truncated if needed). Tri-state flags use the values of
+ * TriBool::Values (i.e. 0 = unknown, 1 = true and 2 = false).
+ */
+struct SharedStateData
+{
+  /**
+   * \brief Maximum number of published mechanical units.
+   */
+  static const size_t MAX_MECHANICAL_UNITS = 4;
+
+  /**
+   * \brief Maximum number of published IO signals.
+   */
+  static const size_t MAX_IO_SIGNALS = 64;
+
+  /**
+   * \brief Maximum number of published RAPID symbols.
+   */
+  static const size_t MAX_RAPID_SYMBOLS = 32;
+
+  /**
+   * \brief Size of the name fields (including the null terminator).
+   */
+  static const size_t NAME_SIZE = 64;
+
+  /**
+   * \brief Size of the value fields (including the null terminator).
+   */
+  static const size_t VALUE_SIZE = 256;
+
+  /**
+   * \brief A struct for the state of a mechanical unit.
+   */
+  struct MechanicalUnit
+  {
+    /**
+     * \brief The mechanical unit's name.
+     */
+    char name[NAME_SIZE];
+
+    /**
+     * \brief Flag indicating if the jointtarget members are valid (i.e. were retrieved in the latest update).
+     */
+    Poco::UInt32 jointtarget_valid;
+
+    /**
+     * \brief Flag indicating if the robtarget members are valid (i.e. were retrieved in the latest update).
+     */
+    Poco::UInt32 robtarget_valid;
+
+    /**
+     * \brief The jointtarget's robot axes (rax_1 - rax_6) [deg or mm].
+     */
+    float robax[6];
+
+    /**
+     * \brief The jointtarget's external axes (eax_a - eax_f) [deg or mm].
+     */
+    float jointtarget_extax[6];
+
+    /**
+     * \brief The robtarget's position (x, y, z) [mm].
+     */
+    float pos[3];
+
+    /**
+     * \brief The robtarget's orientation quaternion (q1 - q4).
+     */
+    float orient[4];
+
+    /**
+     * \brief The robtarget's axis configuration (cf1, cf4, cf6, cfx).
+     */
+    float robconf[4];
+
+    /**
+     * \brief The robtarget's external axes (eax_a - eax_f) [deg or mm].
+     */
+    float robtarget_extax[6];
+  };
+
+  /**
+   * \brief A struct for a named value (an IO signal, or a RAPID symbol in raw text format).
+   */
+  struct Value
+  {
+    /**
+     * \brief The name (the signal's name, or "task/module/name" for RAPID symbols).
+     */
+    char name[NAME_SIZE];
+
+    /**
+     * \brief The value.
+     */
+    char value[VALUE_SIZE];
+
+    /**
+     * \brief Flag indicating if the value is valid (i.e. was retrieved in the latest update).
+     */
+    Poco::UInt32 valid;
+  };
+
+  /**
+   * \brief A method for finding a mechanical unit's state.
+   *
+   * \param name for the mechanical unit's name.
+   *
+   * \return const MechanicalUnit* to the state, or 0 if the mechanical unit is not published.
+   */
+  const MechanicalUnit* findMechanicalUnit(const std::string& name) const;
+
+  /**
+   * \brief A method for finding an IO signal's value.
+   *
+   * \param name for the signal's name.
+   *
+   * \return const Value* to the value, or 0 if the signal is not published.
+   */
+  const Value* findIOSignal(const std::string& name) const;
+
+  /**
+   * \brief A method for finding a RAPID symbol's value.
+   *
+   * \param name for the symbol's name, as "task/module/name".
+   *
+   * \return const Value* to the value, or 0 if the symbol is not published.
+   */
+  const Value* findRAPIDSymbol(const std::string& name) const;
+
+  /**
+   * \brief Time of the update [microseconds since the Unix epoch].
+   */
+  Poco::Int64 timestamp;
+
+  /**
+   * \brief Tri-state flag for if the controller is in auto mode.
+   */
+  Poco::UInt32 auto_mode;
+
+  /**
+   * \brief Tri-state flag for if the motors are on.
+   */
+  Poco::UInt32 motors_on;
+
+  /**
+   * \brief Tri-state flag for if RAPID is running.
+   */
+  Poco::UInt32 rapid_running;
+
+  /**
+   * \brief Flag indicating if RWS was connected during the update.
+   */
+  Poco::UInt32 rws_connected;
+
+  /**
+   * \brief The number of published mechanical units.
+   */
+  Poco::UInt32 mechanical_units_count;
+
+  /**
+   * \brief The number of published IO signals.
+   */
+  Poco::UInt32 io_signals_count;
+
+  /**
+   * \brief The number of published RAPID symbols.
+   */
+  Poco::UInt32 rapid_symbols_count;
+
+  /**
+   * \brief Padding, to keep the layout's alignment explicit.
+   */
+  Poco::UInt32 reserved;
+
+  /**
+   * \brief The mechanical units' states.
+   */
+  MechanicalUnit mechanical_units[MAX_MECHANICAL_UNITS];
+
+  /**
+   * \brief The IO signals' values.
+   */
+  Value io_signals[MAX_IO_SIGNALS];
+
+  /**
+   * \brief The RAPID symbols' values.
+   */
+  Value rapid_symbols[MAX_RAPID_SYMBOLS];
+};
+
+/**
+ * \brief A struct for the header of the shared-memory segment, which is followed by the SharedStateData.
+ *
+ * The sequence number is a seqlock: it is odd while the publisher writes the data, and is incremented again when the
+ * data is complete. Readers copy the data, and retry if the sequence number was odd or changed during the copy.
+ */
+struct SharedStateHeader
+{
+  /**
+   * \brief The identifier of the segment's layout ("RWSS").
+   */
+  static const Poco::UInt32 MAGIC = 0x52575353;
+
+  /**
+   * \brief The version of the segment's layout.
+   */
+  static const Poco::UInt32 VERSION = 1;
+
+  /**
+   * \brief The layout's identifier (written last when the segment is initialized).
+   */
+  std::atomic<Poco::UInt32> magic;
+
+  /**
+   * \brief The layout's version.
+   */
+  Poco::UInt32 version;
+
+  /**
+   * \brief The size of the data that follows the header [bytes].
+   */
+  Poco::UInt32 data_size;
+
+  /**
+   * \brief The sequence number (the seqlock).
+   */
+  std::atomic<Poco::UInt32> sequence;
+};
+
+/**
+ * \brief A class for periodically publishing a robot controller's runtime state to a shared-memory segment.
+ *
+ * Only the publishing process communicates with the robot controller. Local processes read the latest state with
+ * RWSStateReader, without any socket traffic. Each update is collected first, and then copied into the segment, so
+ * readers are never blocked by the communication.
+ */
+class RWSStatePublisher
+{
+public:
+  /**
+   * \brief A struct for specifying what to publish.
+   */
+  struct Configuration
+  {
+    /**
+     * \brief The mechanical units to publish the jointtargets and robtargets of.
+     */
+    std::vector<std::string> mechanical_units;
+
+    /**
+     * \brief The IO signals to publish.
+     */
+    std::vector<std::string> io_signals;
+
+    /**
+     * \brief The RAPID symbols to publish (in raw text format).
+     */
+    std::vector<RWSClient::RAPIDResource> rapid_symbols;
+  };
+
+  /**
+   * \brief A constructor, which creates the shared-memory segment.
+   *
+   * \param interface for the interface to the robot controller.
+   * \param segment_name for the segment's name (e.g. "rws_state").
+   * \param configuration for what to publish.
+   *
+   * \throw std::invalid_argument if the configuration exceeds the layout's capacity.
+   * \throw Poco::SystemException if the segment can not be created.
+   */
+  RWSStatePublisher(RWSInterface& interface, const std::string& segment_name, const Configuration& configuration);
+
+  /**
+   * \brief A destructor, which stops any periodic publishing (the segment is removed).
+   */
+  ~RWSStatePublisher();
+
+  /**
+   * \brief A method for collecting and publishing one update.
+   */
+  void publish();
+
+  /**
+   * \brief A method for starting periodic publishing in a background thread.
+   *
+   * \param interval for the interval between the updates' starts [microseconds].
+   */
+  void start(const Poco::Int64 interval);
+
+  /**
+   * \brief A method for stopping periodic publishing.
+   */
+  void stop();
+
+private:
+  /**
+   * \brief The periodic publishing loop.
+   */
+  void run();
+
+  /**
+   * \brief A method for collecting an update from the robot controller.
+   *
+   * \param p_data for storing the update.
+   */
+  void collect(SharedStateData* p_data);
+
+  /**
+   * \brief The interface to the robot controller.
+   */
+  RWSInterface& interface_;
+
+  /**
+   * \brief What to publish.
+   */
+  Configuration configuration_;
+
+  /**
+   * \brief The shared-memory segment.
+   */
+  Poco::SharedMemory segment_;
+
+  /**
+   * \brief The segment's header.
+   */
+  SharedStateHeader* p_header_;
+
+  /**
+   * \brief The segment's data.
+   */
+  SharedStateData* p_data_;
+
+  /**
+   * \brief A mutex for serializing publishers (the seqlock allows only one writer).
+   */
+  Poco::Mutex publish_mutex_;
+
+  /**
+   * \brief The interval between periodic updates [microseconds].
+   */
+  Poco::Int64 interval_;
+
+  /**
+   * \brief Flag indicating if periodic publishing is running.
+   */
+  bool running_;
+
+  /**
+   * \brief An event for stopping periodic publishing.
+   */
+  Poco::Event stop_event_;
+
+  /**
+   * \brief Adapter for running the publishing loop in a thread.
+   */
+  Poco::RunnableAdapter<RWSStatePublisher> runnable_;
+
+  /**
+   * \brief The periodic publishing thread.
+   */
+  Poco::Thread thread_;
+};
+
+/**
+ * \brief A class for reading the controller state published by a RWSStatePublisher (in another process).
+ */
+class RWSStateReader
+{
+public:
+  /**
+   * \brief A constructor, which opens the shared-memory segment.
+   *
+   * \param segment_name for the segment's name.
+   *
+   * \throw Poco::SystemException if the segment does not exist.
+   */
+  RWSStateReader(const std::string& segment_name);
+
+  /**
+   * \brief A method for checking if the segment has been initialized, with a compatible layout.
+   *
+   * \return bool indicating if the segment can be read or not.
+   */
+  bool isCompatible() const;
+
+  /**
+   * \brief A method for reading a consistent copy of the latest state.
+   *
+   * \param p_data for storing the state.
+   * \param max_attempts for the maximum number of attempts (an attempt fails if an update was written concurrently).
+   *
+   * \return bool indicating if the read was successful (false if incompatible, not yet published, or if all
+   *         attempts failed).
+   */
+  bool read(SharedStateData* p_data, const unsigned int max_attempts = 1000) const;
+
+  /**
+   * \brief A method for retrieving the current sequence number, e.g. for cheaply checking for new updates.
+   *
+   * \return Poco::UInt32 containing the sequence number (it increases by 2 per update).
+   */
+  Poco::UInt32 sequence() const;
+
+private:
+  /**
+   * \brief The shared-memory segment.
+   */
+  Poco::SharedMemory segment_;
+
+  /**
+   * \brief The segment's header.
+   */
+  const SharedStateHeader* p_header_;
+
+  /**
+   * \brief The segment's data.
+   */
+  const SharedStateData* p_data_;
+};
+
+} // end namespace rws
+} // end namespace abb
+
+#endif
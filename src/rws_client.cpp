@@ -37,8 +37,6 @@
 #include <sstream>
 #include <stdexcept>
 
-#include "Poco/SAX/InputSource.h"
-
 #include "abb_librws/rws_client.h"
 
 namespace
@@ -117,7 +115,7 @@ RWSClient::RWSResult RWSClient::getContollerService()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_CONTROLLER), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getConfigurationInstances(const std::string& topic, const std::string& type)
@@ -128,7 +126,7 @@ RWSClient::RWSResult RWSClient::getConfigurationInstances(const std::string& top
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_CONFIGURATION), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getIOSignals()
@@ -139,7 +137,7 @@ RWSClient::RWSResult RWSClient::getIOSignals()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getIOSignal(const std::string& iosignal)
@@ -150,7 +148,7 @@ RWSClient::RWSResult RWSClient::getIOSignal(const std::string& iosignal)
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getMechanicalUnitStaticInfo(const std::string& mechunit)
@@ -161,7 +159,7 @@ RWSClient::RWSResult RWSClient::getMechanicalUnitStaticInfo(const std::string& m
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_MECHANICAL_UNITS), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getMechanicalUnitDynamicInfo(const std::string& mechunit)
@@ -172,7 +170,7 @@ RWSClient::RWSResult RWSClient::getMechanicalUnitDynamicInfo(const std::string&
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getMechanicalUnitJointTarget(const std::string& mechunit)
@@ -183,7 +181,7 @@ RWSClient::RWSResult RWSClient::getMechanicalUnitJointTarget(const std::string&
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getMechanicalUnitRobTarget(const std::string& mechunit,
@@ -228,7 +226,7 @@ RWSClient::RWSResult RWSClient::getMechanicalUnitRobTarget(const std::string& me
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getRAPIDExecution()
@@ -239,7 +237,7 @@ RWSClient::RWSResult RWSClient::getRAPIDExecution()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getRAPIDModulesInfo(const std::string& task)
@@ -250,7 +248,7 @@ RWSClient::RWSResult RWSClient::getRAPIDModulesInfo(const std::string& task)
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_RAPID_PROGRAM), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getRAPIDTasks()
@@ -261,7 +259,8 @@ RWSClient::RWSResult RWSClient::getRAPIDTasks()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  // The tasks include their execution states, which change outside the client, so they are never cached.
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getRobotWareSystem()
@@ -272,7 +271,7 @@ RWSClient::RWSResult RWSClient::getRobotWareSystem()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_CONTROLLER), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getSpeedRatio()
@@ -283,7 +282,7 @@ RWSClient::RWSResult RWSClient::getSpeedRatio()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_PANEL), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getPanelControllerState()
@@ -294,7 +293,8 @@ RWSClient::RWSResult RWSClient::getPanelControllerState()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  // Never cached, since the state changes outside the client (e.g. guard stops).
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getPanelOperationMode()
@@ -305,7 +305,8 @@ RWSClient::RWSResult RWSClient::getPanelOperationMode()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  // Never cached, since the mode changes outside the client (e.g. with the key switch).
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getRAPIDSymbolData(const RAPIDResource& resource)
@@ -316,7 +317,7 @@ RWSClient::RWSResult RWSClient::getRAPIDSymbolData(const RAPIDResource& resource
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::getRAPIDSymbolData(const RAPIDResource& resource, RAPIDSymbolDataAbstract* p_data)
@@ -332,7 +333,7 @@ RWSClient::RWSResult RWSClient::getRAPIDSymbolData(const RAPIDResource& resource
     {
       data_type = xmlFindTextContent(temp_result.p_xml_document, XMLAttributes::CLASS_DATTYP);
 
-      if (p_data->getType().compare(data_type) == 0)
+      if (p_data->isType(data_type.data(), data_type.size()))
       {
         result = getRAPIDSymbolData(resource);
 
@@ -342,7 +343,7 @@ RWSClient::RWSResult RWSClient::getRAPIDSymbolData(const RAPIDResource& resource
 
           if (!value.empty())
           {
-            p_data->parseString(value);
+            p_data->parse(value.data(), value.size());
           }
           else
           {
@@ -357,6 +358,28 @@ RWSClient::RWSResult RWSClient::getRAPIDSymbolData(const RAPIDResource& resource
   return result;
 }
 
+std::vector<RWSClient::RWSResult> RWSClient::getRAPIDSymbolsData(const std::vector<RAPIDResource>& resources)
+{
+  std::vector<std::string> uris;
+  for (size_t i = 0; i < resources.size(); ++i)
+  {
+    uris.push_back(generateRAPIDDataPath(resources[i]));
+  }
+
+  EvaluationConditions evaluation_conditions;
+  evaluation_conditions.parse_message_into_xml = true;
+  evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
+
+  std::vector<POCOResult> poco_results = httpGetPipelined(uris);
+  std::vector<RWSResult> results;
+  for (size_t i = 0; i < poco_results.size(); ++i)
+  {
+    results.push_back(evaluatePOCOResult(poco_results[i], evaluation_conditions));
+  }
+
+  return results;
+}
+
 RWSClient::RWSResult RWSClient::getRAPIDSymbolProperties(const RAPIDResource& resource)
 {
   std::string uri = generateRAPIDPropertiesPath(resource);
@@ -365,7 +388,7 @@ RWSClient::RWSResult RWSClient::getRAPIDSymbolProperties(const RAPIDResource& re
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
-  return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
+  return evaluatePOCOResult(cachedGet(uri, CACHE_RAPID_PROGRAM), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::setIOSignal(const std::string& iosignal, const std::string& value)
@@ -476,6 +499,9 @@ RWSClient::RWSResult RWSClient::setSpeedRatio(unsigned int ratio)
 
 RWSClient::RWSResult RWSClient::getFile(const FileResource& resource, std::string* p_file_content)
 {
+  // File transfers are made on the bulk lane, so they never delay control requests.
+  PriorityScope priority(*this, BULK);
+
   RWSResult rws_result;
   POCOClient::POCOResult poco_result;
 
@@ -499,17 +525,48 @@ RWSClient::RWSResult RWSClient::getFile(const FileResource& resource, std::strin
   return rws_result;
 }
 
+RWSClient::RWSResult RWSClient::getFile(const FileResource& resource, ContentSink& sink)
+{
+  // File transfers are made on the bulk lane, so they never delay control requests.
+  PriorityScope priority(*this, BULK);
+
+  std::string uri = generateFilePath(resource);
+
+  EvaluationConditions evaluation_conditions;
+  evaluation_conditions.parse_message_into_xml = false;
+  evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
+
+  return evaluatePOCOResult(httpGet(uri, sink), evaluation_conditions);
+}
+
 RWSClient::RWSResult RWSClient::uploadFile(const FileResource& resource, const std::string& file_content)
 {
+  // File transfers are made on the bulk lane, so they never delay control requests.
+  PriorityScope priority(*this, BULK);
+
+  std::string uri = generateFilePath(resource);
+
+  EvaluationConditions evaluation_conditions;
+  evaluation_conditions.parse_message_into_xml = false;
+  evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
+  evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_CREATED);
+
+  return evaluatePOCOResult(httpPut(uri, file_content), evaluation_conditions);
+}
+
+RWSClient::RWSResult RWSClient::uploadFile(const FileResource& resource, ContentSource& source)
+{
+  // File transfers are made on the bulk lane, so they never delay control requests.
+  PriorityScope priority(*this, BULK);
+
   std::string uri = generateFilePath(resource);
-  std::string content = file_content;
 
   EvaluationConditions evaluation_conditions;
   evaluation_conditions.parse_message_into_xml = false;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_CREATED);
 
-  return evaluatePOCOResult(httpPut(uri, content), evaluation_conditions);
+  return evaluatePOCOResult(httpPut(uri, source), evaluation_conditions);
 }
 
 RWSClient::RWSResult RWSClient::deleteFile(const FileResource& resource)
@@ -524,6 +581,20 @@ RWSClient::RWSResult RWSClient::deleteFile(const FileResource& resource)
   return evaluatePOCOResult(httpDelete(uri), evaluation_conditions);
 }
 
+RWSClient::RWSResult RWSClient::getDirectory(const std::string& directory)
+{
+  // Directory listings can be large, so they are made on the bulk lane.
+  PriorityScope priority(*this, BULK);
+
+  std::string uri = Services::FILESERVICE + "/" + directory;
+
+  EvaluationConditions evaluation_conditions;
+  evaluation_conditions.parse_message_into_xml = true;
+  evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
+
+  return evaluatePOCOResult(coalescedGet(uri), evaluation_conditions);
+}
+
 RWSClient::RWSResult RWSClient::startSubscription(const SubscriptionResources& resources)
 {
   RWSResult result;
@@ -553,8 +624,11 @@ RWSClient::RWSResult RWSClient::startSubscription(const SubscriptionResources& r
 
     if (result.success)
     {
+      // The location of the subscription group is e.g. "ws://<address>/poll/<group id>".
       std::string poll = "/poll/";
-      subscription_group_id_ = findSubstringContent(poco_result.poco_info.http.response.header_info, poll, "\n");
+      std::string location = poco_result.poco_info.http.response.location();
+      size_t position = location.find(poll);
+      subscription_group_id_ = (position != std::string::npos ? location.substr(position + poll.size()) : "");
       poll += subscription_group_id_;
 
       // Create a WebSocket for receiving subscription events.
@@ -617,6 +691,19 @@ RWSClient::RWSResult RWSClient::logout()
   evaluation_conditions.parse_message_into_xml = true;
   evaluation_conditions.accepted_outcomes.push_back(HTTPResponse::HTTP_OK);
 
+  // Each used lane has its own RWS session, which also needs to be logged out.
+  const Priority lanes[] = {CONTROL, BULK};
+  for (size_t i = 0; i < sizeof(lanes) / sizeof(lanes[0]); ++i)
+  {
+    if (laneExists(lanes[i]))
+    {
+      PriorityScope priority(*this, lanes[i]);
+      httpGet(uri);
+    }
+  }
+
+  PriorityScope priority(*this, INTERACTIVE);
+
   return evaluatePOCOResult(httpGet(uri), evaluation_conditions);
 }
 
@@ -660,14 +747,291 @@ RWSClient::RWSResult RWSClient::registerRemoteUser(const std::string& username,
   return result;
 }
 
+void RWSClient::setCacheTTL(const CacheClass cache_class, const Poco::Int64 ttl)
+{
+  Poco::ScopedLock<Poco::Mutex> lock(cache_mutex_);
+
+  caches_[cache_class].ttl = ttl;
+
+  if (ttl <= 0)
+  {
+    caches_[cache_class].entries.clear();
+    ++caches_[cache_class].generation;
+  }
+}
+
+POCOClient::POCOResult RWSClient::readResource(const std::string& uri)
+{
+  CacheClass cache_class;
+
+  return (findCacheClass(uri, &cache_class) ? cachedGet(uri, cache_class) : coalescedGet(uri));
+}
+
+void RWSClient::invalidateCache()
+{
+  for (int i = 0; i < CACHE_CLASSES; ++i)
+  {
+    invalidateCache(static_cast<CacheClass>(i));
+  }
+}
+
+void RWSClient::invalidateCache(const CacheClass cache_class)
+{
+  Poco::ScopedLock<Poco::Mutex> lock(cache_mutex_);
+
+  caches_[cache_class].entries.clear();
+  ++caches_[cache_class].generation;
+}
+
 /************************************************************
  * Auxiliary methods
  */
 
+void RWSClient::onModifyingRequest(const std::string& uri)
+{
+  {
+    Poco::ScopedLock<Poco::Mutex> lock(coalescing_mutex_);
+    ++modification_generation_;
+  }
+
+  Poco::ScopedLock<Poco::Mutex> lock(cache_mutex_);
+
+  for (int i = 0; i < CACHE_CLASSES; ++i)
+  {
+    if (affectsCacheClass(static_cast<CacheClass>(i), uri))
+    {
+      caches_[i].entries.clear();
+      ++caches_[i].generation;
+    }
+  }
+}
+
+POCOClient::POCOResult RWSClient::cachedGet(const std::string& uri, const CacheClass cache_class)
+{
+  bool enabled = false;
+  Poco::UInt64 generation = 0;
+
+  {
+    Poco::ScopedLock<Poco::Mutex> lock(cache_mutex_);
+
+    ClassCache& cache = caches_[cache_class];
+    enabled = (cache.ttl > 0);
+
+    std::map<std::string, CacheEntry>::iterator it = cache.entries.find(uri);
+
+    if (it != cache.entries.end())
+    {
+      if (it->second.expires > Poco::Timestamp())
+      {
+        return it->second.result;
+      }
+
+      cache.entries.erase(it);
+    }
+
+    generation = cache.generation;
+  }
+
+  POCOResult result = coalescedGet(uri);
+
+  if (enabled && result.status == POCOResult::OK && result.poco_info.http.response.status == HTTPResponse::HTTP_OK)
+  {
+    Poco::ScopedLock<Poco::Mutex> lock(cache_mutex_);
+
+    ClassCache& cache = caches_[cache_class];
+
+    // Don't cache a response that was requested before an invalidation (it may be outdated).
+    if (cache.ttl > 0 && cache.generation == generation)
+    {
+      if (cache.entries.size() >= MAX_CACHE_ENTRIES)
+      {
+        cache.entries.clear();
+      }
+
+      CacheEntry& entry = cache.entries[uri];
+      entry.result = result;
+      entry.expires = Poco::Timestamp() + cache.ttl;
+    }
+  }
+
+  return result;
+}
+
+bool RWSClient::findCacheClass(const std::string& uri, CacheClass* p_cache_class)
+{
+  const std::string path = uri.substr(0, uri.find('?'));
+
+  // Dynamic resources never belong to a class, even if they are related to one.
+  if (path.compare(0, Resources::RW_RAPID_EXECUTION.size(), Resources::RW_RAPID_EXECUTION) == 0 ||
+      path.compare(0, Resources::RW_PANEL_CTRLSTATE.size(), Resources::RW_PANEL_CTRLSTATE) == 0 ||
+      path.compare(0, Resources::RW_PANEL_OPMODE.size(), Resources::RW_PANEL_OPMODE) == 0 ||
+      path.compare(0, Resources::RW_RAPID_TASKS.size(), Resources::RW_RAPID_TASKS) == 0 ||
+      (path.compare(0, Resources::RW_MOTIONSYSTEM_MECHUNITS.size(), Resources::RW_MOTIONSYSTEM_MECHUNITS) == 0 &&
+       uri.find("resource=static") == std::string::npos))
+  {
+    return false;
+  }
+
+  for (int i = 0; i < CACHE_CLASSES; ++i)
+  {
+    const CacheClass cache_class = static_cast<CacheClass>(i);
+
+    // A class' resources are the ones that its related modifications may affect.
+    if (affectsCacheClass(cache_class, path))
+    {
+      *p_cache_class = cache_class;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool RWSClient::affectsCacheClass(const CacheClass cache_class, const std::string& uri)
+{
+  std::vector<std::string> prefixes;
+
+  switch (cache_class)
+  {
+    case CACHE_CONTROLLER:
+      prefixes.push_back(Services::CTRL);
+      prefixes.push_back(Resources::RW_SYSTEM);
+    break;
+
+    case CACHE_CONFIGURATION:
+      prefixes.push_back(Resources::RW_CFG);
+    break;
+
+    case CACHE_MECHANICAL_UNITS:
+      prefixes.push_back(Resources::RW_CFG);
+      prefixes.push_back(Resources::RW_MOTIONSYSTEM_MECHUNITS);
+    break;
+
+    case CACHE_RAPID_PROGRAM:
+      // Modifications of the RAPID execution and tasks may affect the modules (e.g. when a program is loaded).
+      prefixes.push_back(Resources::RW_RAPID_EXECUTION);
+      prefixes.push_back(Resources::RW_RAPID_MODULES);
+      prefixes.push_back(Resources::RW_RAPID_SYMBOL_PROPERTIES_RAPID);
+      prefixes.push_back(Resources::RW_RAPID_TASKS);
+    break;
+
+    case CACHE_PANEL:
+      prefixes.push_back(Services::RW + "/panel");
+    break;
+
+    default:
+    break;
+  }
+
+  for (size_t i = 0; i < prefixes.size(); ++i)
+  {
+    if (uri.compare(0, prefixes[i].size(), prefixes[i]) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+POCOClient::POCOResult RWSClient::coalescedGet(const std::string& uri)
+{
+  // Requests are only shared within the same priority, so e.g. control requests never wait on the bulk lane.
+  const std::string key = std::string(1, static_cast<char>('0' + findPriority())) + uri;
+
+  Poco::SharedPtr<InFlightRequest> p_request;
+
+  Poco::Timestamp deadline;
+  const bool has_deadline = findDeadline(&deadline);
+
+  {
+    Poco::ScopedLock<Poco::Mutex> lock(coalescing_mutex_);
+
+    std::map<std::string, Poco::SharedPtr<InFlightRequest> >::iterator it = in_flight_requests_.find(key);
+
+    while (it != in_flight_requests_.end() && it->second->generation == modification_generation_)
+    {
+      // Join the request in flight, while respecting any deadline of the current thread.
+      p_request = it->second;
+
+      while (!p_request->done)
+      {
+        if (!has_deadline)
+        {
+          coalescing_condition_.wait(coalescing_mutex_);
+        }
+        else
+        {
+          Poco::Timestamp::TimeDiff remaining = deadline - Poco::Timestamp();
+
+          if (remaining <= 0 ||
+              (!coalescing_condition_.tryWait(coalescing_mutex_, static_cast<long>(remaining / 1000 + 1)) &&
+               !p_request->done))
+          {
+            POCOResult result;
+            result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
+            result.exception_message = "Deadline exceeded";
+            return result;
+          }
+        }
+      }
+
+      // A timeout caused by the starting thread's deadline (or its admission wait) only applies to that thread, so
+      // join, or start, another request instead (the completed request has been removed from the map).
+      if (!(p_request->deadline_bound && p_request->result.status == POCOResult::EXCEPTION_POCO_TIMEOUT))
+      {
+        return p_request->result;
+      }
+
+      it = in_flight_requests_.find(key);
+    }
+
+    // Start a new request (any outdated request in flight is still completed, for the threads that joined it).
+    p_request = new InFlightRequest(modification_generation_, has_deadline);
+    in_flight_requests_[key] = p_request;
+  }
+
+  POCOResult result;
+
+  try
+  {
+    result = httpGet(uri);
+  }
+  catch (...)
+  {
+    completeInFlightRequest(key, p_request, result);
+    throw;
+  }
+
+  completeInFlightRequest(key, p_request, result);
+
+  return result;
+}
+
+void RWSClient::completeInFlightRequest(const std::string& key,
+                                        const Poco::SharedPtr<InFlightRequest>& p_request,
+                                        const POCOResult& result)
+{
+  Poco::ScopedLock<Poco::Mutex> lock(coalescing_mutex_);
+
+  p_request->result = result;
+  p_request->done = true;
+
+  std::map<std::string, Poco::SharedPtr<InFlightRequest> >::iterator it = in_flight_requests_.find(key);
+
+  if (it != in_flight_requests_.end() && it->second == p_request)
+  {
+    in_flight_requests_.erase(it);
+  }
+
+  coalescing_condition_.broadcast();
+}
+
 RWSClient::RWSResult RWSClient::evaluatePOCOResult(const POCOResult& poco_result,
                                                    const EvaluationConditions& conditions)
 {
   RWSResult result;
+  result.content = poco_result.poco_info.http.response.content;
 
   checkAcceptedOutcomes(&result, poco_result, conditions);
 
@@ -676,6 +1040,8 @@ RWSClient::RWSResult RWSClient::evaluatePOCOResult(const POCOResult& poco_result
     parseMessage(&result, poco_result);
   }
 
+  Poco::ScopedLock<Poco::Mutex> lock(log_mutex_);
+
   if (log_.size() >= LOG_SIZE)
   {
     log_.pop_back();
@@ -710,15 +1076,16 @@ void RWSClient::parseMessage(RWSResult* result, const POCOResult& poco_result)
 {
   if (result)
   {
-    std::stringstream ss;
+    // Parse directly from the received content, without copying it.
+    const std::string* p_message = 0;
 
     if (!poco_result.poco_info.http.response.content.empty())
     {
-      ss << poco_result.poco_info.http.response.content;
+      p_message = &poco_result.poco_info.http.response.content.str();
     }
     else if (!poco_result.poco_info.websocket.frame_content.empty())
     {
-      ss << poco_result.poco_info.websocket.frame_content;
+      p_message = &poco_result.poco_info.websocket.frame_content;
     }
     else
     {
@@ -731,8 +1098,7 @@ void RWSClient::parseMessage(RWSResult* result, const POCOResult& poco_result)
     {
       try
       {
-        Poco::XML::InputSource input_source(ss);
-        result->p_xml_document = Poco::XML::DOMParser().parse(&input_source);
+        result->p_xml_document = Poco::XML::DOMParser().parseMemory(p_message->data(), p_message->size());
       }
       catch (...)
       {
@@ -746,6 +1112,8 @@ void RWSClient::parseMessage(RWSResult* result, const POCOResult& poco_result)
 
 std::string RWSClient::getLogText(const bool verbose)
 {
+  Poco::ScopedLock<Poco::Mutex> lock(log_mutex_);
+
   if (log_.size() == 0)
   {
     return "";
@@ -765,6 +1133,8 @@ std::string RWSClient::getLogText(const bool verbose)
 
 std::string RWSClient::getLogTextLatestEvent(const bool verbose)
 {
+  Poco::ScopedLock<Poco::Mutex> lock(log_mutex_);
+
   return (log_.size() == 0 ? "" : log_[0].toString(verbose, 0));
 }
 
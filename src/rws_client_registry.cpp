@@ -0,0 +1,168 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <sstream>
+
+#include "abb_librws/rws_client_registry.h"
+
+namespace abb
+{
+namespace rws
+{
+/***********************************************************************************************************************
+ * Class definitions: RWSClientRegistry::Handle
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RWSClientRegistry::Handle::Handle(const std::string& ip_address,
+                                  const unsigned short port,
+                                  const std::string& username,
+                                  const std::string& password,
+                                  const POCOClient::TLSOptions& tls,
+                                  const bool shared)
+:
+key_(shared ? generateKey(ip_address, port, username, password, tls) : "")
+{
+  if (shared)
+  {
+    Poco::ScopedLock<Poco::Mutex> lock(mutex());
+
+    Entry& entry = entries()[key_];
+
+    // Creating a client is cheap, since it does not connect until it is used.
+    if (entry.p_client.isNull())
+    {
+      entry.p_client = new RWSClient(ip_address, port, username, password, tls);
+    }
+
+    ++entry.handles;
+    p_client_ = entry.p_client;
+  }
+  else
+  {
+    p_client_ = new RWSClient(ip_address, port, username, password, tls);
+  }
+}
+
+RWSClientRegistry::Handle::~Handle()
+{
+  Poco::SharedPtr<RWSClient> p_released;
+
+  if (!key_.empty())
+  {
+    Poco::ScopedLock<Poco::Mutex> lock(mutex());
+
+    std::map<std::string, Entry>::iterator it = entries().find(key_);
+
+    if (it != entries().end() && --it->second.handles == 0)
+    {
+      p_released = it->second.p_client;
+      entries().erase(it);
+    }
+  }
+
+  // Release this handle's reference first, so the last one (if any) logs out the client outside the registry's lock.
+  p_client_ = 0;
+  p_released = 0;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: RWSClientRegistry
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+size_t RWSClientRegistry::handles(const std::string& ip_address,
+                                  const unsigned short port,
+                                  const std::string& username,
+                                  const std::string& password,
+                                  const POCOClient::TLSOptions& tls)
+{
+  Poco::ScopedLock<Poco::Mutex> lock(mutex());
+
+  std::map<std::string, Entry>::const_iterator it =
+    entries().find(generateKey(ip_address, port, username, password, tls));
+
+  return (it == entries().end() ? 0 : it->second.handles);
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+std::string RWSClientRegistry::generateKey(const std::string& ip_address,
+                                           const unsigned short port,
+                                           const std::string& username,
+                                           const std::string& password,
+                                           const POCOClient::TLSOptions& tls)
+{
+  // Use a separator that can not occur in the fields, so different fields can not produce the same key.
+  const char separator = '\0';
+
+  std::stringstream ss;
+  ss << ip_address << separator
+     << port << separator
+     << username << separator
+     << password << separator
+     << tls.enabled << tls.verify_peer << tls.session_resumption << separator
+     << tls.ca_location;
+
+  return ss.str();
+}
+
+Poco::Mutex& RWSClientRegistry::mutex()
+{
+  // Constructed on first use, so the registry can be used during static initialization.
+  static Poco::Mutex registry_mutex;
+  return registry_mutex;
+}
+
+std::map<std::string, RWSClientRegistry::Entry>& RWSClientRegistry::entries()
+{
+  static std::map<std::string, Entry> registry_entries;
+  return registry_entries;
+}
+
+} // end namespace rws
+} // end namespace abb
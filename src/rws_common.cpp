@@ -267,6 +267,9 @@ const std::string Identifiers::CTRLEXECSTATE                  = "ctrlexecstate";
 const std::string Identifiers::CTRLSTATE                      = "ctrlstate";
 const std::string Identifiers::DATTYP                         = "dattyp";
 const std::string Identifiers::EXCSTATE                       = "excstate";
+const std::string Identifiers::FS_FILE                        = "fs-file";
+const std::string Identifiers::FS_MDATE                       = "fs-mdate";
+const std::string Identifiers::FS_SIZE                        = "fs-size";
 const std::string Identifiers::IOS_SIGNAL                     = "ios-signal";
 const std::string Identifiers::HOME_DIRECTORY                 = "$home";
 const std::string Identifiers::LVALUE                         = "lvalue";
@@ -330,6 +333,9 @@ const XMLAttribute XMLAttributes::CLASS_CTRLEXECSTATE(Identifiers::CLASS     , I
 const XMLAttribute XMLAttributes::CLASS_CTRLSTATE(Identifiers::CLASS         , Identifiers::CTRLSTATE);
 const XMLAttribute XMLAttributes::CLASS_DATTYP(Identifiers::CLASS            , Identifiers::DATTYP);
 const XMLAttribute XMLAttributes::CLASS_EXCSTATE(Identifiers::CLASS          , Identifiers::EXCSTATE);
+const XMLAttribute XMLAttributes::CLASS_FS_FILE(Identifiers::CLASS           , Identifiers::FS_FILE);
+const XMLAttribute XMLAttributes::CLASS_FS_MDATE(Identifiers::CLASS          , Identifiers::FS_MDATE);
+const XMLAttribute XMLAttributes::CLASS_FS_SIZE(Identifiers::CLASS           , Identifiers::FS_SIZE);
 const XMLAttribute XMLAttributes::CLASS_IOS_SIGNAL(Identifiers::CLASS        , Identifiers::IOS_SIGNAL);
 const XMLAttribute XMLAttributes::CLASS_LVALUE(Identifiers::CLASS            , Identifiers::LVALUE);
 const XMLAttribute XMLAttributes::CLASS_MOTIONTASK(Identifiers::CLASS        , Identifiers::MOTIONTASK);
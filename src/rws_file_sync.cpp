@@ -0,0 +1,371 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "Poco/DigestEngine.h"
+#include "Poco/DirectoryIterator.h"
+#include "Poco/Exception.h"
+#include "Poco/File.h"
+#include "Poco/Path.h"
+#include "Poco/SHA1Engine.h"
+#include "Poco/Thread.h"
+
+#include "abb_librws/rws_file_sync.h"
+
+using namespace Poco;
+
+namespace abb
+{
+namespace rws
+{
+typedef SystemConstants::RWS::XMLAttributes XMLAttributes;
+typedef SystemConstants::RWS::Identifiers Identifiers;
+
+/***********************************************************************************************************************
+ * Class definitions: RWSFileSync::Uploader
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void RWSFileSync::Uploader::run()
+{
+  while (true)
+  {
+    std::string name;
+    std::string local_directory;
+    std::string remote_directory;
+
+    {
+      ScopedLock<Mutex> lock(jobs_.mutex);
+
+      if (jobs_.pending.empty())
+      {
+        return;
+      }
+
+      name = jobs_.pending.front();
+      jobs_.pending.pop_front();
+      local_directory = jobs_.local_directory;
+      remote_directory = jobs_.remote_directory;
+    }
+
+    bool uploaded = false;
+
+    try
+    {
+      POCOClient::FileSource source(Path(Path::forDirectory(local_directory), name).toString());
+      uploaded = client_.uploadFile(RWSClient::FileResource(name, remote_directory), source).success;
+    }
+    catch (Poco::Exception&)
+    {
+      uploaded = false;
+    }
+
+    ScopedLock<Mutex> lock(jobs_.mutex);
+    (uploaded ? jobs_.uploaded : jobs_.failed).push_back(name);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: RWSFileSync
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RWSFileSync::RWSFileSync(const std::string& ip_address,
+                         const unsigned short port,
+                         const std::string& username,
+                         const std::string& password,
+                         const size_t number_of_uploaders)
+:
+ip_address_(ip_address),
+port_(port),
+username_(username),
+password_(password),
+number_of_uploaders_(std::max(number_of_uploaders, static_cast<size_t>(1)))
+{
+  clients_.push_back(new RWSClient(ip_address_, port_, username_, password_));
+}
+
+RWSFileSync::Result RWSFileSync::sync(const std::string& local_directory,
+                                      const std::string& remote_directory,
+                                      const std::string& manifest_path)
+{
+  Result result;
+  Manifest old_manifest = loadManifest(manifest_path);
+  Manifest new_manifest;
+  RemoteListing remote_listing;
+  UploadJobs jobs;
+
+  // A single listing request is enough to decide which files are up to date.
+  if (!listRemoteDirectory(remote_directory, &remote_listing))
+  {
+    return result;
+  }
+
+  try
+  {
+    for (DirectoryIterator i(local_directory), end; i != end; ++i)
+    {
+      if (!i->isFile())
+      {
+        continue;
+      }
+
+      std::string name = i.name();
+      ManifestEntry entry;
+      entry.size = i->getSize();
+      entry.modified = i->getLastModified().epochMicroseconds();
+
+      Manifest::const_iterator previous = old_manifest.find(name);
+      RemoteListing::const_iterator remote = remote_listing.find(name);
+
+      // Only hash files whose size or modification time has changed since the last sync.
+      if (previous != old_manifest.end() &&
+          previous->second.size == entry.size &&
+          previous->second.modified == entry.modified)
+      {
+        entry.hash = previous->second.hash;
+      }
+      else
+      {
+        entry.hash = hashFile(i->path());
+      }
+
+      bool up_to_date = (!entry.hash.empty() &&
+                         previous != old_manifest.end() &&
+                         previous->second.hash == entry.hash &&
+                         remote != remote_listing.end() &&
+                         remote->second.size == entry.size &&
+                         remote->second.modified == previous->second.remote_modified);
+
+      if (up_to_date)
+      {
+        entry.remote_modified = remote->second.modified;
+        new_manifest[name] = entry;
+        ++result.files_unchanged;
+      }
+      else
+      {
+        new_manifest[name] = entry;
+        jobs.pending.push_back(name);
+      }
+    }
+  }
+  catch (Poco::Exception&)
+  {
+    return result;
+  }
+
+  if (!jobs.pending.empty())
+  {
+    jobs.local_directory = local_directory;
+    jobs.remote_directory = remote_directory;
+    upload(jobs);
+
+    // Failed files are left out of the manifest, so they are retried by the next sync.
+    for (size_t i = 0; i < jobs.failed.size(); ++i)
+    {
+      new_manifest.erase(jobs.failed[i]);
+    }
+
+    // Record the remote modification dates of the uploaded files.
+    RemoteListing updated_listing;
+    bool listed = listRemoteDirectory(remote_directory, &updated_listing);
+
+    for (size_t i = 0; i < jobs.uploaded.size(); ++i)
+    {
+      RemoteListing::const_iterator remote = updated_listing.find(jobs.uploaded[i]);
+
+      if (listed && remote != updated_listing.end())
+      {
+        new_manifest[jobs.uploaded[i]].remote_modified = remote->second.modified;
+      }
+      else
+      {
+        new_manifest.erase(jobs.uploaded[i]);
+      }
+    }
+
+    result.uploaded_files = jobs.uploaded;
+    result.failed_files = jobs.failed;
+  }
+
+  result.success = (saveManifest(manifest_path, new_manifest) && result.failed_files.empty());
+
+  return result;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+bool RWSFileSync::listRemoteDirectory(const std::string& directory, RemoteListing* p_listing)
+{
+  RWSClient::RWSResult rws_result = clients_[0]->getDirectory(directory);
+
+  if (!rws_result.success)
+  {
+    return false;
+  }
+
+  std::vector<Poco::XML::Node*> node_list = xmlFindNodes(rws_result.p_xml_document, XMLAttributes::CLASS_FS_FILE);
+
+  for (size_t i = 0; i < node_list.size(); ++i)
+  {
+    RemoteFile file;
+    std::stringstream ss(xmlFindTextContent(node_list.at(i), XMLAttributes::CLASS_FS_SIZE));
+    ss >> file.size;
+    file.modified = xmlFindTextContent(node_list.at(i), XMLAttributes::CLASS_FS_MDATE);
+
+    (*p_listing)[xmlNodeGetAttributeValue(node_list.at(i), Identifiers::TITLE)] = file;
+  }
+
+  return true;
+}
+
+void RWSFileSync::upload(UploadJobs& jobs)
+{
+  size_t number_of_uploaders = std::min(number_of_uploaders_, jobs.pending.size());
+
+  // Each uploader has its own client (i.e. RWS session), since a session handles one request at a time.
+  while (clients_.size() < number_of_uploaders)
+  {
+    clients_.push_back(new RWSClient(ip_address_, port_, username_, password_));
+  }
+
+  std::vector<SharedPtr<Uploader> > uploaders;
+  std::vector<SharedPtr<Thread> > threads;
+
+  for (size_t i = 0; i < number_of_uploaders; ++i)
+  {
+    uploaders.push_back(new Uploader(*clients_[i], jobs));
+    threads.push_back(new Thread());
+    threads.back()->start(*uploaders.back());
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+  {
+    threads[i]->join();
+  }
+}
+
+RWSFileSync::Manifest RWSFileSync::loadManifest(const std::string& path)
+{
+  Manifest manifest;
+  std::ifstream file(path.c_str());
+  std::string line;
+
+  // Each line contains: name, size, modification time, hash and remote modification date (separated by tabs).
+  while (std::getline(file, line))
+  {
+    std::vector<std::string> fields;
+    std::stringstream line_stream(line);
+    std::string field;
+
+    while (std::getline(line_stream, field, '\t'))
+    {
+      fields.push_back(field);
+    }
+
+    if (fields.size() == 5)
+    {
+      ManifestEntry entry;
+      std::stringstream ss(fields[1] + " " + fields[2]);
+      ss >> entry.size >> entry.modified;
+      entry.hash = fields[3];
+      entry.remote_modified = fields[4];
+
+      if (!ss.fail())
+      {
+        manifest[fields[0]] = entry;
+      }
+    }
+  }
+
+  return manifest;
+}
+
+bool RWSFileSync::saveManifest(const std::string& path, const Manifest& manifest)
+{
+  std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+
+  for (Manifest::const_iterator i = manifest.begin(); i != manifest.end(); ++i)
+  {
+    file << i->first << '\t'
+         << i->second.size << '\t'
+         << i->second.modified << '\t'
+         << i->second.hash << '\t'
+         << i->second.remote_modified << '\n';
+  }
+
+  file.close();
+
+  return !file.fail();
+}
+
+std::string RWSFileSync::hashFile(const std::string& path)
+{
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+
+  if (!file.is_open())
+  {
+    return "";
+  }
+
+  SHA1Engine engine;
+  std::vector<char> chunk(64 * 1024);
+
+  while (file.read(&chunk[0], chunk.size()) || file.gcount() > 0)
+  {
+    engine.update(&chunk[0], static_cast<unsigned>(file.gcount()));
+  }
+
+  return DigestEngine::digestToHex(engine.digest());
+}
+
+} // end namespace rws
+} // end namespace abb
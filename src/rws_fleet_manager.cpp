@@ -0,0 +1,655 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <iterator>
+#include <sstream>
+
+#include "abb_librws/rws_fleet_manager.h"
+
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace abb
+{
+namespace rws
+{
+typedef SystemConstants::RWS::Services Services;
+
+const char* const RWSFleetManager::SUBSCRIPTION_PROTOCOL = "robapi2_subscription";
+
+/***********************************************************************************************************************
+ * Class definitions: RWSFleetManager::Controller
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RWSFleetManager::Controller::Controller(RWSFleetManager& manager,
+                                        const ControllerId id,
+                                        const std::string& ip_address,
+                                        const unsigned short port,
+                                        const std::string& username,
+                                        const std::string& password)
+:
+manager(manager),
+id(id),
+active(true),
+request_being_made_completed(false),
+websocket_request_id(0),
+client(manager.event_loop_, ip_address, port, username, password, this)
+{}
+
+void RWSFleetManager::Controller::onHTTPResult(const Poco::UInt64 request_id, const POCOClient::POCOResult& result)
+{
+  manager.handleHTTPResult(*this, request_id, result);
+}
+
+void RWSFleetManager::Controller::onWebSocketFrame(const POCOClient::POCOResult& result)
+{
+  manager.handleWebSocketFrame(*this, result);
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: RWSFleetManager
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RWSFleetManager::RWSFleetManager(const size_t number_of_threads, const size_t max_requests_in_flight)
+:
+event_loop_(number_of_threads),
+max_requests_in_flight_(max_requests_in_flight),
+last_id_(0),
+scheduling_offset_(0),
+p_listener_(0),
+running_(false),
+runnable_(*this, &RWSFleetManager::run)
+{}
+
+RWSFleetManager::~RWSFleetManager()
+{
+  stop();
+}
+
+void RWSFleetManager::start()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (!running_)
+  {
+    event_loop_.start();
+    stop_event_.reset();
+    thread_.start(runnable_);
+    running_ = true;
+  }
+}
+
+void RWSFleetManager::stop()
+{
+  {
+    ScopedLock<Mutex> lock(mutex_);
+
+    if (!running_)
+    {
+      return;
+    }
+
+    running_ = false;
+  }
+
+  stop_event_.set();
+  thread_.join();
+  event_loop_.stop();
+
+  ScopedLock<Mutex> lock(mutex_);
+
+  for (std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.begin(); i != controllers_.end(); ++i)
+  {
+    i->second->client.close();
+  }
+
+  retired_controllers_.clear();
+  notifications_.clear();
+}
+
+void RWSFleetManager::setListener(Listener* p_listener)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  p_listener_ = p_listener;
+}
+
+RWSFleetManager::ControllerId RWSFleetManager::registerController(const std::string& ip_address,
+                                                                  const unsigned short port,
+                                                                  const std::string& username,
+                                                                  const std::string& password)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  ControllerId id = ++last_id_;
+  SharedPtr<Controller> p_controller = new Controller(*this, id, ip_address, port, username, password);
+
+  for (size_t i = 0; i < fleet_resources_.size(); ++i)
+  {
+    p_controller->resources.push_back(PolledResource(fleet_resources_[i].first, fleet_resources_[i].second));
+  }
+
+  controllers_[id] = p_controller;
+
+  return id;
+}
+
+void RWSFleetManager::unregisterController(const ControllerId id)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.find(id);
+
+  if (i != controllers_.end())
+  {
+    // Deactivate first, so that the requests failed by close() (and any late callbacks) are not reported to the
+    // listener. The completion handler still accounts for them in the fleet-wide statistics.
+    i->second->active = false;
+    i->second->client.close();
+
+    // The event loop may still refer to the controller, so keep it until the next scheduling round.
+    retired_controllers_.push_back(i->second);
+    controllers_.erase(i);
+  }
+}
+
+std::vector<RWSFleetManager::ControllerId> RWSFleetManager::getControllers()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::vector<ControllerId> result;
+
+  for (std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.begin(); i != controllers_.end(); ++i)
+  {
+    result.push_back(i->first);
+  }
+
+  return result;
+}
+
+void RWSFleetManager::addPolledResource(const std::string& uri, const Poco::Int64 period)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  fleet_resources_.push_back(std::make_pair(uri, period));
+
+  for (std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.begin(); i != controllers_.end(); ++i)
+  {
+    i->second->resources.push_back(PolledResource(uri, period));
+  }
+}
+
+void RWSFleetManager::addPolledResource(const ControllerId id, const std::string& uri, const Poco::Int64 period)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.find(id);
+
+  if (i != controllers_.end())
+  {
+    i->second->resources.push_back(PolledResource(uri, period));
+  }
+}
+
+void RWSFleetManager::removePolledResource(const std::string& uri)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  for (size_t i = fleet_resources_.size(); i > 0; --i)
+  {
+    if (fleet_resources_[i - 1].first == uri)
+    {
+      fleet_resources_.erase(fleet_resources_.begin() + (i - 1));
+    }
+  }
+
+  for (std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.begin(); i != controllers_.end(); ++i)
+  {
+    std::vector<PolledResource>& resources = i->second->resources;
+
+    for (size_t j = resources.size(); j > 0; --j)
+    {
+      if (resources[j - 1].uri == uri)
+      {
+        resources.erase(resources.begin() + (j - 1));
+      }
+    }
+  }
+}
+
+void RWSFleetManager::startSubscription(const ControllerId id, const RWSClient::SubscriptionResources& resources)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.find(id);
+
+  if (i != controllers_.end())
+  {
+    std::vector<RWSClient::SubscriptionResources::SubscriptionResource> temp = resources.getResources();
+
+    // Generate content for a subscription HTTP post request (as RWSClient::startSubscription(...)).
+    std::stringstream subscription_content;
+    for (std::size_t j = 0; j < temp.size(); ++j)
+    {
+      subscription_content << "resources=" << j
+                           << "&"
+                           << j << "=" << temp.at(j).resource_uri
+                           << "&"
+                           << j << "-p=" << temp.at(j).priority
+                           << (j < temp.size() - 1 ? "&" : "");
+    }
+
+    makeRequest(*i->second, SUBSCRIBE, Services::SUBSCRIPTION, subscription_content.str());
+  }
+}
+
+void RWSFleetManager::endSubscription(const ControllerId id)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.find(id);
+
+  if (i != controllers_.end())
+  {
+    Controller& controller = *i->second;
+
+    controller.websocket_request_id = 0;
+    controller.client.webSocketShutdown();
+
+    if (!controller.subscription_group_id.empty())
+    {
+      std::string uri = Services::SUBSCRIPTION + "/" + controller.subscription_group_id;
+      controller.subscription_group_id.clear();
+
+      makeRequest(controller, UNSUBSCRIBE, uri);
+    }
+  }
+}
+
+bool RWSFleetManager::getSnapshot(const ControllerId id, const std::string& uri, ResourceSnapshot* p_snapshot)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.find(id);
+
+  if (i != controllers_.end() && p_snapshot)
+  {
+    for (size_t j = 0; j < i->second->resources.size(); ++j)
+    {
+      const PolledResource& resource = i->second->resources[j];
+
+      if (resource.uri == uri && resource.snapshot.timestamp != Timestamp(0))
+      {
+        *p_snapshot = resource.snapshot;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+std::map<RWSFleetManager::ControllerId, RWSFleetManager::ResourceSnapshot>
+RWSFleetManager::getFleetSnapshot(const std::string& uri)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  std::map<ControllerId, ResourceSnapshot> result;
+
+  for (std::map<ControllerId, SharedPtr<Controller> >::iterator i = controllers_.begin(); i != controllers_.end(); ++i)
+  {
+    for (size_t j = 0; j < i->second->resources.size(); ++j)
+    {
+      const PolledResource& resource = i->second->resources[j];
+
+      if (resource.uri == uri && resource.snapshot.timestamp != Timestamp(0))
+      {
+        result[i->first] = resource.snapshot;
+        break;
+      }
+    }
+  }
+
+  return result;
+}
+
+RWSFleetManager::Statistics RWSFleetManager::getStatistics()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  return statistics_;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void RWSFleetManager::run()
+{
+  while (!stop_event_.tryWait(SCHEDULING_INTERVAL))
+  {
+    releaseRetiredControllers();
+    schedulePolls();
+    deliverNotifications();
+  }
+}
+
+void RWSFleetManager::releaseRetiredControllers()
+{
+  std::vector<SharedPtr<Controller> > retired_controllers;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    retired_controllers.swap(retired_controllers_);
+  }
+
+  // The controllers (and their clients) are destroyed when the vector goes out of scope.
+}
+
+void RWSFleetManager::schedulePolls()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (controllers_.empty())
+  {
+    return;
+  }
+
+  Timestamp now;
+
+  // Rotate the starting controller each round, so that no controller is starved by the request limit.
+  std::map<ControllerId, SharedPtr<Controller> >::iterator start = controllers_.begin();
+  std::advance(start, scheduling_offset_++ % controllers_.size());
+  std::map<ControllerId, SharedPtr<Controller> >::iterator i = start;
+
+  do
+  {
+    Controller& controller = *i->second;
+
+    for (size_t j = 0; j < controller.resources.size(); ++j)
+    {
+      PolledResource& resource = controller.resources[j];
+
+      if (resource.outstanding || resource.next_poll > now)
+      {
+        continue;
+      }
+
+      if (statistics_.requests_in_flight >= max_requests_in_flight_)
+      {
+        ++statistics_.polls_deferred;
+        continue;
+      }
+
+      // Keep a fixed rate, unless the poll is already more than a period late.
+      resource.next_poll += resource.period;
+      if (resource.next_poll < now)
+      {
+        resource.next_poll = now + resource.period;
+      }
+
+      resource.outstanding = true;
+      makeRequest(controller, POLL, resource.uri);
+    }
+
+    if (++i == controllers_.end())
+    {
+      i = controllers_.begin();
+    }
+  } while (i != start);
+}
+
+void RWSFleetManager::makeRequest(Controller& controller,
+                                  const RequestKind kind,
+                                  const std::string& uri,
+                                  const std::string& content)
+{
+  ++statistics_.requests_sent;
+  ++statistics_.requests_in_flight;
+
+  controller.request_being_made = std::make_pair(kind, uri);
+  controller.request_being_made_completed = false;
+
+  Poco::UInt64 request_id = 0;
+
+  switch (kind)
+  {
+    case POLL:
+      request_id = controller.client.httpGet(uri);
+    break;
+    case SUBSCRIBE:
+      request_id = controller.client.httpPost(uri, content);
+    break;
+    case UNSUBSCRIBE:
+      request_id = controller.client.httpDelete(uri);
+    break;
+    case WEBSOCKET:
+      // Any earlier handshake is replaced (and failed), and is then no longer the current one.
+      controller.websocket_request_id = 0;
+      request_id = controller.client.webSocketConnect(uri, SUBSCRIPTION_PROTOCOL);
+    break;
+  }
+
+  // Keep track of the request, unless it has already been completed (see handleHTTPResult).
+  if (!controller.request_being_made_completed)
+  {
+    controller.requests_in_flight[request_id] = controller.request_being_made;
+
+    if (kind == WEBSOCKET)
+    {
+      controller.websocket_request_id = request_id;
+    }
+  }
+
+  controller.request_being_made_completed = true;
+}
+
+void RWSFleetManager::deliverNotifications()
+{
+  std::vector<Notification> notifications;
+  Listener* p_listener = 0;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    notifications.swap(notifications_);
+    p_listener = p_listener_;
+  }
+
+  if (p_listener)
+  {
+    for (size_t i = 0; i < notifications.size(); ++i)
+    {
+      if (notifications[i].subscription_event)
+      {
+        p_listener->onSubscriptionEvent(notifications[i].id, notifications[i].result);
+      }
+      else
+      {
+        p_listener->onResourceUpdate(notifications[i].id, notifications[i].uri, notifications[i].snapshot);
+      }
+    }
+  }
+}
+
+void RWSFleetManager::handleHTTPResult(Controller& controller,
+                                       const Poco::UInt64 request_id,
+                                       const POCOClient::POCOResult& result)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  const POCOClient::POCOResult::POCOInfo::HTTPInfo& http = result.poco_info.http;
+  bool ok = (result.status == POCOClient::POCOResult::OK);
+
+  if (ok)
+  {
+    ++statistics_.requests_succeeded;
+  }
+  else
+  {
+    ++statistics_.requests_failed;
+  }
+
+  if (statistics_.requests_in_flight > 0)
+  {
+    --statistics_.requests_in_flight;
+  }
+
+  if (!controller.active)
+  {
+    return;
+  }
+
+  // Find the completed request by its id. A request that fails directly is completed before its id is known, and is
+  // then the request being made.
+  std::pair<RequestKind, std::string> request;
+  std::map<Poco::UInt64, std::pair<RequestKind, std::string> >::iterator i =
+    controller.requests_in_flight.find(request_id);
+  bool current_handshake = (request_id == controller.websocket_request_id);
+
+  if (i != controller.requests_in_flight.end())
+  {
+    request = i->second;
+    controller.requests_in_flight.erase(i);
+  }
+  else if (!controller.request_being_made_completed)
+  {
+    request = controller.request_being_made;
+    controller.request_being_made_completed = true;
+    current_handshake = (request.first == WEBSOCKET);
+  }
+  else
+  {
+    return;
+  }
+
+  if (request.first == WEBSOCKET)
+  {
+    // Only the current handshake is reported, earlier ones have been replaced or ended.
+    if (current_handshake)
+    {
+      controller.websocket_request_id = 0;
+
+      if (!ok || http.response.status != HTTPResponse::HTTP_SWITCHING_PROTOCOLS)
+      {
+        Notification notification;
+        notification.id = controller.id;
+        notification.subscription_event = true;
+        notification.result = result;
+        notifications_.push_back(notification);
+      }
+    }
+  }
+  else if (request.first == POLL)
+  {
+    for (size_t i = 0; i < controller.resources.size(); ++i)
+    {
+      PolledResource& resource = controller.resources[i];
+
+      if (resource.uri == request.second)
+      {
+        resource.outstanding = false;
+        resource.snapshot.success = (ok && http.response.status == HTTPResponse::HTTP_OK);
+        resource.snapshot.status = http.response.status;
+        resource.snapshot.content = http.response.content;
+        resource.snapshot.error_message = result.exception_message;
+        resource.snapshot.timestamp.update();
+
+        Notification notification;
+        notification.id = controller.id;
+        notification.uri = resource.uri;
+        notification.snapshot = resource.snapshot;
+        notifications_.push_back(notification);
+        break;
+      }
+    }
+  }
+  else if (request.first == SUBSCRIBE)
+  {
+    // The location of the subscription group is e.g. "ws://<address>/poll/<group id>".
+    std::string poll = "/poll/";
+    std::string location = http.response.location();
+    size_t position = location.find(poll);
+
+    if (ok && http.response.status == HTTPResponse::HTTP_CREATED && position != std::string::npos)
+    {
+      controller.subscription_group_id = location.substr(position + poll.size());
+      makeRequest(controller, WEBSOCKET, poll + controller.subscription_group_id);
+    }
+    else
+    {
+      Notification notification;
+      notification.id = controller.id;
+      notification.subscription_event = true;
+      notification.result = result;
+      notifications_.push_back(notification);
+    }
+  }
+}
+
+void RWSFleetManager::handleWebSocketFrame(Controller& controller, const POCOClient::POCOResult& result)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (!controller.active)
+  {
+    return;
+  }
+
+  if (result.status == POCOClient::POCOResult::OK)
+  {
+    ++statistics_.subscription_events;
+  }
+
+  Notification notification;
+  notification.id = controller.id;
+  notification.subscription_event = true;
+  notification.result = result;
+  notifications_.push_back(notification);
+}
+
+} // end namespace rws
+} // end namespace abb
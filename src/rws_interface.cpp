@@ -983,11 +983,21 @@ bool RWSInterface::getFile(const RWSClient::FileResource& resource, std::string*
   return rws_client_.getFile(resource, p_file_content).success;
 }
 
+bool RWSInterface::getFile(const RWSClient::FileResource& resource, POCOClient::ContentSink& sink)
+{
+  return rws_client_.getFile(resource, sink).success;
+}
+
 bool RWSInterface::uploadFile(const RWSClient::FileResource& resource, const std::string& file_content)
 {
   return rws_client_.uploadFile(resource, file_content).success;
 }
 
+bool RWSInterface::uploadFile(const RWSClient::FileResource& resource, POCOClient::ContentSource& source)
+{
+  return rws_client_.uploadFile(resource, source).success;
+}
+
 bool RWSInterface::deleteFile(const RWSClient::FileResource& resource)
 {
   return rws_client_.deleteFile(resource).success;
@@ -995,11 +1005,22 @@ bool RWSInterface::deleteFile(const RWSClient::FileResource& resource)
 
 bool RWSInterface::startSubscription (const RWSClient::SubscriptionResources& resources)
 {
+  // A shared client has a single subscription, which would be taken over from (or by) the other sharing interfaces.
+  if (rws_client_handle_.shared())
+  {
+    return false;
+  }
+
   return rws_client_.startSubscription(resources).success;
 }
 
 bool RWSInterface::waitForSubscriptionEvent()
 {
+  if (rws_client_handle_.shared())
+  {
+    return false;
+  }
+
   RWSClient::RWSResult rws_result = rws_client_.waitForSubscriptionEvent();
 
   return (rws_result.success && !rws_result.p_xml_document.isNull());
@@ -1009,7 +1030,7 @@ bool RWSInterface::waitForSubscriptionEvent(Poco::AutoPtr<Poco::XML::Document>*
 {
   bool result = false;
 
-  if (p_xml_document)
+  if (p_xml_document && !rws_client_handle_.shared())
   {
     RWSClient::RWSResult rws_result = rws_client_.waitForSubscriptionEvent();
 
@@ -1025,12 +1046,20 @@ bool RWSInterface::waitForSubscriptionEvent(Poco::AutoPtr<Poco::XML::Document>*
 
 bool RWSInterface::endSubscription()
 {
+  if (rws_client_handle_.shared())
+  {
+    return false;
+  }
+
   return rws_client_.endSubscription().success;
 }
 
 void RWSInterface::forceCloseSubscription()
 {
-  rws_client_.webSocketShutdown();
+  if (!rws_client_handle_.shared())
+  {
+    rws_client_.webSocketShutdown();
+  }
 }
 
 bool RWSInterface::registerLocalUser(const std::string& username,
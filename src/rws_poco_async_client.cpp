@@ -0,0 +1,1206 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+
+#include "Poco/Base64Encoder.h"
+#include "Poco/NObserver.h"
+#include "Poco/Net/HTTPCookie.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/WebSocket.h"
+#include "Poco/Random.h"
+
+#include "abb_librws/rws_poco_async_client.h"
+
+using namespace Poco;
+using namespace Poco::Net;
+
+namespace
+{
+/**
+ * \brief A function for storing (adding or updating) the cookies received in a HTTP response.
+ *
+ * \param response for the HTTP response.
+ * \param p_cookies for the cookie container.
+ */
+void storeCookies(const HTTPResponse& response, NameValueCollection* p_cookies)
+{
+  std::vector<HTTPCookie> temp_cookies;
+  response.getCookies(temp_cookies);
+
+  for (size_t i = 0; i < temp_cookies.size(); ++i)
+  {
+    if (p_cookies->find(temp_cookies[i].getName()) != p_cookies->end())
+    {
+      p_cookies->set(temp_cookies[i].getName(), temp_cookies[i].getValue());
+    }
+    else
+    {
+      p_cookies->add(temp_cookies[i].getName(), temp_cookies[i].getValue());
+    }
+  }
+}
+
+/**
+ * \brief Maximum size of a response body that is buffered in memory.
+ */
+const Poco::UInt64 MAX_BUFFERED_CONTENT_SIZE = 256 * 1024 * 1024;
+
+/**
+ * \brief An enum for the outcome of decoding a (possibly partially received) chunked HTTP body.
+ */
+enum ChunkedBodyStatus
+{
+  CHUNKED_BODY_INCOMPLETE, ///< More bytes are needed.
+  CHUNKED_BODY_COMPLETE,   ///< The body has been completely received and decoded.
+  CHUNKED_BODY_INVALID     ///< The body is malformed, or too large to buffer.
+};
+
+/**
+ * \brief A function for parsing the size line of a chunk (in chunked transfer encoding).
+ *
+ * \param p_line for the start of the line (the line must be terminated by a carriage return).
+ * \param p_size for storing the chunk's size.
+ *
+ * \return bool indicating if the line was a valid size line or not.
+ */
+bool parseChunkSize(const char* p_line, size_t* p_size)
+{
+  char* p_end = 0;
+
+  // Require a hexadecimal digit first, since strtoul would otherwise accept e.g. white space and signs.
+  if (!std::isxdigit(static_cast<unsigned char>(*p_line)))
+  {
+    return false;
+  }
+
+  errno = 0;
+  unsigned long size = std::strtoul(p_line, &p_end, 16);
+
+  // The size may only be followed by white space, chunk extensions (";...") and the carriage return.
+  if (errno == ERANGE || size > MAX_BUFFERED_CONTENT_SIZE ||
+      !(*p_end == '\r' || *p_end == ';' || *p_end == ' ' || *p_end == '\t'))
+  {
+    return false;
+  }
+
+  *p_size = static_cast<size_t>(size);
+
+  return true;
+}
+
+/**
+ * \brief A function for decoding a chunked HTTP body, if it has been completely received.
+ *
+ * \param input containing the received bytes.
+ * \param offset specifying where the body starts in the received bytes.
+ * \param p_body for storing the decoded body.
+ * \param p_end for storing where the body ends in the received bytes.
+ *
+ * \return ChunkedBodyStatus indicating if the body was complete, incomplete or invalid.
+ */
+ChunkedBodyStatus decodeChunkedBody(const std::string& input, size_t offset, std::string* p_body, size_t* p_end)
+{
+  p_body->clear();
+
+  while (true)
+  {
+    size_t line_end = input.find("\r\n", offset);
+
+    if (line_end == std::string::npos)
+    {
+      return CHUNKED_BODY_INCOMPLETE;
+    }
+
+    size_t chunk_size = 0;
+
+    if (!parseChunkSize(input.c_str() + offset, &chunk_size))
+    {
+      return CHUNKED_BODY_INVALID;
+    }
+
+    offset = line_end + 2;
+
+    if (chunk_size == 0)
+    {
+      // Skip any trailer fields, up to and including the terminating empty line.
+      while (input.compare(offset, 2, "\r\n") != 0)
+      {
+        line_end = input.find("\r\n", offset);
+
+        if (line_end == std::string::npos)
+        {
+          return CHUNKED_BODY_INCOMPLETE;
+        }
+
+        offset = line_end + 2;
+      }
+
+      *p_end = offset + 2;
+      return CHUNKED_BODY_COMPLETE;
+    }
+
+    if (chunk_size > MAX_BUFFERED_CONTENT_SIZE - p_body->size())
+    {
+      return CHUNKED_BODY_INVALID;
+    }
+
+    if (input.size() - offset < chunk_size + 2)
+    {
+      return CHUNKED_BODY_INCOMPLETE;
+    }
+
+    if (input.compare(offset + chunk_size, 2, "\r\n") != 0)
+    {
+      return CHUNKED_BODY_INVALID;
+    }
+
+    p_body->append(input, offset, chunk_size);
+    offset += chunk_size + 2;
+  }
+}
+
+/**
+ * \brief A function for generating a random number, which is safe to call from several threads.
+ *
+ * Poco::Random is not thread-safe, so the shared generator is guarded by a mutex.
+ *
+ * \return Poco::UInt32 containing the random number.
+ */
+Poco::UInt32 nextRandom()
+{
+  static FastMutex mutex;
+  static Random random;
+  FastMutex::ScopedLock lock(mutex);
+
+  return random.next();
+}
+
+/**
+ * \brief A function for constructing a (masked) client WebSocket frame.
+ *
+ * \param flags for the frame's flags (FIN bit and opcode).
+ * \param payload for the frame's payload.
+ *
+ * \return std::string containing the frame.
+ */
+std::string constructClientFrame(const int flags, const std::string& payload)
+{
+  std::string frame;
+  Poco::UInt32 mask_key = nextRandom();
+  char mask[4] = {static_cast<char>(mask_key >> 24),
+                  static_cast<char>(mask_key >> 16),
+                  static_cast<char>(mask_key >> 8),
+                  static_cast<char>(mask_key)};
+
+  frame.push_back(static_cast<char>(flags));
+
+  if (payload.size() < 126)
+  {
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+  }
+  else
+  {
+    frame.push_back(static_cast<char>(0x80 | 126));
+    frame.push_back(static_cast<char>((payload.size() >> 8) & 0xFF));
+    frame.push_back(static_cast<char>(payload.size() & 0xFF));
+  }
+
+  frame.append(mask, sizeof(mask));
+
+  for (size_t i = 0; i < payload.size(); ++i)
+  {
+    frame.push_back(payload[i] ^ mask[i % 4]);
+  }
+
+  return frame;
+}
+
+/**
+ * \brief A function for creating a WebSocket handshake key.
+ *
+ * \return std::string containing the key.
+ */
+std::string createWebSocketKey()
+{
+  std::ostringstream ss;
+  Base64Encoder encoder(ss);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    Poco::UInt32 value = nextRandom();
+    encoder.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  encoder.close();
+
+  return ss.str();
+}
+}
+
+namespace abb
+{
+namespace rws
+{
+/***********************************************************************************************************************
+ * Class definitions: POCOEventLoop
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOEventLoop::POCOEventLoop(const size_t number_of_threads)
+:
+next_reactor_(0),
+running_(false),
+timeout_checks_runnable_(*this, &POCOEventLoop::runTimeoutChecks)
+{
+  for (size_t i = 0; i < std::max(number_of_threads, (size_t) 1); ++i)
+  {
+    reactors_.push_back(new SocketReactor(Timespan(POLL_TIMEOUT)));
+    threads_.push_back(new Thread());
+  }
+}
+
+POCOEventLoop::~POCOEventLoop()
+{
+  stop();
+}
+
+void POCOEventLoop::start()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (!running_)
+  {
+    for (size_t i = 0; i < threads_.size(); ++i)
+    {
+      threads_[i]->start(*reactors_[i]);
+    }
+
+    timeout_checks_stop_event_.reset();
+    timeout_checks_thread_.start(timeout_checks_runnable_);
+    running_ = true;
+  }
+}
+
+void POCOEventLoop::stop()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (running_)
+  {
+    timeout_checks_stop_event_.set();
+    timeout_checks_thread_.join();
+
+    for (size_t i = 0; i < reactors_.size(); ++i)
+    {
+      reactors_[i]->stop();
+    }
+
+    for (size_t i = 0; i < threads_.size(); ++i)
+    {
+      threads_[i]->join();
+    }
+
+    running_ = false;
+  }
+}
+
+SocketReactor& POCOEventLoop::assignReactor()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  return *reactors_[next_reactor_++ % reactors_.size()];
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void POCOEventLoop::addClient(POCOAsyncClient* p_client)
+{
+  ScopedLock<Mutex> lock(clients_mutex_);
+
+  clients_.insert(p_client);
+}
+
+void POCOEventLoop::removeClient(POCOAsyncClient* p_client)
+{
+  ScopedLock<Mutex> lock(clients_mutex_);
+
+  clients_.erase(p_client);
+}
+
+void POCOEventLoop::runTimeoutChecks()
+{
+  while (!timeout_checks_stop_event_.tryWait(TIMEOUT_CHECK_INTERVAL))
+  {
+    std::vector<POCOAsyncClient*> clients;
+
+    // Enter the callbacks while the set is locked, so that a client can not be destroyed in between.
+    {
+      ScopedLock<Mutex> lock(clients_mutex_);
+
+      for (std::set<POCOAsyncClient*>::iterator i = clients_.begin(); i != clients_.end(); ++i)
+      {
+        if ((*i)->enterCallback())
+        {
+          clients.push_back(*i);
+        }
+      }
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+      clients[i]->onTimeoutCheck();
+      clients[i]->leaveCallback();
+    }
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOAsyncClient
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOAsyncClient::POCOAsyncClient(POCOEventLoop& event_loop,
+                                 const std::string& ip_address,
+                                 const Poco::UInt16 port,
+                                 const std::string& username,
+                                 const std::string& password,
+                                 Listener* p_listener)
+:
+callbacks_(0),
+closing_(false),
+event_loop_(event_loop),
+reactor_(event_loop.assignReactor()),
+ip_address_(ip_address),
+port_(port),
+http_credentials_(username, password),
+p_listener_(p_listener),
+http_timeout_(DEFAULT_HTTP_TIMEOUT),
+last_id_(0)
+{
+  event_loop_.addClient(this);
+}
+
+POCOAsyncClient::~POCOAsyncClient()
+{
+  event_loop_.removeClient(this);
+
+  {
+    ScopedLock<Mutex> lock(callback_mutex_);
+    closing_ = true;
+  }
+
+  // Closing unregisters the sockets from the reactor, so no new notifications are dispatched to the client.
+  close();
+
+  // Wait for callbacks in progress (e.g. a reactor notification, or a timeout check) to finish.
+  ScopedLock<Mutex> lock(callback_mutex_);
+
+  while (callbacks_ > 0)
+  {
+    callback_condition_.wait(callback_mutex_);
+  }
+}
+
+Poco::UInt64 POCOAsyncClient::httpGet(const std::string& uri)
+{
+  return queueRequest(&http_channel_, HTTPRequest::HTTP_GET, uri, "");
+}
+
+Poco::UInt64 POCOAsyncClient::httpPost(const std::string& uri, const std::string& content)
+{
+  return queueRequest(&http_channel_, HTTPRequest::HTTP_POST, uri, content);
+}
+
+Poco::UInt64 POCOAsyncClient::httpPut(const std::string& uri, const std::string& content)
+{
+  return queueRequest(&http_channel_, HTTPRequest::HTTP_PUT, uri, content);
+}
+
+Poco::UInt64 POCOAsyncClient::httpDelete(const std::string& uri)
+{
+  return queueRequest(&http_channel_, HTTPRequest::HTTP_DELETE, uri, "");
+}
+
+Poco::UInt64 POCOAsyncClient::webSocketConnect(const std::string& uri, const std::string& protocol)
+{
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    closeChannel(&websocket_channel_,
+                 POCOClient::POCOResult::EXCEPTION_POCO_WEBSOCKET,
+                 "WebSocket replaced",
+                 &deliveries);
+  }
+
+  deliver(deliveries);
+
+  return queueRequest(&websocket_channel_, HTTPRequest::HTTP_GET, uri, "", protocol);
+}
+
+void POCOAsyncClient::webSocketShutdown()
+{
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    closeChannel(&websocket_channel_,
+                 POCOClient::POCOResult::EXCEPTION_POCO_WEBSOCKET,
+                 "WebSocket shut down",
+                 &deliveries);
+  }
+
+  deliver(deliveries);
+}
+
+bool POCOAsyncClient::webSocketExist()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  return websocket_channel_.websocket;
+}
+
+void POCOAsyncClient::setHTTPTimeout(const Poco::Int64 timeout)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  http_timeout_ = timeout;
+}
+
+void POCOAsyncClient::setTransportOptions(const POCOClient::TransportOptions& options)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  transport_options_ = options;
+}
+
+void POCOAsyncClient::close()
+{
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    closeChannel(&http_channel_, POCOClient::POCOResult::EXCEPTION_POCO_NET, "Client closed", &deliveries);
+    closeChannel(&websocket_channel_, POCOClient::POCOResult::EXCEPTION_POCO_NET, "Client closed", &deliveries);
+  }
+
+  deliver(deliveries);
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+Poco::UInt64 POCOAsyncClient::queueRequest(Channel* p_channel,
+                                           const std::string& method,
+                                           const std::string& uri,
+                                           const std::string& content,
+                                           const std::string& websocket_protocol)
+{
+  std::vector<Delivery> deliveries;
+  Poco::UInt64 id = 0;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+
+    PendingRequest pending;
+    pending.id = id = ++last_id_;
+    pending.content = content;
+    pending.websocket = !websocket_protocol.empty();
+    pending.p_request = new HTTPRequest(method, uri, HTTPRequest::HTTP_1_1);
+    pending.p_request->setHost(ip_address_, port_);
+
+    if (pending.websocket)
+    {
+      pending.p_request->set("Connection", "Upgrade");
+      pending.p_request->set("Upgrade", "websocket");
+      pending.p_request->set("Sec-WebSocket-Version", "13");
+      pending.p_request->set("Sec-WebSocket-Key", createWebSocketKey());
+      pending.p_request->set("Sec-WebSocket-Protocol", websocket_protocol);
+    }
+    else
+    {
+      pending.p_request->setKeepAlive(true);
+      pending.p_request->setContentLength(content.length());
+      if (method == HTTPRequest::HTTP_POST || !content.empty())
+      {
+        pending.p_request->setContentType("application/x-www-form-urlencoded");
+      }
+    }
+
+    p_channel->queue.push_back(pending);
+    startNext(p_channel, &deliveries);
+  }
+
+  deliver(deliveries);
+
+  return id;
+}
+
+void POCOAsyncClient::startNext(Channel* p_channel, std::vector<Delivery>* p_deliveries)
+{
+  if (p_channel->busy || p_channel->queue.empty())
+  {
+    return;
+  }
+
+  try
+  {
+    if (!p_channel->open)
+    {
+      p_channel->socket = StreamSocket();
+      p_channel->socket.connectNB(SocketAddress(ip_address_, port_));
+      transport_options_.applyTo(p_channel->socket);
+      p_channel->open = true;
+      p_channel->connected = false;
+      p_channel->writing = true;
+
+      reactor_.addEventHandler(p_channel->socket,
+                               NObserver<POCOAsyncClient, ReadableNotification>(*this, &POCOAsyncClient::onReadable));
+      reactor_.addEventHandler(p_channel->socket,
+                               NObserver<POCOAsyncClient, WritableNotification>(*this, &POCOAsyncClient::onWritable));
+      reactor_.addEventHandler(p_channel->socket,
+                               NObserver<POCOAsyncClient, ErrorNotification>(*this, &POCOAsyncClient::onError));
+    }
+
+    // Serialize the request, with the latest cookies.
+    PendingRequest& pending = p_channel->queue.front();
+    pending.p_request->erase(HTTPRequest::COOKIE);
+    if (!cookies_.empty())
+    {
+      pending.p_request->setCookies(cookies_);
+    }
+
+    std::ostringstream ss;
+    pending.p_request->write(ss);
+    ss << pending.content;
+    p_channel->output += ss.str();
+    p_channel->busy = true;
+    p_channel->request_start.update();
+    transport_options_.rearm(p_channel->socket);
+
+    if (p_channel->connected)
+    {
+      flushOutput(p_channel);
+    }
+  }
+  catch (Poco::Exception& e)
+  {
+    closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET, e.displayText(), p_deliveries);
+  }
+}
+
+void POCOAsyncClient::flushOutput(Channel* p_channel)
+{
+  while (!p_channel->output.empty())
+  {
+    int number_of_bytes_sent = p_channel->socket.sendBytes(p_channel->output.data(), (int) p_channel->output.size());
+
+    if (number_of_bytes_sent <= 0)
+    {
+      break;
+    }
+
+    p_channel->output.erase(0, number_of_bytes_sent);
+  }
+
+  // Listen for writability while there is something left to send. The listening is stopped by the writable callback
+  // (on the reactor's thread), since an observer can not be removed while holding the mutex from other threads.
+  if (!p_channel->output.empty() && !p_channel->writing)
+  {
+    reactor_.addEventHandler(p_channel->socket,
+                             NObserver<POCOAsyncClient, WritableNotification>(*this, &POCOAsyncClient::onWritable));
+    p_channel->writing = true;
+  }
+}
+
+void POCOAsyncClient::processHTTPInput(Channel* p_channel,
+                                       const bool connection_closed,
+                                       std::vector<Delivery>* p_deliveries)
+{
+  while (p_channel->busy && !p_channel->queue.empty())
+  {
+    size_t header_end = p_channel->input.find("\r\n\r\n");
+
+    if (header_end == std::string::npos)
+    {
+      return;
+    }
+
+    size_t body_start = header_end + 4;
+    Poco::SharedPtr<HTTPResponse> p_response(new HTTPResponse());
+    HTTPResponse& response = *p_response;
+
+    try
+    {
+      std::istringstream header(p_channel->input.substr(0, body_start));
+      response.read(header);
+    }
+    catch (Poco::Exception& e)
+    {
+      closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET, e.displayText(), p_deliveries);
+      return;
+    }
+
+    PendingRequest& pending = p_channel->queue.front();
+    bool upgraded = (pending.websocket && response.getStatus() == HTTPResponse::HTTP_SWITCHING_PROTOCOLS);
+    bool keep_alive = response.getKeepAlive();
+    SharedBuffer body;
+    std::string* p_body = body.reset();
+    size_t body_end = body_start;
+
+    // Skip any interim responses.
+    if (!upgraded && response.getStatus() < HTTPResponse::HTTP_OK)
+    {
+      p_channel->input.erase(0, body_start);
+      continue;
+    }
+
+    if (upgraded ||
+        response.getStatus() == HTTPResponse::HTTP_NO_CONTENT ||
+        response.getStatus() == HTTPResponse::HTTP_NOT_MODIFIED)
+    {
+      // No body.
+    }
+    else if (response.getChunkedTransferEncoding())
+    {
+      ChunkedBodyStatus status = decodeChunkedBody(p_channel->input, body_start, p_body, &body_end);
+
+      if (status == CHUNKED_BODY_INVALID)
+      {
+        closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET,
+                     "Malformed or too large chunked response body", p_deliveries);
+        return;
+      }
+
+      if (status == CHUNKED_BODY_INCOMPLETE)
+      {
+        return;
+      }
+    }
+    else if (response.hasContentLength())
+    {
+      if (response.getContentLength64() < 0 ||
+          static_cast<Poco::UInt64>(response.getContentLength64()) > MAX_BUFFERED_CONTENT_SIZE)
+      {
+        closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET,
+                     "Response content is too large to buffer", p_deliveries);
+        return;
+      }
+
+      size_t content_length = static_cast<size_t>(response.getContentLength64());
+
+      if (p_channel->input.size() - body_start < content_length)
+      {
+        return;
+      }
+
+      p_body->assign(p_channel->input, body_start, content_length);
+      body_end = body_start + content_length;
+    }
+    else if (connection_closed)
+    {
+      p_body->assign(p_channel->input, body_start, std::string::npos);
+      body_end = p_channel->input.size();
+      keep_alive = false;
+    }
+    else
+    {
+      // The body is delimited by the server closing the connection.
+      return;
+    }
+
+    p_channel->input.erase(0, body_end);
+    p_channel->busy = false;
+    storeCookies(response, &cookies_);
+
+    // Check if the request was unauthorized, if so add credentials and send it again.
+    if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED && !pending.authenticated)
+    {
+      cookies_.clear();
+      http_credentials_.authenticate(*pending.p_request, response);
+      pending.authenticated = true;
+
+      if (!keep_alive)
+      {
+        resetSocket(p_channel);
+      }
+
+      startNext(p_channel, p_deliveries);
+      continue;
+    }
+
+    Delivery delivery;
+    delivery.id = pending.id;
+    delivery.result.addHTTPRequestInfo(*pending.p_request, pending.content);
+    delivery.result.addHTTPResponseInfo(p_response, body);
+    delivery.result.status = POCOClient::POCOResult::OK;
+    p_deliveries->push_back(delivery);
+
+    bool websocket_handshake = pending.websocket;
+    p_channel->queue.pop_front();
+
+    if (upgraded)
+    {
+      p_channel->websocket = true;
+      processWebSocketInput(p_deliveries);
+      return;
+    }
+
+    if (websocket_handshake || !keep_alive)
+    {
+      resetSocket(p_channel);
+    }
+
+    startNext(p_channel, p_deliveries);
+  }
+}
+
+void POCOAsyncClient::processWebSocketInput(std::vector<Delivery>* p_deliveries)
+{
+  Channel* p_channel = &websocket_channel_;
+
+  while (p_channel->websocket && p_channel->input.size() >= 2)
+  {
+    const unsigned char* p_bytes = reinterpret_cast<const unsigned char*>(p_channel->input.data());
+    int flags = p_bytes[0];
+    bool masked = (p_bytes[1] & 0x80) != 0;
+    Poco::UInt64 payload_length = p_bytes[1] & 0x7F;
+    size_t header_length = 2;
+
+    if (payload_length == 126)
+    {
+      if (p_channel->input.size() < 4)
+      {
+        return;
+      }
+
+      payload_length = (p_bytes[2] << 8) | p_bytes[3];
+      header_length = 4;
+    }
+    else if (payload_length == 127)
+    {
+      if (p_channel->input.size() < 10)
+      {
+        return;
+      }
+
+      payload_length = 0;
+      for (size_t i = 2; i < 10; ++i)
+      {
+        payload_length = (payload_length << 8) | p_bytes[i];
+      }
+      header_length = 10;
+    }
+
+    if (masked)
+    {
+      header_length += 4;
+    }
+
+    if (p_channel->input.size() < header_length + payload_length)
+    {
+      return;
+    }
+
+    std::string content = p_channel->input.substr(header_length, static_cast<size_t>(payload_length));
+
+    if (masked)
+    {
+      for (size_t i = 0; i < content.size(); ++i)
+      {
+        content[i] ^= p_channel->input[header_length - 4 + i % 4];
+      }
+    }
+
+    p_channel->input.erase(0, header_length + static_cast<size_t>(payload_length));
+
+    // Check for ping frame, and if so reply with a pong frame.
+    if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING)
+    {
+      p_channel->output += constructClientFrame(WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG, content);
+      flushOutput(p_channel);
+      continue;
+    }
+
+    bool closing = ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_CLOSE);
+
+    // Do not pass content of a closing frame to end user, according to "The WebSocket Protocol" RFC6455.
+    if (closing)
+    {
+      content.clear();
+    }
+
+    Delivery delivery;
+    delivery.websocket_frame = true;
+    delivery.result.addWebSocketFrameInfo(flags, content);
+    delivery.result.status = POCOClient::POCOResult::OK;
+    p_deliveries->push_back(delivery);
+
+    if (closing)
+    {
+      resetSocket(p_channel);
+      p_channel->websocket = false;
+    }
+  }
+}
+
+void POCOAsyncClient::resetSocket(Channel* p_channel)
+{
+  if (p_channel->open)
+  {
+    detached_sockets_.push_back(p_channel->socket);
+    p_channel->socket = StreamSocket();
+  }
+
+  p_channel->open = false;
+  p_channel->connected = false;
+  p_channel->writing = false;
+  p_channel->busy = false;
+  p_channel->input.clear();
+  p_channel->output.clear();
+}
+
+void POCOAsyncClient::closeChannel(Channel* p_channel,
+                                   const POCOClient::POCOResult::GeneralStatus status,
+                                   const std::string& message,
+                                   std::vector<Delivery>* p_deliveries)
+{
+  resetSocket(p_channel);
+
+  if (p_channel->websocket)
+  {
+    Delivery delivery;
+    delivery.websocket_frame = true;
+    delivery.result.status = status;
+    delivery.result.exception_message = message;
+    p_deliveries->push_back(delivery);
+
+    p_channel->websocket = false;
+  }
+
+  for (size_t i = 0; i < p_channel->queue.size(); ++i)
+  {
+    Delivery delivery;
+    delivery.id = p_channel->queue[i].id;
+    delivery.result.addHTTPRequestInfo(*p_channel->queue[i].p_request, p_channel->queue[i].content);
+    delivery.result.status = status;
+    delivery.result.exception_message = message;
+    p_deliveries->push_back(delivery);
+  }
+
+  p_channel->queue.clear();
+
+  if (p_channel == &http_channel_)
+  {
+    cookies_.clear();
+  }
+}
+
+void POCOAsyncClient::checkTimeouts(std::vector<Delivery>* p_deliveries)
+{
+  Channel* channels[] = {&http_channel_, &websocket_channel_};
+
+  for (size_t i = 0; i < sizeof(channels) / sizeof(channels[0]); ++i)
+  {
+    if (channels[i]->busy && channels[i]->request_start.isElapsed(http_timeout_))
+    {
+      closeChannel(channels[i], POCOClient::POCOResult::EXCEPTION_POCO_TIMEOUT, "Timeout", p_deliveries);
+    }
+  }
+}
+
+void POCOAsyncClient::releaseSockets()
+{
+  std::vector<StreamSocket> sockets;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    sockets.swap(detached_sockets_);
+  }
+
+  for (size_t i = 0; i < sockets.size(); ++i)
+  {
+    reactor_.removeEventHandler(sockets[i],
+                                NObserver<POCOAsyncClient, ReadableNotification>(*this, &POCOAsyncClient::onReadable));
+    reactor_.removeEventHandler(sockets[i],
+                                NObserver<POCOAsyncClient, WritableNotification>(*this, &POCOAsyncClient::onWritable));
+    reactor_.removeEventHandler(sockets[i],
+                                NObserver<POCOAsyncClient, ErrorNotification>(*this, &POCOAsyncClient::onError));
+
+    try
+    {
+      sockets[i].close();
+    }
+    catch (Poco::Exception&) {}
+  }
+}
+
+void POCOAsyncClient::deliver(const std::vector<Delivery>& deliveries)
+{
+  releaseSockets();
+
+  if (p_listener_)
+  {
+    for (size_t i = 0; i < deliveries.size(); ++i)
+    {
+      if (deliveries[i].websocket_frame)
+      {
+        p_listener_->onWebSocketFrame(deliveries[i].result);
+      }
+      else
+      {
+        p_listener_->onHTTPResult(deliveries[i].id, deliveries[i].result);
+      }
+    }
+  }
+}
+
+bool POCOAsyncClient::enterCallback()
+{
+  ScopedLock<Mutex> lock(callback_mutex_);
+
+  if (closing_)
+  {
+    return false;
+  }
+
+  ++callbacks_;
+  return true;
+}
+
+void POCOAsyncClient::leaveCallback()
+{
+  ScopedLock<Mutex> lock(callback_mutex_);
+
+  --callbacks_;
+  callback_condition_.broadcast();
+}
+
+void POCOAsyncClient::onTimeoutCheck()
+{
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    checkTimeouts(&deliveries);
+  }
+
+  deliver(deliveries);
+}
+
+POCOAsyncClient::Channel* POCOAsyncClient::findChannel(const Socket& socket)
+{
+  Channel* p_channel = 0;
+
+  if (http_channel_.open && http_channel_.socket == socket)
+  {
+    p_channel = &http_channel_;
+  }
+  else if (websocket_channel_.open && websocket_channel_.socket == socket)
+  {
+    p_channel = &websocket_channel_;
+  }
+
+  return p_channel;
+}
+
+void POCOAsyncClient::onReadable(const AutoPtr<ReadableNotification>& p_notification)
+{
+  CallbackScope callback_scope(*this);
+  if (!callback_scope.entered())
+  {
+    return;
+  }
+
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    Channel* p_channel = findChannel(p_notification->socket());
+
+    if (p_channel)
+    {
+      bool connection_closed = false;
+
+      try
+      {
+        char buffer[BUFFER_SIZE];
+        int number_of_bytes_received = p_channel->socket.receiveBytes(buffer, sizeof(buffer));
+
+        if (number_of_bytes_received > 0)
+        {
+          p_channel->input.append(buffer, number_of_bytes_received);
+        }
+        else if (number_of_bytes_received == 0)
+        {
+          connection_closed = true;
+        }
+      }
+      catch (Poco::Exception& e)
+      {
+        closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET, e.displayText(), &deliveries);
+        p_channel = 0;
+      }
+
+      if (p_channel && p_channel->websocket)
+      {
+        processWebSocketInput(&deliveries);
+
+        if (connection_closed && p_channel->websocket)
+        {
+          closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_WEBSOCKET, "Connection closed", &deliveries);
+        }
+      }
+      else if (p_channel)
+      {
+        processHTTPInput(p_channel, connection_closed, &deliveries);
+
+        if (connection_closed && p_channel->open)
+        {
+          if (p_channel->busy)
+          {
+            closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET, "Connection closed", &deliveries);
+          }
+          else
+          {
+            resetSocket(p_channel);
+          }
+        }
+      }
+    }
+
+    checkTimeouts(&deliveries);
+  }
+
+  deliver(deliveries);
+}
+
+void POCOAsyncClient::onWritable(const AutoPtr<WritableNotification>& p_notification)
+{
+  CallbackScope callback_scope(*this);
+  if (!callback_scope.entered())
+  {
+    return;
+  }
+
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    Channel* p_channel = findChannel(p_notification->socket());
+
+    if (p_channel)
+    {
+      try
+      {
+        if (!p_channel->connected)
+        {
+          int error = p_channel->socket.impl()->socketError();
+
+          if (error != 0)
+          {
+            throw NetException("Connection failed", error);
+          }
+
+          p_channel->connected = true;
+        }
+
+        flushOutput(p_channel);
+
+        // Stop listening for writability when everything has been sent (safe here, on the reactor's thread).
+        if (p_channel->output.empty() && p_channel->writing)
+        {
+          reactor_.removeEventHandler(p_channel->socket,
+                                      NObserver<POCOAsyncClient, WritableNotification>(*this,
+                                                                                       &POCOAsyncClient::onWritable));
+          p_channel->writing = false;
+        }
+      }
+      catch (Poco::Exception& e)
+      {
+        closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET, e.displayText(), &deliveries);
+      }
+    }
+
+    checkTimeouts(&deliveries);
+  }
+
+  deliver(deliveries);
+}
+
+void POCOAsyncClient::onError(const AutoPtr<ErrorNotification>& p_notification)
+{
+  CallbackScope callback_scope(*this);
+  if (!callback_scope.entered())
+  {
+    return;
+  }
+
+  std::vector<Delivery> deliveries;
+
+  {
+    ScopedLock<Mutex> lock(mutex_);
+    Channel* p_channel = findChannel(p_notification->socket());
+
+    if (p_channel)
+    {
+      closeChannel(p_channel, POCOClient::POCOResult::EXCEPTION_POCO_NET, "Socket error", &deliveries);
+    }
+  }
+
+  deliver(deliveries);
+}
+
+} // end namespace rws
+} // end namespace abb
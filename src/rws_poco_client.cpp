@@ -34,492 +34,2278 @@
  ***********************************************************************************************************************
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <sstream>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#include "Poco/DeflatingStream.h"
+#include "Poco/InflatingStream.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/NetException.h"
+#include "Poco/Net/SocketDefs.h"
+#include "Poco/Net/SocketStream.h"
 #include "Poco/StreamCopier.h"
+#include "Poco/String.h"
+
+#if defined(ABB_LIBRWS_WITH_NETSSL)
+#include "Poco/Net/Context.h"
+#include "Poco/Net/HTTPSClientSession.h"
+#endif
 
 #include "abb_librws/rws_poco_client.h"
 
 using namespace Poco;
 using namespace Poco::Net;
 
-namespace abb
-{
-namespace rws
+namespace
 {
-/***********************************************************************************************************************
- * Struct definitions: POCOClient::POCOResult
+/**
+ * \brief Maximum size of a response content that is buffered in memory (larger contents must be streamed to a sink).
  */
+const Poco::UInt64 MAX_BUFFERED_CONTENT_SIZE = 256 * 1024 * 1024;
 
-/************************************************************
- * Primary methods
+/**
+ * \brief A function for setting a socket option, while ignoring options that the socket or platform rejects.
+ *
+ * \param socket for the socket.
+ * \param level for the option's protocol level.
+ * \param option for the option.
+ * \param value for the option's value.
  */
-
-void POCOClient::POCOResult::addHTTPRequestInfo(const Poco::Net::HTTPRequest& request,
-                                                const std::string& request_content)
+void trySetOption(StreamSocket& socket, const int level, const int option, const int value)
 {
-  poco_info.http.request.method = request.getMethod();
-  poco_info.http.request.uri = request.getURI();
-  poco_info.http.request.content = request_content;
+  try
+  {
+    socket.setOption(level, option, value);
+  }
+  catch (Poco::Exception&)
+  {
+    // The option is not supported (e.g. IPV6_TCLASS on an IPv4 socket), so it is skipped.
+  }
 }
 
-void POCOClient::POCOResult::addHTTPResponseInfo(const Poco::Net::HTTPResponse& response,
-                                                 const std::string& response_content)
+/**
+ * \brief A function for finding the compression format of a HTTP response's content.
+ *
+ * \param response for the HTTP response.
+ * \param p_type for storing the compression format.
+ *
+ * \return bool indicating if the content is compressed (with a supported encoding) or not.
+ */
+bool findContentCompression(const HTTPResponse& response, InflatingStreamBuf::StreamType* p_type)
 {
-  std::string header_info;
+  std::string encoding = Poco::toLower(Poco::trim(response.get("Content-Encoding", "")));
 
-  for (HTTPResponse::ConstIterator i = response.begin(); i != response.end(); ++i)
+  if (encoding == "gzip" || encoding == "x-gzip")
   {
-    header_info += i->first + "=" + i->second + "\n";
+    *p_type = InflatingStreamBuf::STREAM_GZIP;
+    return true;
   }
 
-  poco_info.http.response.status = response.getStatus();
-  poco_info.http.response.header_info = header_info;
-  poco_info.http.response.content = response_content;
+  if (encoding == "deflate")
+  {
+    *p_type = InflatingStreamBuf::STREAM_ZLIB;
+    return true;
+  }
+
+  return false;
 }
 
-void POCOClient::POCOResult::addWebSocketFrameInfo(const int flags,
-                                                   const std::string& frame_content)
+/**
+ * \brief A function for compressing a HTTP request's content (with gzip).
+ *
+ * \param content for the content to compress.
+ * \param p_output for storing the compressed content.
+ */
+void compressContent(const std::string& content, std::string* p_output)
 {
-  poco_info.websocket.flags = flags;
-  poco_info.websocket.frame_content = frame_content;
+  std::ostringstream compressed;
+  DeflatingOutputStream deflater(compressed, DeflatingStreamBuf::STREAM_GZIP);
+  deflater << content;
+  deflater.close();
+  *p_output = compressed.str();
 }
 
-/************************************************************
- * Auxiliary methods
+/**
+ * \brief A function for streaming a content to a sink, in fixed-size chunks.
+ *
+ * \param input for the content's input stream.
+ * \param total for the content's total size [bytes], or -1 if it is not known.
+ * \param chunk_size for the chunk size [bytes].
+ * \param sink for the sink.
+ *
+ * \throw Poco::IOException if the sink aborts the transfer.
  */
-
-std::string POCOClient::POCOResult::mapGeneralStatus() const
+void streamContent(std::istream& input,
+                   const Poco::Int64 total,
+                   const size_t chunk_size,
+                   POCOClient::ContentSink& sink)
 {
-  std::string result;
+  std::vector<char> chunk(chunk_size);
+  Poco::UInt64 transferred = 0;
 
-  switch (status)
+  sink.onProgress(transferred, total);
+
+  while (input.read(&chunk[0], chunk.size()) || input.gcount() > 0)
   {
-    case POCOResult::UNKNOWN:
-      result = "UNKNOWN";
-    break;
+    size_t size = static_cast<size_t>(input.gcount());
 
-    case POCOResult::OK:
-      result = "OK";
-    break;
+    if (!sink.write(&chunk[0], size))
+    {
+      throw Poco::IOException("Content transfer aborted by the sink");
+    }
 
-    case POCOResult::WEBSOCKET_NOT_ALLOCATED:
-      result = "WEBSOCKET_NOT_ALLOCATED";
-    break;
+    transferred += size;
+    sink.onProgress(transferred, total);
+  }
+}
 
-    case POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT:
-      result = "EXCEPTION_POCO_INVALID_ARGUMENT";
-    break;
+/**
+ * \brief A content sink that forwards to another sink, while keeping track of if any content has been forwarded.
+ */
+class TrackingSink : public POCOClient::ContentSink
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param p_sink for the sink to forward to.
+   */
+  TrackingSink(POCOClient::ContentSink* p_sink) : p_sink_(p_sink), started_(false) {}
+
+  /**
+   * \brief A method for forwarding a chunk of the content.
+   *
+   * \param data for the chunk's data.
+   * \param size for the chunk's size [bytes].
+   *
+   * \return bool indicating if the transfer should continue or not.
+   */
+  bool write(const char* data, const size_t size)
+  {
+    started_ = true;
+    return p_sink_->write(data, size);
+  }
 
-    case POCOResult::EXCEPTION_POCO_TIMEOUT:
-      result = "EXCEPTION_POCO_TIMEOUT";
-    break;
+  /**
+   * \brief A method for forwarding the transfer's progress.
+   *
+   * \param transferred for the number of bytes transferred so far.
+   * \param total for the total number of bytes, or -1 if it is not known in advance.
+   */
+  void onProgress(const Poco::UInt64 transferred, const Poco::Int64 total)
+  {
+    p_sink_->onProgress(transferred, total);
+  }
 
-    case POCOResult::EXCEPTION_POCO_NET:
-      result = "EXCEPTION_POCO_NET";
-    break;
+  /**
+   * \brief A method for checking if any content has been forwarded.
+   *
+   * \return bool indicating if any content has been forwarded or not.
+   */
+  bool started() const { return started_; }
+
+private:
+  /**
+   * \brief The sink to forward to.
+   */
+  POCOClient::ContentSink* p_sink_;
+
+  /**
+   * \brief Flag indicating if any content has been forwarded.
+   */
+  bool started_;
+};
+
+/**
+ * \brief A class for unlocking an already locked mutex, when the scope is left.
+ */
+class AdoptedLock
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param mutex for the (locked) mutex.
+   */
+  explicit AdoptedLock(Mutex& mutex) : mutex_(mutex) {}
+
+  /**
+   * \brief A destructor, which unlocks the mutex.
+   */
+  ~AdoptedLock() { mutex_.unlock(); }
+
+private:
+  AdoptedLock(const AdoptedLock&);
+  AdoptedLock& operator=(const AdoptedLock&);
+
+  /**
+   * \brief The mutex.
+   */
+  Mutex& mutex_;
+};
+
+/**
+ * \brief A function for parsing the size line of a chunk (in chunked transfer encoding).
+ *
+ * \param line for the line (possibly including chunk extensions and the line's carriage return).
+ * \param p_size for storing the chunk's size.
+ *
+ * \return bool indicating if the line was a valid size line or not.
+ */
+bool parseChunkSize(const std::string& line, size_t* p_size)
+{
+  const char* p_begin = line.c_str();
+  char* p_end = 0;
 
-    case POCOResult::EXCEPTION_POCO_WEBSOCKET:
-      result = "EXCEPTION_POCO_WEBSOCKET";
-    break;
+  // Require a hexadecimal digit first, since strtoul would otherwise accept e.g. white space and signs.
+  if (!std::isxdigit(static_cast<unsigned char>(*p_begin)))
+  {
+    return false;
+  }
 
-    default:
-      result = "UNDEFINED";
-    break;
+  errno = 0;
+  unsigned long size = std::strtoul(p_begin, &p_end, 16);
+
+  // The size may only be followed by white space, chunk extensions (";...") and the carriage return.
+  if (errno == ERANGE || size > MAX_BUFFERED_CONTENT_SIZE ||
+      !(*p_end == '\0' || *p_end == '\r' || *p_end == ';' || *p_end == ' ' || *p_end == '\t'))
+  {
+    return false;
   }
 
-  return result;
+  *p_size = static_cast<size_t>(size);
+
+  return true;
 }
 
-std::string POCOClient::POCOResult::mapWebSocketOpcode() const
+/**
+ * \brief A function for reading the body of a pipelined HTTP response.
+ *
+ * Only bodies that are delimited by the message itself (i.e. with a content length or chunked transfer encoding) can
+ * be read, since the connection is reused for the following responses.
+ *
+ * \param stream for the connection's stream (positioned after the response header).
+ * \param response for the (already read) HTTP response header.
+ * \param p_content for storing the response body.
+ *
+ * \return bool indicating if the body could be read or not (not if it is malformed, or too large to buffer).
+ */
+bool readPipelinedBody(std::istream& stream, const HTTPResponse& response, std::string* p_content)
 {
-  std::string result;
-
-  switch (poco_info.websocket.flags & WebSocket::FRAME_OP_BITMASK)
+  if (response.getChunkedTransferEncoding())
   {
-    case WebSocket::FRAME_OP_CONT:
-      result = "FRAME_OP_CONT";
-    break;
+    std::string line;
 
-    case WebSocket::FRAME_OP_TEXT:
-      result = "FRAME_OP_TEXT";
-    break;
+    while (std::getline(stream, line))
+    {
+      size_t chunk_size = 0;
 
-    case WebSocket::FRAME_OP_BINARY:
-      result = "FRAME_OP_BINARY";
-    break;
+      if (!parseChunkSize(line, &chunk_size))
+      {
+        return false;
+      }
 
-    case WebSocket::FRAME_OP_CLOSE:
-      result = "FRAME_OP_CLOSE";
-    break;
+      if (chunk_size == 0)
+      {
+        // Skip any trailer fields, up to and including the terminating empty line.
+        while (std::getline(stream, line) && !line.empty() && line != "\r") {}
+        return !stream.fail();
+      }
 
-    case WebSocket::FRAME_OP_PING:
-      result = "FRAME_OP_PING";
-    break;
+      size_t offset = p_content->size();
 
-    case WebSocket::FRAME_OP_PONG:
-      result = "FRAME_OP_PONG";
-    break;
+      if (chunk_size > MAX_BUFFERED_CONTENT_SIZE - offset)
+      {
+        return false;
+      }
 
-    default:
-      result = "FRAME_OP_UNDEFINED";
-    break;
+      p_content->resize(offset + chunk_size);
+      stream.read(&(*p_content)[offset], chunk_size);
+      std::getline(stream, line);
+
+      if (!stream)
+      {
+        return false;
+      }
+    }
+
+    return false;
   }
 
-  return result;
+  if (response.hasContentLength())
+  {
+    if (static_cast<Poco::UInt64>(response.getContentLength64()) > MAX_BUFFERED_CONTENT_SIZE)
+    {
+      return false;
+    }
+
+    size_t content_length = static_cast<size_t>(response.getContentLength64());
+
+    p_content->resize(content_length);
+    if (content_length > 0)
+    {
+      stream.read(&(*p_content)[0], content_length);
+    }
+
+    return !stream.fail();
+  }
+
+  return (response.getStatus() == HTTPResponse::HTTP_NO_CONTENT ||
+          response.getStatus() == HTTPResponse::HTTP_NOT_MODIFIED);
+}
 }
 
-std::string POCOClient::POCOResult::toString(const bool verbose, const size_t indent) const
+namespace abb
 {
-  std::stringstream ss;
+namespace rws
+{
+/***********************************************************************************************************************
+ * Class definitions: POCOClient::StreamSink
+ */
 
-  std::string seperator = (indent == 0 ? " | " : "\n" + std::string(indent, ' '));
+/************************************************************
+ * Primary methods
+ */
 
-  ss << "General status: " << mapGeneralStatus();
+bool POCOClient::StreamSink::write(const char* data, const size_t size)
+{
+  stream_.write(data, size);
+  return stream_.good();
+}
 
-  if (!poco_info.http.request.method.empty())
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOClient::FileDescriptorSink
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+bool POCOClient::FileDescriptorSink::write(const char* data, const size_t size)
+{
+  size_t offset = 0;
+
+  while (offset < size)
   {
-    ss << seperator << "HTTP Request: " << poco_info.http.request.method << " " << poco_info.http.request.uri;
+#if defined(_WIN32)
+    int written = ::_write(fd_, data + offset, static_cast<unsigned int>(size - offset));
+#else
+    ssize_t written = ::write(fd_, data + offset, size - offset);
+#endif
 
-    if (status == OK)
+    if (written < 0 && errno == EINTR)
     {
-      ss << seperator << "HTTP Response: " << poco_info.http.response.status << " - "
-         << HTTPResponse::getReasonForStatus(poco_info.http.response.status);
+      continue;
+    }
 
-      if (verbose)
-      {
-        ss << seperator << "HTTP Response Content: " << poco_info.http.response.content;
-      }
+    if (written <= 0)
+    {
+      return false;
     }
-  }
-  else if (status == OK)
-  {
-    ss << seperator << "WebSocket frame: " << mapWebSocketOpcode();
+
+    offset += static_cast<size_t>(written);
   }
 
-  return ss.str();
+  return true;
 }
 
 
 
 
 /***********************************************************************************************************************
- * Class definitions: POCOClient
+ * Class definitions: POCOClient::MemorySource
  */
 
 /************************************************************
  * Primary methods
  */
 
-POCOClient::POCOResult POCOClient::httpGet(const std::string& uri)
+size_t POCOClient::MemorySource::read(char* data, const size_t size)
 {
-  return makeHTTPRequest(HTTPRequest::HTTP_GET, uri);
-}
+  size_t chunk_size = std::min(size, size_ - position_);
+  std::copy(data_ + position_, data_ + position_ + chunk_size, data);
+  position_ += chunk_size;
 
-POCOClient::POCOResult POCOClient::httpPost(const std::string& uri, const std::string& content)
-{
-  return makeHTTPRequest(HTTPRequest::HTTP_POST, uri, content);
+  return chunk_size;
 }
 
-POCOClient::POCOResult POCOClient::httpPut(const std::string& uri, const std::string& content)
-{
-  return makeHTTPRequest(HTTPRequest::HTTP_PUT, uri, content);
-}
 
-POCOClient::POCOResult POCOClient::httpDelete(const std::string& uri)
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOClient::FileDescriptorSource
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOClient::FileDescriptorSource::FileDescriptorSource(const int fd, const Poco::Int64 offset, const Poco::Int64 size)
+:
+fd_(-1),
+offset_(0),
+size_(-1),
+position_(0)
 {
-  return makeHTTPRequest(HTTPRequest::HTTP_DELETE, uri);
+  setRegion(fd, offset, size);
 }
 
-POCOClient::POCOResult POCOClient::makeHTTPRequest(const std::string& method,
-                                                   const std::string& uri,
-                                                   const std::string& content)
+size_t POCOClient::FileDescriptorSource::read(char* data, const size_t size)
 {
-  // Lock the object's mutex. It is released when the method goes out of scope.
-  ScopedLock<Mutex> lock(http_mutex_);
+  if (fd_ < 0 || position_ >= size_)
+  {
+    return 0;
+  }
 
-  // Result of the communication.
-  POCOResult result;
+  size_t chunk_size = static_cast<size_t>(std::min(static_cast<Poco::Int64>(size), size_ - position_));
 
-  // The response and the request.
-  HTTPResponse response;
-  HTTPRequest request(method, uri, HTTPRequest::HTTP_1_1);
-  request.setCookies(cookies_);
-  request.setContentLength(content.length());
-  if (method == HTTPRequest::HTTP_POST || !content.empty())
+#if defined(_WIN32)
+  if (::_lseeki64(fd_, offset_ + position_, SEEK_SET) < 0)
   {
-    request.setContentType("application/x-www-form-urlencoded");
+    return 0;
   }
 
-  // Attempt the communication.
-  try
+  int number_of_bytes_read = ::_read(fd_, data, static_cast<unsigned int>(chunk_size));
+#else
+  ssize_t number_of_bytes_read = 0;
+
+  do
   {
-    sendAndReceive(result, request, response, content);
+    number_of_bytes_read = ::pread(fd_, data, chunk_size, static_cast<off_t>(offset_ + position_));
+  } while (number_of_bytes_read < 0 && errno == EINTR);
+#endif
 
-    // Check if the server has sent an update for the cookies.
-    std::vector<HTTPCookie> temp_cookies;
-    response.getCookies(temp_cookies);
-    for (size_t i = 0; i < temp_cookies.size(); ++i)
-    {
-      if (cookies_.find(temp_cookies[i].getName()) != cookies_.end())
-      {
-        cookies_.set(temp_cookies[i].getName(), temp_cookies[i].getValue());
-      }
-      else
-      {
-        cookies_.add(temp_cookies[i].getName(), temp_cookies[i].getValue());
-      }
-    }
+  if (number_of_bytes_read <= 0)
+  {
+    return 0;
+  }
 
-    // Check if there was a server error, if so, make another attempt with a clean sheet.
-    if (response.getStatus() >= HTTPResponse::HTTP_INTERNAL_SERVER_ERROR)
-    {
-      http_client_session_.reset();
-      request.erase(HTTPRequest::COOKIE);
-      sendAndReceive(result, request, response, content);
-    }
+  position_ += number_of_bytes_read;
 
-    // Check if the request was unauthorized, if so add credentials.
-    if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED)
-    {
-      authenticate(result, request, response, content);
-    }
+  return static_cast<size_t>(number_of_bytes_read);
+}
 
-    result.status = POCOResult::OK;
-  }
-  catch (InvalidArgumentException& e)
-  {
-    result.status = POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT;
-    result.exception_message = e.displayText();
-  }
-  catch (TimeoutException& e)
-  {
+int POCOClient::FileDescriptorSource::fileRegion(Poco::Int64* p_offset) const
+{
+  *p_offset = offset_;
+
+  return fd_;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void POCOClient::FileDescriptorSource::setRegion(const int fd, const Poco::Int64 offset, const Poco::Int64 size)
+{
+  fd_ = fd;
+  offset_ = offset;
+  size_ = size;
+  position_ = 0;
+
+  if (size_ < 0 && fd_ >= 0)
+  {
+#if defined(_WIN32)
+    struct _stat64 file_status;
+    bool ok = (::_fstat64(fd_, &file_status) == 0);
+#else
+    struct stat file_status;
+    bool ok = (::fstat(fd_, &file_status) == 0);
+#endif
+
+    size_ = (ok ? std::max(static_cast<Poco::Int64>(file_status.st_size) - offset_, static_cast<Poco::Int64>(0)) : -1);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOClient::FileSource
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOClient::FileSource::FileSource(const std::string& path)
+{
+#if defined(_WIN32)
+  int fd = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+#endif
+
+  if (fd < 0)
+  {
+    throw OpenFileException(path);
+  }
+
+  setRegion(fd, 0, -1);
+}
+
+POCOClient::FileSource::~FileSource()
+{
+#if defined(_WIN32)
+  ::_close(fd_);
+#else
+  ::close(fd_);
+#endif
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: POCOClient::TransportOptions
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void POCOClient::TransportOptions::applyTo(StreamSocket& socket) const
+{
+  if (no_delay)
+  {
+    trySetOption(socket, IPPROTO_TCP, TCP_NODELAY, 1);
+  }
+
+  if (keep_alive)
+  {
+    trySetOption(socket, SOL_SOCKET, SO_KEEPALIVE, 1);
+
+#if defined(TCP_KEEPIDLE)
+    if (keep_alive_idle > 0)
+    {
+      trySetOption(socket, IPPROTO_TCP, TCP_KEEPIDLE, keep_alive_idle);
+    }
+#elif defined(TCP_KEEPALIVE)
+    if (keep_alive_idle > 0)
+    {
+      trySetOption(socket, IPPROTO_TCP, TCP_KEEPALIVE, keep_alive_idle);
+    }
+#endif
+#if defined(TCP_KEEPINTVL)
+    if (keep_alive_interval > 0)
+    {
+      trySetOption(socket, IPPROTO_TCP, TCP_KEEPINTVL, keep_alive_interval);
+    }
+#endif
+#if defined(TCP_KEEPCNT)
+    if (keep_alive_count > 0)
+    {
+      trySetOption(socket, IPPROTO_TCP, TCP_KEEPCNT, keep_alive_count);
+    }
+#endif
+  }
+
+  if (send_buffer_size > 0)
+  {
+    trySetOption(socket, SOL_SOCKET, SO_SNDBUF, send_buffer_size);
+  }
+
+  if (receive_buffer_size > 0)
+  {
+    trySetOption(socket, SOL_SOCKET, SO_RCVBUF, receive_buffer_size);
+  }
+
+  if (dscp >= 0 && dscp <= 63)
+  {
+    // The DSCP occupies the upper six bits of the IPv4 TOS / IPv6 traffic class field.
+#if defined(IP_TOS)
+    trySetOption(socket, IPPROTO_IP, IP_TOS, dscp << 2);
+#endif
+#if defined(IPV6_TCLASS)
+    trySetOption(socket, IPPROTO_IPV6, IPV6_TCLASS, dscp << 2);
+#endif
+  }
+
+  rearm(socket);
+}
+
+void POCOClient::TransportOptions::rearm(StreamSocket& socket) const
+{
+#if defined(TCP_QUICKACK)
+  if (quick_ack)
+  {
+    trySetOption(socket, IPPROTO_TCP, TCP_QUICKACK, 1);
+  }
+#else
+  (void) socket;
+#endif
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: POCOClient::POCOResult
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void POCOClient::POCOResult::addHTTPRequestInfo(const Poco::Net::HTTPRequest& request,
+                                                const std::string& request_content)
+{
+  poco_info.http.request.method = request.getMethod();
+  poco_info.http.request.uri = request.getURI();
+  poco_info.http.request.content = request_content;
+}
+
+void POCOClient::POCOResult::addHTTPResponseInfo(const Poco::Net::HTTPResponse& response,
+                                                 const std::string& response_content)
+{
+  addHTTPResponseInfo(response, SharedBuffer(response_content));
+}
+
+void POCOClient::POCOResult::addHTTPResponseInfo(const Poco::Net::HTTPResponse& response,
+                                                 const SharedBuffer& response_content)
+{
+  Poco::SharedPtr<const NameValueCollection> p_headers(new NameValueCollection(response));
+
+  poco_info.http.response.status = response.getStatus();
+  poco_info.http.response.header_info = POCOInfo::HTTPInfo::ResponseInfo::HeaderInfo(p_headers);
+  poco_info.http.response.content = response_content;
+}
+
+void POCOClient::POCOResult::addHTTPResponseInfo(const Poco::SharedPtr<Poco::Net::HTTPResponse>& p_response,
+                                                 const SharedBuffer& response_content)
+{
+  Poco::SharedPtr<const NameValueCollection> p_headers(p_response);
+
+  poco_info.http.response.status = p_response->getStatus();
+  poco_info.http.response.header_info = POCOInfo::HTTPInfo::ResponseInfo::HeaderInfo(p_headers);
+  poco_info.http.response.content = response_content;
+}
+
+void POCOClient::POCOResult::addWebSocketFrameInfo(const int flags,
+                                                   const std::string& frame_content)
+{
+  poco_info.websocket.flags = flags;
+  poco_info.websocket.frame_content = frame_content;
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+std::string POCOClient::POCOResult::POCOInfo::HTTPInfo::ResponseInfo::header(const std::string& name) const
+{
+  const NameValueCollection* p_headers = header_info.headers();
+
+  return (p_headers ? p_headers->get(name, std::string()) : std::string());
+}
+
+std::string POCOClient::POCOResult::POCOInfo::HTTPInfo::ResponseInfo::location() const
+{
+  return header("Location");
+}
+
+std::vector<std::string> POCOClient::POCOResult::POCOInfo::HTTPInfo::ResponseInfo::setCookies() const
+{
+  std::vector<std::string> result;
+  const NameValueCollection* p_headers = header_info.headers();
+
+  if (p_headers)
+  {
+    for (NameValueCollection::ConstIterator i = p_headers->find("Set-Cookie");
+         i != p_headers->end() && Poco::icompare(i->first, "Set-Cookie") == 0;
+         ++i)
+    {
+      result.push_back(i->second);
+    }
+  }
+
+  return result;
+}
+
+std::string POCOClient::POCOResult::POCOInfo::HTTPInfo::ResponseInfo::HeaderInfo::str() const
+{
+  std::string result;
+
+  if (!p_headers_.isNull())
+  {
+    for (NameValueCollection::ConstIterator i = p_headers_->begin(); i != p_headers_->end(); ++i)
+    {
+      result += i->first + "=" + i->second + "\n";
+    }
+  }
+
+  return result;
+}
+
+std::string POCOClient::POCOResult::mapGeneralStatus() const
+{
+  std::string result;
+
+  switch (status)
+  {
+    case POCOResult::UNKNOWN:
+      result = "UNKNOWN";
+    break;
+
+    case POCOResult::OK:
+      result = "OK";
+    break;
+
+    case POCOResult::WEBSOCKET_NOT_ALLOCATED:
+      result = "WEBSOCKET_NOT_ALLOCATED";
+    break;
+
+    case POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT:
+      result = "EXCEPTION_POCO_INVALID_ARGUMENT";
+    break;
+
+    case POCOResult::EXCEPTION_POCO_TIMEOUT:
+      result = "EXCEPTION_POCO_TIMEOUT";
+    break;
+
+    case POCOResult::EXCEPTION_POCO_NET:
+      result = "EXCEPTION_POCO_NET";
+    break;
+
+    case POCOResult::EXCEPTION_POCO_WEBSOCKET:
+      result = "EXCEPTION_POCO_WEBSOCKET";
+    break;
+
+    case POCOResult::TRANSFER_ABORTED:
+      result = "TRANSFER_ABORTED";
+    break;
+
+    default:
+      result = "UNDEFINED";
+    break;
+  }
+
+  return result;
+}
+
+std::string POCOClient::POCOResult::mapWebSocketOpcode() const
+{
+  std::string result;
+
+  switch (poco_info.websocket.flags & WebSocket::FRAME_OP_BITMASK)
+  {
+    case WebSocket::FRAME_OP_CONT:
+      result = "FRAME_OP_CONT";
+    break;
+
+    case WebSocket::FRAME_OP_TEXT:
+      result = "FRAME_OP_TEXT";
+    break;
+
+    case WebSocket::FRAME_OP_BINARY:
+      result = "FRAME_OP_BINARY";
+    break;
+
+    case WebSocket::FRAME_OP_CLOSE:
+      result = "FRAME_OP_CLOSE";
+    break;
+
+    case WebSocket::FRAME_OP_PING:
+      result = "FRAME_OP_PING";
+    break;
+
+    case WebSocket::FRAME_OP_PONG:
+      result = "FRAME_OP_PONG";
+    break;
+
+    default:
+      result = "FRAME_OP_UNDEFINED";
+    break;
+  }
+
+  return result;
+}
+
+std::string POCOClient::POCOResult::toString(const bool verbose, const size_t indent) const
+{
+  std::stringstream ss;
+
+  std::string seperator = (indent == 0 ? " | " : "\n" + std::string(indent, ' '));
+
+  ss << "General status: " << mapGeneralStatus();
+
+  if (!poco_info.http.request.method.empty())
+  {
+    ss << seperator << "HTTP Request: " << poco_info.http.request.method << " " << poco_info.http.request.uri;
+
+    if (status == OK)
+    {
+      ss << seperator << "HTTP Response: " << poco_info.http.response.status << " - "
+         << HTTPResponse::getReasonForStatus(poco_info.http.response.status);
+
+      if (verbose)
+      {
+        ss << seperator << "HTTP Response Content: " << poco_info.http.response.content;
+      }
+    }
+  }
+  else if (status == OK)
+  {
+    ss << seperator << "WebSocket frame: " << mapWebSocketOpcode();
+  }
+
+  return ss.str();
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOClient::Deadline
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOClient::Deadline::Deadline(POCOClient& client, const Poco::Int64 timeout)
+:
+client_(client),
+had_previous_(false)
+{
+  ScopedLock<Mutex> lock(client_.deadlines_mutex_);
+
+  Timestamp deadline;
+  deadline += timeout;
+
+  std::map<Thread::TID, Timestamp>::iterator it = client_.deadlines_.find(Thread::currentTid());
+
+  if (it != client_.deadlines_.end())
+  {
+    // Keep the earliest deadline.
+    had_previous_ = true;
+    previous_ = it->second;
+    it->second = std::min(it->second, deadline);
+  }
+  else
+  {
+    client_.deadlines_[Thread::currentTid()] = deadline;
+  }
+}
+
+POCOClient::Deadline::~Deadline()
+{
+  ScopedLock<Mutex> lock(client_.deadlines_mutex_);
+
+  if (had_previous_)
+  {
+    client_.deadlines_[Thread::currentTid()] = previous_;
+  }
+  else
+  {
+    client_.deadlines_.erase(Thread::currentTid());
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOClient::PriorityScope
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOClient::PriorityScope::PriorityScope(POCOClient& client, const Priority priority)
+:
+client_(client),
+had_previous_(false),
+previous_(INTERACTIVE)
+{
+  ScopedLock<Mutex> lock(client_.lanes_mutex_);
+
+  std::map<Thread::TID, Priority>::iterator it = client_.priorities_.find(Thread::currentTid());
+
+  if (it != client_.priorities_.end())
+  {
+    // The innermost scope applies.
+    had_previous_ = true;
+    previous_ = it->second;
+    it->second = priority;
+  }
+  else
+  {
+    client_.priorities_[Thread::currentTid()] = priority;
+  }
+}
+
+POCOClient::PriorityScope::~PriorityScope()
+{
+  ScopedLock<Mutex> lock(client_.lanes_mutex_);
+
+  if (had_previous_)
+  {
+    client_.priorities_[Thread::currentTid()] = previous_;
+  }
+  else
+  {
+    client_.priorities_.erase(Thread::currentTid());
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: POCOClient
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+POCOClient::POCOResult POCOClient::httpGet(const std::string& uri)
+{
+  return makeHTTPRequest(HTTPRequest::HTTP_GET, uri);
+}
+
+POCOClient::POCOResult POCOClient::httpGet(const std::string& uri, ContentSink& sink)
+{
+  return makeHTTPRequest(HTTPRequest::HTTP_GET, uri, "", &sink);
+}
+
+POCOClient::POCOResult POCOClient::httpPost(const std::string& uri, const std::string& content)
+{
+  return makeHTTPRequest(HTTPRequest::HTTP_POST, uri, content);
+}
+
+POCOClient::POCOResult POCOClient::httpPut(const std::string& uri, const std::string& content)
+{
+  return makeHTTPRequest(HTTPRequest::HTTP_PUT, uri, content);
+}
+
+POCOClient::POCOResult POCOClient::httpPut(const std::string& uri, ContentSource& source)
+{
+  return makeHTTPRequest(HTTPRequest::HTTP_PUT, uri, "", 0, &source);
+}
+
+POCOClient::POCOResult POCOClient::httpDelete(const std::string& uri)
+{
+  return makeHTTPRequest(HTTPRequest::HTTP_DELETE, uri);
+}
+
+POCOClient::POCOResult POCOClient::makeHTTPRequest(const std::string& method,
+                                                   const std::string& uri,
+                                                   const std::string& content,
+                                                   ContentSink* p_sink,
+                                                   ContentSource* p_source)
+{
+  // Wait for admission (if admission control is enabled), in priority order.
+  bool admitted = false;
+  if (!acquireAdmission(1, &admitted))
+  {
+    POCOResult result;
+    result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
+    result.exception_message = "Deadline exceeded";
+    return result;
+  }
+
+  // Notify both before and after, so reads that overlap the modification in any way are detected.
+  const bool modifying = (method != HTTPRequest::HTTP_GET && method != HTTPRequest::HTTP_HEAD);
+  const bool streamed = (p_sink || p_source);
+  Timestamp started;
+  POCOResult result;
+
+  try
+  {
+    if (modifying)
+    {
+      onModifyingRequest(uri);
+    }
+
+    // Requests with a non-default priority are made on the priority's own lane (i.e. session).
+    result = findLane()->performHTTPRequest(method, uri, content, p_sink, p_source);
+
+    if (modifying)
+    {
+      onModifyingRequest(uri);
+    }
+  }
+  catch (...)
+  {
+    if (admitted)
+    {
+      releaseAdmission(started.elapsed(), !streamed);
+    }
+    throw;
+  }
+
+  if (admitted)
+  {
+    releaseAdmission(started.elapsed(), !streamed);
+  }
+
+  return result;
+}
+
+POCOClient::POCOResult POCOClient::performHTTPRequest(const std::string& method,
+                                                      const std::string& uri,
+                                                      const std::string& content,
+                                                      ContentSink* p_sink,
+                                                      ContentSource* p_source)
+{
+  // Result of the communication.
+  POCOResult result;
+
+  // Lock the object's mutex, but wait no longer than the thread's deadline (if any), since another thread may be in
+  // the middle of a long transfer. Fail directly if the deadline passes, without disturbing the session.
+  Timestamp deadline;
+  const bool has_deadline = findDeadline(&deadline);
+
+  if (has_deadline)
+  {
+    Timestamp::TimeDiff remaining = deadline - Timestamp();
+
+    if (remaining <= 0 || !http_mutex_.tryLock(static_cast<long>(remaining / 1000)))
+    {
+      result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
+      result.exception_message = "Deadline exceeded";
+      return result;
+    }
+  }
+  else
+  {
+    http_mutex_.lock();
+  }
+
+  // The mutex is released when the method goes out of scope.
+  AdoptedLock lock(http_mutex_);
+
+  // The response (shared with the result, to avoid copying its headers) and the request.
+  Poco::SharedPtr<HTTPResponse> p_response(new HTTPResponse());
+  HTTPResponse& response = *p_response;
+  HTTPRequest request(method, uri, HTTPRequest::HTTP_1_1);
+  request.setCookies(cookies_);
+  if (method == HTTPRequest::HTTP_POST || !content.empty() || p_source)
+  {
+    request.setContentType("application/x-www-form-urlencoded");
+  }
+
+  // Negotiate compressed responses, and compress large request contents, if enabled.
+  if (accept_compressed_responses_)
+  {
+    request.set("Accept-Encoding", "gzip, deflate");
+  }
+
+  std::string compressed_content;
+  if (compress_requests_ && content.size() >= MIN_COMPRESSED_REQUEST_SIZE)
+  {
+    compressContent(content, &compressed_content);
+    request.set("Content-Encoding", "gzip");
+  }
+
+  const std::string& request_content = (compressed_content.empty() ? content : compressed_content);
+
+  if (!p_source)
+  {
+    request.setContentLength(request_content.length());
+  }
+  else if (p_source->size() >= 0)
+  {
+    request.setContentLength64(p_source->size());
+  }
+  else
+  {
+    request.setChunkedTransferEncoding(true);
+  }
+
+  // Keep track of if any content has reached the sink, since a partially streamed content can not be retried.
+  TrackingSink tracking_sink(p_sink);
+  ContentSink* p_tracked_sink = (p_sink ? &tracking_sink : 0);
+
+  // Attempt the communication.
+  try
+  {
+    bool reused_connection = http_client_session_.connected();
+
+    try
+    {
+      sendAndReceive(result, request, p_response, request_content, p_tracked_sink, p_source);
+    }
+    catch (NetException&)
+    {
+      // A kept-alive connection may have been closed by the server while idle (i.e. the request was not processed),
+      // if so, make another attempt on a new connection. Only requests without side effects are retried, since the
+      // server may still have processed the request, and only if the content can be resent from the beginning.
+      const bool idempotent = (method == HTTPRequest::HTTP_GET || method == HTTPRequest::HTTP_HEAD);
+
+      if (!reused_connection || !idempotent || tracking_sink.started() || (p_source && !p_source->rewind()))
+      {
+        throw;
+      }
+
+      replaceConnection();
+      sendAndReceive(result, request, p_response, request_content, p_tracked_sink, p_source);
+    }
+
+    // Check if the server has sent an update for the cookies.
+    storeCookies(response);
+
+    // Check if there was a server error, if so, make another attempt with a clean sheet.
+    if (response.getStatus() >= HTTPResponse::HTTP_INTERNAL_SERVER_ERROR)
+    {
+      http_client_session_.reset();
+      request.erase(HTTPRequest::COOKIE);
+      sendAndReceive(result, request, p_response, request_content, p_tracked_sink, p_source);
+    }
+
+    // Check if the request was unauthorized, if so add credentials.
+    if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED)
+    {
+      authenticate(result, request, p_response, request_content, p_tracked_sink, p_source);
+    }
+
+    result.status = POCOResult::OK;
+  }
+  catch (InvalidArgumentException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT;
+    result.exception_message = e.displayText();
+  }
+  catch (TimeoutException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
+    result.exception_message = e.displayText();
+  }
+  catch (NetException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_NET;
+    result.exception_message = e.displayText();
+  }
+  catch (IOException& e)
+  {
+    result.status = POCOResult::TRANSFER_ABORTED;
+    result.exception_message = e.displayText();
+  }
+
+  if (result.status != POCOResult::OK)
+  {
+    // With a deadline, the session's timeouts are the deadline's. So, if it expired, only drop the connection (which
+    // is in an unknown state) and keep the cookies, to avoid a new login and leaving the old session behind.
+    if (!(has_deadline && result.status == POCOResult::EXCEPTION_POCO_TIMEOUT))
+    {
+      cookies_.clear();
+    }
+
+    http_client_session_.reset();
+  }
+
+  restoreTimeout();
+
+  return result;
+}
+
+std::vector<POCOClient::POCOResult> POCOClient::httpGetPipelined(const std::vector<std::string>& uris)
+{
+  POCOClient* p_lane = findLane();
+  if (p_lane != this)
+  {
+    return p_lane->httpGetPipelined(uris);
+  }
+
+  std::vector<POCOResult> results;
+  results.reserve(uris.size());
+
+  // Use a regular request to (re)connect, since authentication may be required.
+  if (!uris.empty() && !http_client_session_.connected())
+  {
+    results.push_back(httpGet(uris[0]));
+  }
+
+  // The pipelined requests are admitted together (before the session is locked, since admission may have to wait).
+  const size_t pipelined = uris.size() - results.size();
+  bool admitted = false;
+  Timestamp started;
+
+  if (pipelined > 0 && acquireAdmission(pipelined, &admitted))
+  {
+    // Lock the object's mutex. It is released when the scope is left.
+    ScopedLock<Mutex> lock(http_mutex_);
+
+    bool pipelining = (http_client_session_.connected() && http_client_session_.getProxyHost().empty());
+
+    try
+    {
+      while (pipelining && results.size() < uris.size())
+      {
+        applyDeadline();
+        SocketStream stream(http_client_session_.socket());
+        size_t window_begin = results.size();
+        size_t window_end = std::min(uris.size(), window_begin + MAX_PIPELINE_DEPTH);
+        std::vector<POCOResult> window(window_end - window_begin);
+
+        // Write all requests in the window back-to-back.
+        for (size_t i = window_begin; i < window_end; ++i)
+        {
+          HTTPRequest request(HTTPRequest::HTTP_GET, uris[i], HTTPRequest::HTTP_1_1);
+          request.setHost(http_client_session_.getHost(), http_client_session_.getPort());
+          request.setKeepAlive(true);
+          request.setCookies(cookies_);
+          if (accept_compressed_responses_)
+          {
+            request.set("Accept-Encoding", "gzip, deflate");
+          }
+          window[i - window_begin].addHTTPRequestInfo(request);
+          request.write(stream);
+        }
+        stream.flush();
+        transport_options_.rearm(http_client_session_.socket());
+
+        // Read the responses in order.
+        for (size_t i = 0; i < window.size() && pipelining; ++i)
+        {
+          Poco::SharedPtr<HTTPResponse> p_response(new HTTPResponse());
+          HTTPResponse& response = *p_response;
+          SharedBuffer response_content;
+
+          response.read(stream);
+          pipelining = (stream.good() &&
+                        readPipelinedBody(stream, response, response_content.reset()) &&
+                        response.getStatus() != HTTPResponse::HTTP_UNAUTHORIZED &&
+                        response.getStatus() < HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+
+          if (pipelining)
+          {
+            storeCookies(response);
+
+            InflatingStreamBuf::StreamType compression;
+            if (findContentCompression(response, &compression))
+            {
+              std::istringstream compressed(response_content.str());
+              InflatingInputStream inflater(compressed, compression);
+              SharedBuffer inflated;
+              StreamCopier::copyToString(inflater, *inflated.reset());
+              response_content = inflated;
+            }
+
+            window[i].addHTTPResponseInfo(p_response, response_content);
+            window[i].status = POCOResult::OK;
+            results.push_back(window[i]);
+            pipelining = response.getKeepAlive();
+          }
+        }
+      }
+    }
+    catch (Poco::Exception&)
+    {
+      pipelining = false;
+    }
+
+    // Discard the connection if any responses are still outstanding (or the server wants to close it).
+    if (!pipelining)
+    {
+      http_client_session_.reset();
+    }
+
+    restoreTimeout();
+  }
+
+  if (admitted)
+  {
+    // The server processes pipelined requests in order, so use the average latency.
+    releaseAdmission(started.elapsed() / static_cast<Timestamp::TimeDiff>(pipelined), true);
+  }
+
+  // Fall back to serial requests for anything that was not completed.
+  for (size_t i = results.size(); i < uris.size(); ++i)
+  {
+    results.push_back(httpGet(uris[i]));
+  }
+
+  return results;
+}
+
+void POCOClient::setTransportOptions(const TransportOptions& options)
+{
+  // Lock the object's mutex. It is released when the method goes out of scope.
+  ScopedLock<Mutex> lock(http_mutex_);
+
+  {
+    FastMutex::ScopedLock settings_lock(settings_mutex_);
+    transport_options_ = options;
+  }
+
+  if (http_client_session_.connected())
+  {
+    transport_options_.applyTo(http_client_session_.socket());
+  }
+
+  std::vector<SharedPtr<POCOClient> > lanes = createdLanes();
+  for (size_t i = 0; i < lanes.size(); ++i)
+  {
+    lanes[i]->setTransportOptions(options);
+  }
+}
+
+void POCOClient::setHTTPTimeout(const Poco::Int64 timeout)
+{
+  {
+    // Lock the object's mutex. It is released when the scope is left.
+    ScopedLock<Mutex> lock(http_mutex_);
+    {
+      FastMutex::ScopedLock settings_lock(settings_mutex_);
+      http_timeout_ = timeout;
+    }
+    applyTimeout(timeout);
+  }
+
+  std::vector<SharedPtr<POCOClient> > lanes = createdLanes();
+  for (size_t i = 0; i < lanes.size(); ++i)
+  {
+    lanes[i]->setHTTPTimeout(timeout);
+  }
+}
+
+void POCOClient::setCompression(const bool responses, const bool requests)
+{
+  {
+    // Lock the object's mutex. It is released when the scope is left.
+    ScopedLock<Mutex> lock(http_mutex_);
+    FastMutex::ScopedLock settings_lock(settings_mutex_);
+    accept_compressed_responses_ = responses;
+    compress_requests_ = requests;
+  }
+
+  std::vector<SharedPtr<POCOClient> > lanes = createdLanes();
+  for (size_t i = 0; i < lanes.size(); ++i)
+  {
+    lanes[i]->setCompression(responses, requests);
+  }
+}
+
+bool POCOClient::laneExists(const Priority priority)
+{
+  ScopedLock<Mutex> lock(lanes_mutex_);
+
+  switch (priority)
+  {
+    case CONTROL:
+      return !p_control_lane_.isNull();
+
+    case BULK:
+      return !p_bulk_lane_.isNull();
+
+    default:
+      return true;
+  }
+}
+
+void POCOClient::setAdmissionControl(const AdmissionOptions& options)
+{
+  ScopedLock<Mutex> lock(admission_mutex_);
+
+  admission_options_ = options;
+  admission_options_.burst = std::max(options.burst, 1.0);
+  admission_options_.min_concurrency = std::max(options.min_concurrency, 1u);
+  admission_options_.max_concurrency = std::max(options.max_concurrency, admission_options_.min_concurrency);
+
+  admission_enabled_ = true;
+  tokens_ = admission_options_.burst;
+  last_refill_.update();
+  concurrency_limit_ = admission_options_.max_concurrency;
+
+  admission_condition_.broadcast();
+}
+
+void POCOClient::disableAdmissionControl()
+{
+  ScopedLock<Mutex> lock(admission_mutex_);
+
+  admission_enabled_ = false;
+
+  admission_condition_.broadcast();
+}
+
+POCOClient::AdmissionMetrics POCOClient::getAdmissionMetrics()
+{
+  ScopedLock<Mutex> lock(admission_mutex_);
+
+  AdmissionMetrics metrics = admission_metrics_;
+  metrics.queue_depth = admission_queue_.size();
+  metrics.concurrency_limit = static_cast<unsigned int>(concurrency_limit_);
+
+  return metrics;
+}
+
+void POCOClient::startSessionKeeper(const std::string& uri, const Poco::Int64 refresh_interval)
+{
+  stopSessionKeeper();
+
+  ScopedLock<Mutex> lock(http_mutex_);
+
+  keeper_uri_ = uri;
+  keeper_interval_ = refresh_interval;
+  keeper_running_ = true;
+  keeper_stop_event_.reset();
+  keeper_thread_.start(keeper_runnable_);
+}
+
+void POCOClient::stopSessionKeeper()
+{
+  {
+    ScopedLock<Mutex> lock(http_mutex_);
+
+    if (!keeper_running_)
+    {
+      return;
+    }
+
+    keeper_running_ = false;
+  }
+
+  keeper_stop_event_.set();
+  keeper_thread_.join();
+
+  ScopedLock<Mutex> lock(http_mutex_);
+
+  spare_socket_ = StreamSocket();
+  spare_ready_ = false;
+}
+
+POCOClient::POCOResult POCOClient::webSocketConnect(const std::string& uri,
+                                                    const std::string& protocol,
+                                                    const Poco::Int64 timeout)
+{
+  // Lock the object's mutex. It is released when the method goes out of scope.
+  ScopedLock<Mutex> lock(http_mutex_);
+
+  // Result of the communication.
+  POCOResult result;
+
+  // The response (shared with the result, to avoid copying its headers) and the request.
+  Poco::SharedPtr<HTTPResponse> p_response(new HTTPResponse());
+  HTTPResponse& response = *p_response;
+  HTTPRequest request(HTTPRequest::HTTP_GET, uri, HTTPRequest::HTTP_1_1);
+  request.set("Sec-WebSocket-Protocol", protocol);
+  request.setCookies(cookies_);
+
+  // Attempt the communication.
+  try
+  {
+    result.addHTTPRequestInfo(request);
+
+    {
+      // We must have at least websocket_connect_mutext_.
+      // If a connection already exists, we must also have websocket_use_mutex_.
+      // If not, nobody should have the mutex anyway, so we should get it immediately.
+      ScopedLock<Mutex> connect_lock(websocket_connect_mutex_);
+      ScopedLock<Mutex> use_lock(websocket_use_mutex_);
+
+      p_websocket_ = new WebSocket(http_client_session_, request, response);
+      p_websocket_->setReceiveTimeout(Poco::Timespan(timeout));
+      transport_options_.applyTo(*p_websocket_);
+    }
+
+    result.addHTTPResponseInfo(p_response, SharedBuffer());
+    result.status = POCOResult::OK;
+  }
+  catch (InvalidArgumentException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT;
+    result.exception_message = e.displayText();
+  }
+  catch (TimeoutException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
+    result.exception_message = e.displayText();
+  }
+  catch (WebSocketException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_WEBSOCKET;
+    result.exception_message = e.displayText();
+  }
+  catch (NetException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_NET;
+    result.exception_message = e.displayText();
+  }
+
+  if (result.status != POCOResult::OK)
+  {
+    http_client_session_.reset();
+  }
+
+  return result;
+}
+
+POCOClient::POCOResult POCOClient::webSocketReceiveFrame()
+{
+  // Lock the object's mutex. It is released when the method goes out of scope.
+  ScopedLock<Mutex> lock(websocket_use_mutex_);
+
+  // Result of the communication.
+  POCOResult result;
+
+  // Attempt the communication.
+  try
+  {
+    if (!p_websocket_.isNull())
+    {
+      int flags = 0;
+      std::string content;
+
+      // Wait for (non-ping) WebSocket frames.
+      do
+      {
+        flags = 0;
+        int number_of_bytes_received = p_websocket_->receiveFrame(websocket_buffer_, sizeof(websocket_buffer_), flags);
+        content = std::string(websocket_buffer_, number_of_bytes_received);
+
+        // Check for ping frame.
+        if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING)
+        {
+          // Reply with a pong frame.
+          p_websocket_->sendFrame(websocket_buffer_,
+                                  number_of_bytes_received,
+                                  WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG);
+        }
+      } while ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING);
+
+      // Check for closing frame.
+      if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_CLOSE)
+      {
+        // Do not pass content of a closing frame to end user,
+        // according to "The WebSocket Protocol" RFC6455.
+        content.clear();
+
+        // Shutdown the WebSocket.
+        p_websocket_->shutdown();
+        p_websocket_ = 0;
+      }
+
+      result.addWebSocketFrameInfo(flags, content);
+      result.status = POCOResult::OK;
+    }
+    else
+    {
+      result.status = POCOResult::WEBSOCKET_NOT_ALLOCATED;
+    }
+  }
+  catch (InvalidArgumentException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT;
+    result.exception_message = e.displayText();
+  }
+  catch (TimeoutException& e)
+  {
     result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
     result.exception_message = e.displayText();
   }
-  catch (NetException& e)
+  catch (WebSocketException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_WEBSOCKET;
+    result.exception_message = e.displayText();
+  }
+  catch (NetException& e)
+  {
+    result.status = POCOResult::EXCEPTION_POCO_NET;
+    result.exception_message = e.displayText();
+  }
+
+  if (result.status != POCOResult::OK)
+  {
+    http_client_session_.reset();
+  }
+
+  return result;
+}
+
+void POCOClient::webSocketShutdown()
+{
+  // Make sure nobody is connecting while we're closing.
+  ScopedLock<Mutex> connect_lock(websocket_connect_mutex_);
+
+  // Make sure there is actually a connection to close.
+  if (!webSocketExist())
+  {
+    return;
+  }
+
+  // Shut down the socket. This should make webSocketReceiveFrame() return as soon as possible.
+  p_websocket_->shutdown();
+
+  // Also acquire the websocket lock before invalidating the pointer,
+  // or we will break running calls to webSocketReceiveFrame().
+  ScopedLock<Mutex> use_lock(websocket_use_mutex_);
+  p_websocket_ = Poco::SharedPtr<Poco::Net::WebSocket>();
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void POCOClient::sendAndReceive(POCOResult& result,
+                                HTTPRequest& request,
+                                const Poco::SharedPtr<HTTPResponse>& p_response,
+                                const std::string& request_content,
+                                ContentSink* p_sink,
+                                ContentSource* p_source)
+{
+  HTTPResponse& response = *p_response;
+
+  // Add request info to the result.
+  result.addHTTPRequestInfo(request, request_content);
+  last_activity_.update();
+
+  // Limit the communication to the thread's deadline (if any).
+  applyDeadline();
+
+  // Contact the server, and read the response's content directly into a shared buffer.
+  SharedBuffer response_content;
+  std::ostream& request_stream = http_client_session_.sendRequest(request);
+
+  // Tune the connection before the content is written, since Nagle's algorithm would otherwise hold the content back
+  // until the header has been acknowledged. The options are applied on every request, since sendRequest may have
+  // replaced a connected socket internally (e.g. after the keep-alive timeout), which can not be detected reliably.
+  transport_options_.applyTo(http_client_session_.socket());
+
+  if (p_source)
+  {
+    sendContent(request_stream, *p_source);
+  }
+  else
+  {
+    request_stream << request_content;
+  }
+
+  std::istream& response_stream = http_client_session_.receiveResponse(response);
+
+  InflatingStreamBuf::StreamType compression;
+  bool compressed = findContentCompression(response, &compression);
+
+  if (p_sink && response.getStatus() == HTTPResponse::HTTP_OK)
+  {
+    // Stream the content to the sink, instead of buffering it.
+    if (compressed)
+    {
+      InflatingInputStream inflater(response_stream, compression);
+      streamContent(inflater, -1, STREAM_CHUNK_SIZE, *p_sink);
+    }
+    else
+    {
+      streamContent(response_stream,
+                    response.hasContentLength() ? response.getContentLength64() : -1,
+                    STREAM_CHUNK_SIZE,
+                    *p_sink);
+    }
+  }
+  else if (compressed)
+  {
+    // Inflate while reading, so the compressed content is never buffered.
+    InflatingInputStream inflater(response_stream, compression);
+    StreamCopier::copyToString(inflater, *response_content.reset());
+  }
+  else if (response.hasContentLength())
+  {
+    // Bound the (server provided) size, before allocating the buffer for it.
+    if (static_cast<Poco::UInt64>(response.getContentLength64()) > MAX_BUFFERED_CONTENT_SIZE)
+    {
+      throw IOException("Response content is too large to buffer (use a content sink)");
+    }
+
+    std::string* p_content = response_content.reset();
+    p_content->resize(static_cast<size_t>(response.getContentLength64()));
+
+    if (!p_content->empty())
+    {
+      response_stream.read(&(*p_content)[0], p_content->size());
+      p_content->resize(static_cast<size_t>(response_stream.gcount()));
+    }
+  }
+  else
+  {
+    StreamCopier::copyToString(response_stream, *response_content.reset());
+  }
+
+  // Add response info to the result.
+  result.addHTTPResponseInfo(p_response, response_content);
+}
+
+void POCOClient::authenticate(POCOResult& result,
+                              HTTPRequest& request,
+                              const Poco::SharedPtr<HTTPResponse>& p_response,
+                              const std::string& request_content,
+                              ContentSink* p_sink,
+                              ContentSource* p_source)
+{
+  // Remove any old cookies.
+  cookies_.clear();
+
+  // Authenticate with the provided credentials.
+  http_credentials_.authenticate(request, *p_response);
+
+  // Contact the server (a source is rewound, or the request fails, before it is resent), and extract and store the
+  // received cookies.
+  sendAndReceive(result, request, p_response, request_content, p_sink, p_source);
+  std::vector<HTTPCookie> temp_cookies;
+  p_response->getCookies(temp_cookies);
+
+  for (size_t i = 0; i < temp_cookies.size(); ++i)
+  {
+    extractAndStoreCookie(temp_cookies[i].toString());
+  }
+}
+
+void POCOClient::sendContent(std::ostream& request_stream, ContentSource& source)
+{
+  // The content is resent from the beginning, if the request is retried.
+  if (!source.rewind())
+  {
+    throw IOException("Content source could not be rewound");
+  }
+
+  Poco::Int64 total = source.size();
+  Poco::UInt64 transferred = 0;
+
+#if defined(__linux__)
+  Poco::Int64 file_offset = 0;
+  int fd = source.fileRegion(&file_offset);
+#endif
+
+  source.onProgress(transferred, total);
+
+  if (total >= 0 && source.memory())
+  {
+    // The session does not buffer writes, so a content with a known length can be sent straight from memory.
+    const char* data = source.memory();
+
+    while (transferred < static_cast<Poco::UInt64>(total))
+    {
+      int chunk_size = static_cast<int>(std::min(static_cast<Poco::UInt64>(STREAM_CHUNK_SIZE), total - transferred));
+      int number_of_bytes_sent = http_client_session_.socket().sendBytes(data + transferred, chunk_size);
+
+      if (number_of_bytes_sent <= 0)
+      {
+        throw NetException("Sending the content failed");
+      }
+
+      transferred += number_of_bytes_sent;
+      source.onProgress(transferred, total);
+    }
+  }
+#if defined(__linux__)
+  else if (total >= 0 && fd >= 0 && p_kept_alive_session_)
+  {
+    // Let the kernel copy the file region to the (plain) socket, without passing it through user space.
+    int socket_fd = http_client_session_.socket().impl()->sockfd();
+
+    while (transferred < static_cast<Poco::UInt64>(total))
+    {
+      off_t offset = static_cast<off_t>(file_offset + transferred);
+      size_t chunk_size = static_cast<size_t>(std::min(static_cast<Poco::UInt64>(STREAM_CHUNK_SIZE),
+                                                       total - transferred));
+      ssize_t number_of_bytes_sent = ::sendfile(socket_fd, fd, &offset, chunk_size);
+
+      if (number_of_bytes_sent < 0 && errno == EINTR)
+      {
+        continue;
+      }
+      else if (number_of_bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      {
+        throw TimeoutException("Sending the content timed out");
+      }
+      else if (number_of_bytes_sent < 0)
+      {
+        throw NetException("Sending the content failed", errno);
+      }
+      else if (number_of_bytes_sent == 0)
+      {
+        throw IOException("Content source ended before its size");
+      }
+
+      transferred += number_of_bytes_sent;
+      source.onProgress(transferred, total);
+    }
+  }
+#endif
+  else
+  {
+    std::vector<char> chunk(STREAM_CHUNK_SIZE);
+    size_t chunk_size = 0;
+
+    while ((chunk_size = source.read(&chunk[0], chunk.size())) > 0)
+    {
+      request_stream.write(&chunk[0], chunk_size);
+
+      if (!request_stream.good())
+      {
+        throw NetException("Sending the content failed");
+      }
+
+      transferred += chunk_size;
+      source.onProgress(transferred, total);
+    }
+
+    request_stream.flush();
+  }
+
+  if (total >= 0 && transferred != static_cast<Poco::UInt64>(total))
+  {
+    throw IOException("Content source ended before its size");
+  }
+}
+
+bool POCOClient::findDeadline(Timestamp* p_deadline)
+{
+  // Lanes share the deadlines of the client that owns them.
+  POCOClient& root = (p_root_ ? *p_root_ : *this);
+
+  ScopedLock<Mutex> lock(root.deadlines_mutex_);
+
+  std::map<Thread::TID, Timestamp>::const_iterator it = root.deadlines_.find(Thread::currentTid());
+
+  if (it == root.deadlines_.end())
+  {
+    return false;
+  }
+
+  *p_deadline = it->second;
+  return true;
+}
+
+void POCOClient::applyDeadline()
+{
+  Timestamp deadline;
+
+  if (findDeadline(&deadline))
   {
-    result.status = POCOResult::EXCEPTION_POCO_NET;
-    result.exception_message = e.displayText();
+    Timestamp::TimeDiff remaining = deadline - Timestamp();
+
+    if (remaining <= 0)
+    {
+      throw TimeoutException("Deadline exceeded");
+    }
+
+    applyTimeout(remaining);
+    deadline_applied_ = true;
   }
+}
 
-  if (result.status != POCOResult::OK)
+void POCOClient::restoreTimeout()
+{
+  if (deadline_applied_)
   {
-    cookies_.clear();
-    http_client_session_.reset();
+    applyTimeout(http_timeout_);
+    deadline_applied_ = false;
   }
+}
 
-  return result;
+void POCOClient::applyTimeout(const Poco::Int64 timeout)
+{
+  // The session's timeout is used when (re)connecting, and the socket's timeouts for the kept-alive connection.
+  http_client_session_.setTimeout(Timespan(timeout));
+
+  if (http_client_session_.connected())
+  {
+    http_client_session_.socket().setSendTimeout(Timespan(timeout));
+    http_client_session_.socket().setReceiveTimeout(Timespan(timeout));
+  }
 }
 
-POCOClient::POCOResult POCOClient::webSocketConnect(const std::string& uri,
-                                                    const std::string& protocol,
-                                                    const Poco::Int64 timeout)
+bool POCOClient::acquireAdmission(const size_t cost, bool* p_admitted)
 {
-  // Lock the object's mutex. It is released when the method goes out of scope.
-  ScopedLock<Mutex> lock(http_mutex_);
+  // Lanes share the admission control of the client that owns them.
+  if (p_root_)
+  {
+    return p_root_->acquireAdmission(cost, p_admitted);
+  }
 
-  // Result of the communication.
-  POCOResult result;
+  *p_admitted = false;
 
-  // The response and the request.
-  HTTPResponse response;
-  HTTPRequest request(HTTPRequest::HTTP_GET, uri, HTTPRequest::HTTP_1_1);
-  request.set("Sec-WebSocket-Protocol", protocol);
-  request.setCookies(cookies_);
+  Timestamp queued;
+  Timestamp deadline;
+  const bool has_deadline = findDeadline(&deadline);
+  const Priority priority = findPriority();
 
-  // Attempt the communication.
-  try
+  ScopedLock<Mutex> lock(admission_mutex_);
+
+  if (!admission_enabled_)
   {
-    result.addHTTPRequestInfo(request);
+    return true;
+  }
+
+  const std::pair<int, UInt64> ticket(priority, next_ticket_++);
+  admission_queue_.insert(ticket);
+
+  while (admission_enabled_)
+  {
+    refillTokens();
 
+    const double tokens_needed = std::min(static_cast<double>(cost), admission_options_.burst);
+    const bool first = (*admission_queue_.begin() == ticket);
+    const bool tokens_available = (admission_options_.rate <= 0.0 || tokens_ >= tokens_needed);
+
+    // CONTROL requests are exempt from the concurrency limit, so they never wait behind long transfers.
+    const bool slot_available = (priority == CONTROL ||
+                                 static_cast<double>(admission_metrics_.in_flight - control_in_flight_) <
+                                 concurrency_limit_);
+
+    if (first && tokens_available && slot_available)
     {
-      // We must have at least websocket_connect_mutext_.
-      // If a connection already exists, we must also have websocket_use_mutex_.
-      // If not, nobody should have the mutex anyway, so we should get it immediately.
-      ScopedLock<Mutex> connect_lock(websocket_connect_mutex_);
-      ScopedLock<Mutex> use_lock(websocket_use_mutex_);
+      if (admission_options_.rate > 0.0)
+      {
+        tokens_ -= tokens_needed;
+      }
 
-      p_websocket_ = new WebSocket(http_client_session_, request, response);
-      p_websocket_->setReceiveTimeout(Poco::Timespan(timeout));
+      *p_admitted = true;
+      break;
     }
 
-    result.addHTTPResponseInfo(response);
-    result.status = POCOResult::OK;
+    // Wait for a state change (e.g. a released request), or until enough tokens have been refilled.
+    long wait = 1000;
+
+    if (first && !tokens_available)
+    {
+      wait = static_cast<long>((tokens_needed - tokens_) / admission_options_.rate * 1000.0) + 1;
+    }
+
+    if (has_deadline)
+    {
+      Timestamp::TimeDiff remaining = deadline - Timestamp();
+
+      if (remaining <= 0)
+      {
+        admission_queue_.erase(ticket);
+        admission_condition_.broadcast();
+        return false;
+      }
+
+      wait = std::min(wait, static_cast<long>(remaining / 1000 + 1));
+    }
+
+    admission_condition_.tryWait(admission_mutex_, wait);
   }
-  catch (InvalidArgumentException& e)
+
+  admission_queue_.erase(ticket);
+
+  if (*p_admitted)
   {
-    result.status = POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT;
-    result.exception_message = e.displayText();
+    const Timestamp::TimeDiff wait = queued.elapsed();
+
+    ++admission_metrics_.in_flight;
+    ++admission_metrics_.admitted;
+
+    if (priority == CONTROL)
+    {
+      ++control_in_flight_;
+    }
+
+    admission_metrics_.last_wait = wait;
+    admission_metrics_.average_wait = (admission_metrics_.admitted == 1 ?
+                                       wait : (7 * admission_metrics_.average_wait + wait) / 8);
+    admission_metrics_.max_wait = std::max(admission_metrics_.max_wait, wait);
   }
-  catch (TimeoutException& e)
+
+  // The next request in the queue may be admissible now.
+  admission_condition_.broadcast();
+
+  return true;
+}
+
+void POCOClient::releaseAdmission(const Poco::Int64 latency, const bool sample_latency)
+{
+  if (p_root_)
   {
-    result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
-    result.exception_message = e.displayText();
+    p_root_->releaseAdmission(latency, sample_latency);
+    return;
   }
-  catch (WebSocketException& e)
+
+  // The request was admitted on the same thread, i.e. with the same priority.
+  const Priority priority = findPriority();
+
+  ScopedLock<Mutex> lock(admission_mutex_);
+
+  if (admission_metrics_.in_flight > 0)
   {
-    result.status = POCOResult::EXCEPTION_POCO_WEBSOCKET;
-    result.exception_message = e.displayText();
+    --admission_metrics_.in_flight;
   }
-  catch (NetException& e)
+
+  if (priority == CONTROL && control_in_flight_ > 0)
   {
-    result.status = POCOResult::EXCEPTION_POCO_NET;
-    result.exception_message = e.displayText();
+    --control_in_flight_;
   }
 
-  if (result.status != POCOResult::OK)
+  // Adapt the concurrency limit to the latency (additive increase, multiplicative decrease). The latencies of bulk
+  // transfers depend on their sizes, so they are left out.
+  if (admission_enabled_ && admission_options_.latency_target > 0 && sample_latency && priority != BULK)
   {
-    http_client_session_.reset();
+    if (latency > admission_options_.latency_target)
+    {
+      // Decrease at most once per latency target, since the requests in progress were admitted under the old limit.
+      if (last_decrease_.isElapsed(admission_options_.latency_target))
+      {
+        concurrency_limit_ = std::max(static_cast<double>(admission_options_.min_concurrency),
+                                      concurrency_limit_ * 0.75);
+        last_decrease_.update();
+      }
+    }
+    else
+    {
+      concurrency_limit_ = std::min(static_cast<double>(admission_options_.max_concurrency),
+                                    concurrency_limit_ + 1.0 / concurrency_limit_);
+    }
   }
 
-  return result;
+  admission_condition_.broadcast();
 }
 
-POCOClient::POCOResult POCOClient::webSocketReceiveFrame()
+void POCOClient::refillTokens()
 {
-  // Lock the object's mutex. It is released when the method goes out of scope.
-  ScopedLock<Mutex> lock(websocket_use_mutex_);
+  Timestamp now;
 
-  // Result of the communication.
-  POCOResult result;
+  if (admission_options_.rate > 0.0)
+  {
+    tokens_ = std::min(admission_options_.burst,
+                       tokens_ + static_cast<double>(now - last_refill_) / 1e6 * admission_options_.rate);
+  }
 
-  // Attempt the communication.
-  try
+  last_refill_ = now;
+}
+
+POCOClient::Priority POCOClient::findPriority()
+{
+  // Lanes share the priorities of the client that owns them.
+  POCOClient& root = (p_root_ ? *p_root_ : *this);
+
+  ScopedLock<Mutex> lock(root.lanes_mutex_);
+
+  std::map<Thread::TID, Priority>::const_iterator it = root.priorities_.find(Thread::currentTid());
+
+  return (it == root.priorities_.end() ? INTERACTIVE : it->second);
+}
+
+POCOClient* POCOClient::findLane()
+{
+  if (p_root_)
   {
-    if (!p_websocket_.isNull())
-    {
-      int flags = 0;
-      std::string content;
+    return this;
+  }
 
-      // Wait for (non-ping) WebSocket frames.
-      do
-      {
-        flags = 0;
-        int number_of_bytes_received = p_websocket_->receiveFrame(websocket_buffer_, sizeof(websocket_buffer_), flags);
-        content = std::string(websocket_buffer_, number_of_bytes_received);
+  const Priority priority = findPriority();
 
-        // Check for ping frame.
-        if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING)
-        {
-          // Reply with a pong frame.
-          p_websocket_->sendFrame(websocket_buffer_,
-                                  number_of_bytes_received,
-                                  WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG);
-        }
-      } while ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING);
+  if (priority == INTERACTIVE)
+  {
+    return this;
+  }
 
-      // Check for closing frame.
-      if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_CLOSE)
-      {
-        // Do not pass content of a closing frame to end user,
-        // according to "The WebSocket Protocol" RFC6455.
-        content.clear();
+  {
+    ScopedLock<Mutex> lock(lanes_mutex_);
 
-        // Shutdown the WebSocket.
-        p_websocket_->shutdown();
-        p_websocket_ = 0;
-      }
+    SharedPtr<POCOClient>& p_lane = (priority == CONTROL ? p_control_lane_ : p_bulk_lane_);
 
-      result.addWebSocketFrameInfo(flags, content);
-      result.status = POCOResult::OK;
-    }
-    else
+    if (!p_lane.isNull())
     {
-      result.status = POCOResult::WEBSOCKET_NOT_ALLOCATED;
+      return p_lane.get();
     }
   }
-  catch (InvalidArgumentException& e)
+
+  // Snapshot the client's settings under the settings mutex (never the object's mutex, which is held while a request
+  // is in progress, so the lane's first request would otherwise queue behind it). It is held while the lane is
+  // created, so a concurrent setter either is seen by the snapshot, or finds the lane afterwards and updates it.
+  FastMutex::ScopedLock settings_lock(settings_mutex_);
+  const Poco::Int64 http_timeout = http_timeout_;
+  const TransportOptions transport_options = transport_options_;
+  const bool accept_compressed_responses = accept_compressed_responses_;
+  const bool compress_requests = compress_requests_;
+
+  ScopedLock<Mutex> lock(lanes_mutex_);
+
+  SharedPtr<POCOClient>& p_lane = (priority == CONTROL ? p_control_lane_ : p_bulk_lane_);
+
+  if (p_lane.isNull())
   {
-    result.status = POCOResult::EXCEPTION_POCO_INVALID_ARGUMENT;
-    result.exception_message = e.displayText();
+    p_lane = new POCOClient(ip_address_, port_, username_, password_, tls_);
+    p_lane->p_root_ = this;
+    p_lane->setHTTPTimeout(http_timeout);
+    p_lane->setTransportOptions(transport_options);
+    p_lane->setCompression(accept_compressed_responses, compress_requests);
   }
-  catch (TimeoutException& e)
+
+  return p_lane.get();
+}
+
+std::vector<SharedPtr<POCOClient> > POCOClient::createdLanes()
+{
+  ScopedLock<Mutex> lock(lanes_mutex_);
+
+  std::vector<SharedPtr<POCOClient> > result;
+
+  if (!p_control_lane_.isNull())
   {
-    result.status = POCOResult::EXCEPTION_POCO_TIMEOUT;
-    result.exception_message = e.displayText();
+    result.push_back(p_control_lane_);
   }
-  catch (WebSocketException& e)
+
+  if (!p_bulk_lane_.isNull())
   {
-    result.status = POCOResult::EXCEPTION_POCO_WEBSOCKET;
-    result.exception_message = e.displayText();
+    result.push_back(p_bulk_lane_);
   }
-  catch (NetException& e)
+
+  return result;
+}
+
+Poco::Net::HTTPClientSession* POCOClient::createSession(const std::string& ip_address,
+                                                        const Poco::UInt16 port,
+                                                        const TLSOptions& tls)
+{
+  if (!tls.enabled)
   {
-    result.status = POCOResult::EXCEPTION_POCO_NET;
-    result.exception_message = e.displayText();
+    return new KeptAliveSession(ip_address, port);
   }
 
-  if (result.status != POCOResult::OK)
+#if defined(ABB_LIBRWS_WITH_NETSSL)
+  Context::Ptr p_context = new Context(Context::CLIENT_USE,
+                                       "",
+                                       "",
+                                       tls.ca_location,
+                                       tls.verify_peer ? Context::VERIFY_RELAXED : Context::VERIFY_NONE,
+                                       9,
+                                       tls.ca_location.empty());
+
+  // With the session cache enabled, the HTTPS session offers its previous TLS session on each reconnect, so only
+  // the first connection pays for a full handshake.
+  if (tls.session_resumption)
   {
-    http_client_session_.reset();
+    p_context->enableSessionCache(true);
   }
 
-  return result;
+  return new HTTPSClientSession(ip_address, port, p_context);
+#else
+  throw NotImplementedException("HTTPS requires the library to be built with ABB_LIBRWS_WITH_NETSSL");
+#endif
 }
 
-void POCOClient::webSocketShutdown()
+void POCOClient::replaceConnection()
 {
-  // Make sure nobody is connecting while we're closing.
-  ScopedLock<Mutex> connect_lock(websocket_connect_mutex_);
+  http_client_session_.reset();
 
-  // Make sure there is actually a connection to close.
-  if (!webSocketExist())
+  if (spare_ready_ && p_kept_alive_session_)
   {
-    return;
+    p_kept_alive_session_->attachSocket(spare_socket_);
+    spare_socket_ = StreamSocket();
+    spare_ready_ = false;
   }
+}
 
-  // Shut down the socket. This should make webSocketReceiveFrame() return as soon as possible.
-  p_websocket_->shutdown();
+void POCOClient::keepSession()
+{
+  // Check a few times per interval, so that the idle time never exceeds the interval by much.
+  long check_interval = std::max(static_cast<long>(keeper_interval_ / 4000), 1L);
 
-  // Also acquire the websocket lock before invalidating the pointer,
-  // or we will break running calls to webSocketReceiveFrame().
-  ScopedLock<Mutex> use_lock(websocket_use_mutex_);
-  p_websocket_ = Poco::SharedPtr<Poco::Net::WebSocket>();
+  do
+  {
+    refreshSession();
+    refreshSpareConnection();
+  } while (!keeper_stop_event_.tryWait(check_interval));
 }
 
-/************************************************************
- * Auxiliary methods
- */
-
-void POCOClient::sendAndReceive(POCOResult& result,
-                                HTTPRequest& request,
-                                HTTPResponse& response,
-                                const std::string& request_content)
+void POCOClient::refreshSession()
 {
-  // Add request info to the result.
-  result.addHTTPRequestInfo(request, request_content);
+  // Skip the refresh if the client is busy, since the session is then in use anyway.
+  if (!http_mutex_.tryLock())
+  {
+    return;
+  }
 
-  // Contact the server.
-  std::string response_content;
-  http_client_session_.sendRequest(request) << request_content;
-  StreamCopier::copyToString(http_client_session_.receiveResponse(response), response_content);
+  // Connect and authenticate up front, and refresh the session before the server considers it idle.
+  if (!http_client_session_.connected() || last_activity_.isElapsed(keeper_interval_))
+  {
+    // Refreshes bypass the admission control, since the session is already locked.
+    performHTTPRequest(HTTPRequest::HTTP_GET, keeper_uri_, "", 0, 0);
+  }
 
-  // Add response info to the result.
-  result.addHTTPResponseInfo(response, response_content);
+  http_mutex_.unlock();
 }
 
-void POCOClient::authenticate(POCOResult& result,
-                              HTTPRequest& request,
-                              HTTPResponse& response,
-                              const std::string& request_content)
+void POCOClient::refreshSpareConnection()
 {
-  // Remove any old cookies.
-  cookies_.clear();
+  SocketAddress address;
+  Timespan timeout;
 
-  // Authenticate with the provided credentials.
-  http_credentials_.authenticate(request, response);
+  {
+    ScopedLock<Mutex> lock(http_mutex_);
+
+    // Spare connections are only kept for plain sessions, since a secure session must do its own handshake.
+    if (!p_kept_alive_session_)
+    {
+      return;
+    }
+
+    // The server may close an idle spare connection, so it is replaced at the refresh interval.
+    if (spare_ready_ && !spare_connected_.isElapsed(keeper_interval_))
+    {
+      return;
+    }
+
+    spare_socket_ = StreamSocket();
+    spare_ready_ = false;
+    address = SocketAddress(http_client_session_.getHost(), http_client_session_.getPort());
+    timeout = Timespan(http_timeout_);
+  }
+
+  // Connect without holding the mutex, so ongoing requests are not delayed.
+  StreamSocket socket;
+
+  try
+  {
+    socket.connect(address, timeout);
+  }
+  catch (Poco::Exception&)
+  {
+    return;
+  }
+
+  ScopedLock<Mutex> lock(http_mutex_);
+
+  transport_options_.applyTo(socket);
+  socket.setSendTimeout(Timespan(http_timeout_));
+  socket.setReceiveTimeout(Timespan(http_timeout_));
+  spare_socket_ = socket;
+  spare_ready_ = true;
+  spare_connected_.update();
+}
 
-  // Contact the server, and extract and store the received cookies.
-  sendAndReceive(result, request, response, request_content);
+void POCOClient::storeCookies(const HTTPResponse& response)
+{
   std::vector<HTTPCookie> temp_cookies;
   response.getCookies(temp_cookies);
 
   for (size_t i = 0; i < temp_cookies.size(); ++i)
   {
-    extractAndStoreCookie(temp_cookies[i].toString());
+    if (cookies_.find(temp_cookies[i].getName()) != cookies_.end())
+    {
+      cookies_.set(temp_cookies[i].getName(), temp_cookies[i].getValue());
+    }
+    else
+    {
+      cookies_.add(temp_cookies[i].getName(), temp_cookies[i].getValue());
+    }
   }
 }
 
@@ -0,0 +1,609 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define RWS_POSE_MATH_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RWS_POSE_MATH_SSE
+#endif
+
+#include "abb_librws/rws_pose_math.h"
+
+namespace
+{
+/***********************************************************************************************************************
+ * Instruction set wrappers
+ *
+ * The kernels below are written once, as templates, against the following minimal operation sets.
+ */
+
+/**
+ * \brief Scalar operations (processes one value at a time).
+ */
+struct ScalarOps
+{
+  typedef float V;
+  typedef bool M;
+  static const size_t WIDTH = 1;
+
+  static V load(const float* p) { return *p; }
+  static void store(float* p, const V v) { *p = v; }
+  static V set1(const float v) { return v; }
+  static V add(const V a, const V b) { return a + b; }
+  static V sub(const V a, const V b) { return a - b; }
+  static V mul(const V a, const V b) { return a * b; }
+  static V div(const V a, const V b) { return a / b; }
+  static V sqrt(const V a) { return std::sqrt(a); }
+  static M gt(const V a, const V b) { return a > b; }
+  static M inRange(const V v, const V lo, const V hi) { return v >= lo && v <= hi; }
+  static M isFinite(const V v) { return v - v == 0.0f; }
+  static M both(const M a, const M b) { return a && b; }
+  static V select(const M m, const V a, const V b) { return m ? a : b; }
+  static unsigned int bits(const M m) { return m ? 1u : 0u; }
+};
+
+#ifdef RWS_POSE_MATH_SSE
+/**
+ * \brief SSE operations (processes four values at a time).
+ */
+struct SSEOps
+{
+  typedef __m128 V;
+  typedef __m128 M;
+  static const size_t WIDTH = 4;
+
+  static V load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, const V v) { _mm_storeu_ps(p, v); }
+  static V set1(const float v) { return _mm_set1_ps(v); }
+  static V add(const V a, const V b) { return _mm_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm_div_ps(a, b); }
+  static V sqrt(const V a) { return _mm_sqrt_ps(a); }
+  static M gt(const V a, const V b) { return _mm_cmpgt_ps(a, b); }
+  static M inRange(const V v, const V lo, const V hi) { return _mm_and_ps(_mm_cmpge_ps(v, lo), _mm_cmple_ps(v, hi)); }
+  static M isFinite(const V v) { return _mm_cmpeq_ps(_mm_sub_ps(v, v), _mm_setzero_ps()); }
+  static M both(const M a, const M b) { return _mm_and_ps(a, b); }
+  static V select(const M m, const V a, const V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+  static unsigned int bits(const M m) { return static_cast<unsigned int>(_mm_movemask_ps(m)); }
+};
+#endif
+
+#ifdef RWS_POSE_MATH_AVX
+/**
+ * \brief AVX operations (processes eight values at a time).
+ */
+struct AVXOps
+{
+  typedef __m256 V;
+  typedef __m256 M;
+  static const size_t WIDTH = 8;
+
+  static V load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, const V v) { _mm256_storeu_ps(p, v); }
+  static V set1(const float v) { return _mm256_set1_ps(v); }
+  static V add(const V a, const V b) { return _mm256_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm256_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm256_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm256_div_ps(a, b); }
+  static V sqrt(const V a) { return _mm256_sqrt_ps(a); }
+  static M gt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static M inRange(const V v, const V lo, const V hi)
+  {
+    return _mm256_and_ps(_mm256_cmp_ps(v, lo, _CMP_GE_OQ), _mm256_cmp_ps(v, hi, _CMP_LE_OQ));
+  }
+  static M isFinite(const V v) { return _mm256_cmp_ps(_mm256_sub_ps(v, v), _mm256_setzero_ps(), _CMP_EQ_OQ); }
+  static M both(const M a, const M b) { return _mm256_and_ps(a, b); }
+  static V select(const M m, const V a, const V b) { return _mm256_blendv_ps(b, a, m); }
+  static unsigned int bits(const M m) { return static_cast<unsigned int>(_mm256_movemask_ps(m)); }
+};
+#endif
+
+/**
+ * \brief A struct for a pose in plain floats, with a precomputed rotation matrix.
+ */
+struct Frame
+{
+  /**
+   * \brief A constructor.
+   *
+   * \param pose for the pose to represent.
+   */
+  Frame(const abb::rws::Pose& pose)
+  {
+    t[0] = pose.pos.x.value;
+    t[1] = pose.pos.y.value;
+    t[2] = pose.pos.z.value;
+
+    const float w = pose.rot.q1.value;
+    const float x = pose.rot.q2.value;
+    const float y = pose.rot.q3.value;
+    const float z = pose.rot.q4.value;
+
+    q[0] = w;
+    q[1] = x;
+    q[2] = y;
+    q[3] = z;
+
+    r[0] = 1.0f - 2.0f*(y*y + z*z);
+    r[1] = 2.0f*(x*y - w*z);
+    r[2] = 2.0f*(x*z + w*y);
+    r[3] = 2.0f*(x*y + w*z);
+    r[4] = 1.0f - 2.0f*(x*x + z*z);
+    r[5] = 2.0f*(y*z - w*x);
+    r[6] = 2.0f*(x*z - w*y);
+    r[7] = 2.0f*(y*z + w*x);
+    r[8] = 1.0f - 2.0f*(x*x + y*y);
+  }
+
+  /**
+   * \brief Translation (x, y, z).
+   */
+  float t[3];
+
+  /**
+   * \brief Rotation quaternion (w, x, y, z).
+   */
+  float q[4];
+
+  /**
+   * \brief Row-major rotation matrix.
+   */
+  float r[9];
+};
+
+/**
+ * \brief Pointers to the component arrays of a pose batch.
+ */
+struct PoseArrays
+{
+  float* x;
+  float* y;
+  float* z;
+  float* q1;
+  float* q2;
+  float* q3;
+  float* q4;
+};
+
+/***********************************************************************************************************************
+ * Kernels
+ *
+ * Each kernel processes elements from *p_i, in steps of Ops::WIDTH, for as long as a full step fits.
+ * Calling a kernel with wider operations first, and then with ScalarOps, covers all elements.
+ */
+
+template <typename Ops>
+void normalizeKernel(size_t* p_i, const size_t n, float* q1, float* q2, float* q3, float* q4)
+{
+  typedef typename Ops::V V;
+  const V zero = Ops::set1(0.0f);
+  const V one = Ops::set1(1.0f);
+
+  for (; *p_i + Ops::WIDTH <= n; *p_i += Ops::WIDTH)
+  {
+    const size_t i = *p_i;
+    V a = Ops::load(q1 + i);
+    V b = Ops::load(q2 + i);
+    V c = Ops::load(q3 + i);
+    V d = Ops::load(q4 + i);
+
+    V n2 = Ops::add(Ops::add(Ops::mul(a, a), Ops::mul(b, b)), Ops::add(Ops::mul(c, c), Ops::mul(d, d)));
+    V inv = Ops::select(Ops::gt(n2, zero), Ops::div(one, Ops::sqrt(n2)), one);
+
+    Ops::store(q1 + i, Ops::mul(a, inv));
+    Ops::store(q2 + i, Ops::mul(b, inv));
+    Ops::store(q3 + i, Ops::mul(c, inv));
+    Ops::store(q4 + i, Ops::mul(d, inv));
+  }
+}
+
+template <typename Ops>
+void scaleKernel(size_t* p_i, const size_t n, float* values, const float factor)
+{
+  typedef typename Ops::V V;
+  const V f = Ops::set1(factor);
+
+  for (; *p_i + Ops::WIDTH <= n; *p_i += Ops::WIDTH)
+  {
+    Ops::store(values + *p_i, Ops::mul(Ops::load(values + *p_i), f));
+  }
+}
+
+/**
+ * \brief Calculates frame * pose[i], i.e. p' = R_f * p + t_f and q' = q_f * q.
+ */
+template <typename Ops>
+void transformKernel(size_t* p_i, const size_t n, const Frame& frame, const PoseArrays& a)
+{
+  typedef typename Ops::V V;
+  const V r0 = Ops::set1(frame.r[0]), r1 = Ops::set1(frame.r[1]), r2 = Ops::set1(frame.r[2]);
+  const V r3 = Ops::set1(frame.r[3]), r4 = Ops::set1(frame.r[4]), r5 = Ops::set1(frame.r[5]);
+  const V r6 = Ops::set1(frame.r[6]), r7 = Ops::set1(frame.r[7]), r8 = Ops::set1(frame.r[8]);
+  const V tx = Ops::set1(frame.t[0]), ty = Ops::set1(frame.t[1]), tz = Ops::set1(frame.t[2]);
+  const V fw = Ops::set1(frame.q[0]), fx = Ops::set1(frame.q[1]), fy = Ops::set1(frame.q[2]), fz = Ops::set1(frame.q[3]);
+
+  for (; *p_i + Ops::WIDTH <= n; *p_i += Ops::WIDTH)
+  {
+    const size_t i = *p_i;
+    V x = Ops::load(a.x + i);
+    V y = Ops::load(a.y + i);
+    V z = Ops::load(a.z + i);
+
+    Ops::store(a.x + i, Ops::add(Ops::add(Ops::mul(r0, x), Ops::mul(r1, y)), Ops::add(Ops::mul(r2, z), tx)));
+    Ops::store(a.y + i, Ops::add(Ops::add(Ops::mul(r3, x), Ops::mul(r4, y)), Ops::add(Ops::mul(r5, z), ty)));
+    Ops::store(a.z + i, Ops::add(Ops::add(Ops::mul(r6, x), Ops::mul(r7, y)), Ops::add(Ops::mul(r8, z), tz)));
+
+    V w = Ops::load(a.q1 + i);
+    V qx = Ops::load(a.q2 + i);
+    V qy = Ops::load(a.q3 + i);
+    V qz = Ops::load(a.q4 + i);
+
+    Ops::store(a.q1 + i, Ops::sub(Ops::sub(Ops::mul(fw, w), Ops::mul(fx, qx)),
+                                  Ops::add(Ops::mul(fy, qy), Ops::mul(fz, qz))));
+    Ops::store(a.q2 + i, Ops::add(Ops::add(Ops::mul(fw, qx), Ops::mul(fx, w)),
+                                  Ops::sub(Ops::mul(fy, qz), Ops::mul(fz, qy))));
+    Ops::store(a.q3 + i, Ops::add(Ops::sub(Ops::mul(fw, qy), Ops::mul(fx, qz)),
+                                  Ops::add(Ops::mul(fy, w), Ops::mul(fz, qx))));
+    Ops::store(a.q4 + i, Ops::add(Ops::sub(Ops::mul(fw, qz), Ops::mul(fy, qx)),
+                                  Ops::add(Ops::mul(fx, qy), Ops::mul(fz, w))));
+  }
+}
+
+/**
+ * \brief Calculates pose[i] * frame, i.e. p' = p + R(q) * t_f and q' = q * q_f.
+ */
+template <typename Ops>
+void offsetKernel(size_t* p_i, const size_t n, const Frame& frame, const PoseArrays& a)
+{
+  typedef typename Ops::V V;
+  const V two = Ops::set1(2.0f);
+  const V tx = Ops::set1(frame.t[0]), ty = Ops::set1(frame.t[1]), tz = Ops::set1(frame.t[2]);
+  const V fw = Ops::set1(frame.q[0]), fx = Ops::set1(frame.q[1]), fy = Ops::set1(frame.q[2]), fz = Ops::set1(frame.q[3]);
+
+  for (; *p_i + Ops::WIDTH <= n; *p_i += Ops::WIDTH)
+  {
+    const size_t i = *p_i;
+    V w = Ops::load(a.q1 + i);
+    V qx = Ops::load(a.q2 + i);
+    V qy = Ops::load(a.q3 + i);
+    V qz = Ops::load(a.q4 + i);
+
+    // Rotate the frame's translation: c = 2 * (u x t), t' = t + w * c + u x c, where u = (qx, qy, qz).
+    V cx = Ops::mul(two, Ops::sub(Ops::mul(qy, tz), Ops::mul(qz, ty)));
+    V cy = Ops::mul(two, Ops::sub(Ops::mul(qz, tx), Ops::mul(qx, tz)));
+    V cz = Ops::mul(two, Ops::sub(Ops::mul(qx, ty), Ops::mul(qy, tx)));
+
+    V rx = Ops::add(Ops::add(tx, Ops::mul(w, cx)), Ops::sub(Ops::mul(qy, cz), Ops::mul(qz, cy)));
+    V ry = Ops::add(Ops::add(ty, Ops::mul(w, cy)), Ops::sub(Ops::mul(qz, cx), Ops::mul(qx, cz)));
+    V rz = Ops::add(Ops::add(tz, Ops::mul(w, cz)), Ops::sub(Ops::mul(qx, cy), Ops::mul(qy, cx)));
+
+    Ops::store(a.x + i, Ops::add(Ops::load(a.x + i), rx));
+    Ops::store(a.y + i, Ops::add(Ops::load(a.y + i), ry));
+    Ops::store(a.z + i, Ops::add(Ops::load(a.z + i), rz));
+
+    Ops::store(a.q1 + i, Ops::sub(Ops::sub(Ops::mul(w, fw), Ops::mul(qx, fx)),
+                                  Ops::add(Ops::mul(qy, fy), Ops::mul(qz, fz))));
+    Ops::store(a.q2 + i, Ops::add(Ops::add(Ops::mul(w, fx), Ops::mul(qx, fw)),
+                                  Ops::sub(Ops::mul(qy, fz), Ops::mul(qz, fy))));
+    Ops::store(a.q3 + i, Ops::add(Ops::sub(Ops::mul(w, fy), Ops::mul(qx, fz)),
+                                  Ops::add(Ops::mul(qy, fw), Ops::mul(qz, fx))));
+    Ops::store(a.q4 + i, Ops::add(Ops::sub(Ops::mul(w, fz), Ops::mul(qy, fx)),
+                                  Ops::add(Ops::mul(qx, fy), Ops::mul(qz, fw))));
+  }
+}
+
+template <typename Ops>
+size_t validateKernel(size_t* p_i,
+                      const size_t n,
+                      const float tolerance,
+                      const float* x, const float* y, const float* z,
+                      const float* q1, const float* q2, const float* q3, const float* q4,
+                      unsigned char* p_valid)
+{
+  typedef typename Ops::V V;
+  typedef typename Ops::M M;
+  const V lo = Ops::set1(1.0f - tolerance);
+  const V hi = Ops::set1(1.0f + tolerance);
+  size_t invalid = 0;
+
+  for (; *p_i + Ops::WIDTH <= n; *p_i += Ops::WIDTH)
+  {
+    const size_t i = *p_i;
+    V a = Ops::load(q1 + i);
+    V b = Ops::load(q2 + i);
+    V c = Ops::load(q3 + i);
+    V d = Ops::load(q4 + i);
+    V n2 = Ops::add(Ops::add(Ops::mul(a, a), Ops::mul(b, b)), Ops::add(Ops::mul(c, c), Ops::mul(d, d)));
+
+    // The position components are checked separately, since the sum of large finite values may overflow.
+    M finite = Ops::both(Ops::both(Ops::isFinite(Ops::load(x + i)), Ops::isFinite(Ops::load(y + i))),
+                         Ops::isFinite(Ops::load(z + i)));
+    M ok = Ops::both(Ops::inRange(n2, lo, hi), finite);
+    unsigned int mask = Ops::bits(ok);
+
+    for (size_t j = 0; j < Ops::WIDTH; ++j)
+    {
+      unsigned char valid = static_cast<unsigned char>((mask >> j) & 1u);
+      invalid += (valid ? 0 : 1);
+      if (p_valid)
+      {
+        p_valid[i + j] = valid;
+      }
+    }
+  }
+
+  return invalid;
+}
+
+/**
+ * \brief A function for collecting the component array pointers of a pose batch.
+ */
+PoseArrays poseArrays(abb::rws::PosBatch* p_pos, abb::rws::OrientBatch* p_orient)
+{
+  PoseArrays a;
+  a.x = p_pos->x.data();
+  a.y = p_pos->y.data();
+  a.z = p_pos->z.data();
+  a.q1 = p_orient->q1.data();
+  a.q2 = p_orient->q2.data();
+  a.q3 = p_orient->q3.data();
+  a.q4 = p_orient->q4.data();
+  return a;
+}
+}
+
+namespace abb
+{
+namespace rws
+{
+/***********************************************************************************************************************
+ * Function definitions
+ */
+
+const char* poseMathInstructionSet()
+{
+#if defined(RWS_POSE_MATH_AVX)
+  return "AVX";
+#elif defined(RWS_POSE_MATH_SSE)
+  return "SSE";
+#else
+  return "scalar";
+#endif
+}
+
+Pose composePose(const Pose& a, const Pose& b)
+{
+  Pose result;
+
+  PosBatch pos;
+  OrientBatch orient;
+  pos.resize(1);
+  orient.resize(1);
+  pos.set(0, b.pos);
+  orient.set(0, b.rot);
+
+  size_t i = 0;
+  transformKernel<ScalarOps>(&i, 1, Frame(a), poseArrays(&pos, &orient));
+
+  pos.get(0, &result.pos);
+  orient.get(0, &result.rot);
+
+  return result;
+}
+
+Pose invertPose(const Pose& pose)
+{
+  Pose result;
+
+  // The inverse rotation is the quaternion's conjugate.
+  result.rot.q1.value = pose.rot.q1.value;
+  result.rot.q2.value = -pose.rot.q2.value;
+  result.rot.q3.value = -pose.rot.q3.value;
+  result.rot.q4.value = -pose.rot.q4.value;
+
+  // The inverse translation is -(R^T * t).
+  Frame frame(pose);
+  result.pos.x.value = -(frame.r[0]*frame.t[0] + frame.r[3]*frame.t[1] + frame.r[6]*frame.t[2]);
+  result.pos.y.value = -(frame.r[1]*frame.t[0] + frame.r[4]*frame.t[1] + frame.r[7]*frame.t[2]);
+  result.pos.z.value = -(frame.r[2]*frame.t[0] + frame.r[5]*frame.t[1] + frame.r[8]*frame.t[2]);
+
+  return result;
+}
+
+void normalizeOrientations(OrientBatch* p_orient)
+{
+  if (p_orient)
+  {
+    const size_t n = p_orient->size();
+    float* q1 = p_orient->q1.data();
+    float* q2 = p_orient->q2.data();
+    float* q3 = p_orient->q3.data();
+    float* q4 = p_orient->q4.data();
+    size_t i = 0;
+
+#ifdef RWS_POSE_MATH_AVX
+    normalizeKernel<AVXOps>(&i, n, q1, q2, q3, q4);
+#endif
+#ifdef RWS_POSE_MATH_SSE
+    normalizeKernel<SSEOps>(&i, n, q1, q2, q3, q4);
+#endif
+    normalizeKernel<ScalarOps>(&i, n, q1, q2, q3, q4);
+  }
+}
+
+void scalePositions(PosBatch* p_pos, const float factor)
+{
+  if (p_pos)
+  {
+    std::vector<float>* components[] = {&p_pos->x, &p_pos->y, &p_pos->z};
+
+    for (size_t c = 0; c < 3; ++c)
+    {
+      const size_t n = components[c]->size();
+      float* values = components[c]->data();
+      size_t i = 0;
+
+#ifdef RWS_POSE_MATH_AVX
+      scaleKernel<AVXOps>(&i, n, values, factor);
+#endif
+#ifdef RWS_POSE_MATH_SSE
+      scaleKernel<SSEOps>(&i, n, values, factor);
+#endif
+      scaleKernel<ScalarOps>(&i, n, values, factor);
+    }
+  }
+}
+
+void transformPoses(const Pose& frame, PosBatch* p_pos, OrientBatch* p_orient)
+{
+  if (p_pos && p_orient && p_pos->size() == p_orient->size())
+  {
+    const Frame f(frame);
+    const PoseArrays a = poseArrays(p_pos, p_orient);
+    const size_t n = p_pos->size();
+    size_t i = 0;
+
+#ifdef RWS_POSE_MATH_AVX
+    transformKernel<AVXOps>(&i, n, f, a);
+#endif
+#ifdef RWS_POSE_MATH_SSE
+    transformKernel<SSEOps>(&i, n, f, a);
+#endif
+    transformKernel<ScalarOps>(&i, n, f, a);
+  }
+}
+
+void offsetPoses(PosBatch* p_pos, OrientBatch* p_orient, const Pose& frame)
+{
+  if (p_pos && p_orient && p_pos->size() == p_orient->size())
+  {
+    const Frame f(frame);
+    const PoseArrays a = poseArrays(p_pos, p_orient);
+    const size_t n = p_pos->size();
+    size_t i = 0;
+
+#ifdef RWS_POSE_MATH_AVX
+    offsetKernel<AVXOps>(&i, n, f, a);
+#endif
+#ifdef RWS_POSE_MATH_SSE
+    offsetKernel<SSEOps>(&i, n, f, a);
+#endif
+    offsetKernel<ScalarOps>(&i, n, f, a);
+  }
+}
+
+void transformPoses(const Pose& frame, PoseBatch* p_poses)
+{
+  if (p_poses)
+  {
+    transformPoses(frame, &p_poses->pos, &p_poses->rot);
+  }
+}
+
+void transformFromWObj(const WObjData& wobj, RobTargetBatch* p_robtargets)
+{
+  if (p_robtargets)
+  {
+    transformPoses(composePose(wobj.uframe, wobj.oframe), &p_robtargets->pos, &p_robtargets->orient);
+  }
+}
+
+void transformToWObj(const WObjData& wobj, RobTargetBatch* p_robtargets)
+{
+  if (p_robtargets)
+  {
+    transformPoses(invertPose(composePose(wobj.uframe, wobj.oframe)), &p_robtargets->pos, &p_robtargets->orient);
+  }
+}
+
+void removeTool(const ToolData& tool, RobTargetBatch* p_robtargets)
+{
+  if (p_robtargets)
+  {
+    offsetPoses(&p_robtargets->pos, &p_robtargets->orient, invertPose(tool.tframe));
+  }
+}
+
+void applyTool(const ToolData& tool, RobTargetBatch* p_robtargets)
+{
+  if (p_robtargets)
+  {
+    offsetPoses(&p_robtargets->pos, &p_robtargets->orient, tool.tframe);
+  }
+}
+
+size_t validatePoses(const PosBatch& pos,
+                     const OrientBatch& orient,
+                     const float tolerance,
+                     std::vector<unsigned char>* p_valid)
+{
+  const size_t n = (pos.size() < orient.size() ? pos.size() : orient.size());
+  size_t invalid = 0;
+  size_t i = 0;
+  unsigned char* valid = 0;
+
+  if (p_valid)
+  {
+    p_valid->resize(n);
+    valid = p_valid->data();
+  }
+
+#ifdef RWS_POSE_MATH_AVX
+  invalid += validateKernel<AVXOps>(&i, n, tolerance,
+                                    pos.x.data(), pos.y.data(), pos.z.data(),
+                                    orient.q1.data(), orient.q2.data(), orient.q3.data(), orient.q4.data(), valid);
+#endif
+#ifdef RWS_POSE_MATH_SSE
+  invalid += validateKernel<SSEOps>(&i, n, tolerance,
+                                    pos.x.data(), pos.y.data(), pos.z.data(),
+                                    orient.q1.data(), orient.q2.data(), orient.q3.data(), orient.q4.data(), valid);
+#endif
+  invalid += validateKernel<ScalarOps>(&i, n, tolerance,
+                                       pos.x.data(), pos.y.data(), pos.z.data(),
+                                       orient.q1.data(), orient.q2.data(), orient.q3.data(), orient.q4.data(), valid);
+
+  return invalid;
+}
+
+} // end namespace rws
+} // end namespace abb
@@ -34,11 +34,18 @@
  ***********************************************************************************************************************
  */
 
+#include <cctype>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
 #include <sstream>
 #include <string>
 
 #include "abb_librws/rws_common.h"
 #include "abb_librws/rws_rapid.h"
+#include "abb_librws/rws_rapid_binary.h"
 
 namespace abb
 {
@@ -46,6 +53,257 @@ namespace rws
 {
 typedef SystemConstants::RAPID RAPID;
 
+namespace
+{
+/**
+ * \brief Maximum number of characters in a numerical value string, that is parsed without allocating any memory.
+ */
+const size_t MAX_NUMBER_LENGTH = 63;
+
+/**
+ * \brief Format used when printing numerical values (the same as a default std::stringstream).
+ */
+const char NUMBER_FORMAT[] = "%g";
+
+/**
+ * \brief A function for checking if a string equals a character buffer.
+ *
+ * \param value containing the string to compare.
+ * \param p_characters for the characters to compare with.
+ * \param length specifying the number of characters.
+ *
+ * \return bool indicating if they are equal or not.
+ */
+bool equals(const std::string& value, const char* p_characters, const size_t length)
+{
+  return value.size() == length && value.compare(0, length, p_characters, length) == 0;
+}
+
+/**
+ * \brief A function for checking if the C library's current locale uses '.' as decimal point (as RAPID does).
+ *
+ * Note: The C library's number functions (e.g. strtod and snprintf) follow the LC_NUMERIC locale, so they can
+ *       only be used directly when this holds. Otherwise a stream with the classic "C" locale is used instead.
+ *
+ * \return bool indicating if the decimal point is '.' or not.
+ */
+bool hasRAPIDDecimalPoint()
+{
+  const char* p_decimal_point = std::localeconv()->decimal_point;
+
+  return p_decimal_point && p_decimal_point[0] == '.' && p_decimal_point[1] == '\0';
+}
+
+/**
+ * \brief A function for appending a numerical value, formatted as in a RAPID symbol data value string, to a buffer.
+ *
+ * \param p_buffer for the buffer to append to.
+ * \param value specifying the value to append.
+ */
+void appendNumber(std::string* p_buffer, const double value)
+{
+  if (value == (float) 9E9)
+  {
+    p_buffer->append("9000000000");
+  }
+  else if (hasRAPIDDecimalPoint())
+  {
+    char temp[32];
+    int length = std::snprintf(temp, sizeof(temp), NUMBER_FORMAT, value);
+    p_buffer->append(temp, length > 0 ? length : 0);
+  }
+  else
+  {
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    ss << value;
+    p_buffer->append(ss.str());
+  }
+}
+
+/**
+ * \brief A function for copying a (possibly not null terminated) numerical value string to a stack buffer.
+ *
+ * \param p_value for the characters to copy.
+ * \param length specifying the number of characters.
+ * \param p_buffer for the buffer to copy to (at least MAX_NUMBER_LENGTH + 1 characters).
+ *
+ * \return bool indicating if the characters fit in the buffer or not.
+ */
+bool copyNumber(const char* p_value, const size_t length, char* p_buffer)
+{
+  if (length > MAX_NUMBER_LENGTH)
+  {
+    return false;
+  }
+
+  std::memcpy(p_buffer, p_value, length);
+  p_buffer[length] = '\0';
+
+  return true;
+}
+
+/**
+ * \brief A function for removing the enclosing '[' and ']' of a RAPID record value string
+ *        (as RAPIDRecord::extractDelimitedSubstrings(...)).
+ *
+ * \param pp_begin for the start of the string, updated to the start of the record's fields.
+ * \param pp_end for the end of the string, updated to the end of the record's fields.
+ */
+void stripBrackets(const char** pp_begin, const char** pp_end)
+{
+  const char* p_open = static_cast<const char*>(std::memchr(*pp_begin, '[', *pp_end - *pp_begin));
+  const char* p_close = *pp_end;
+
+  while (p_close != *pp_begin && *(p_close - 1) != ']')
+  {
+    --p_close;
+  }
+
+  if (p_open && p_close != *pp_begin && p_open < p_close - 1)
+  {
+    *pp_begin = p_open + 1;
+    *pp_end = p_close - 1;
+  }
+}
+
+/**
+ * \brief A function for finding the end of a record field, i.e. the next top level ',' (outside of any nested
+ *        records or strings) or the end of the string.
+ *
+ * \param p_field for the start of the field.
+ * \param p_end for the end of the string.
+ *
+ * \return const char* pointing to the field's terminating ',', or p_end.
+ */
+const char* findFieldEnd(const char* p_field, const char* p_end)
+{
+  int depth = 0;
+  bool in_string = false;
+  const char* p = p_field;
+
+  for (; p != p_end && !(*p == ',' && depth == 0 && !in_string); ++p)
+  {
+    if (*p == '"')
+    {
+      in_string = !in_string;
+    }
+    else if (!in_string && *p == '[')
+    {
+      ++depth;
+    }
+    else if (!in_string && *p == ']')
+    {
+      --depth;
+    }
+  }
+
+  return p;
+}
+
+/**
+ * \brief A function for finding a top level field of a RAPID record value string. Empty fields are skipped
+ *        (as RAPIDRecord::extractDelimitedSubstrings(...)).
+ *
+ * \param pp_begin for the start of the record's value string, updated to the start of the field.
+ * \param pp_end for the end of the record's value string, updated to the end of the field.
+ * \param index specifying the field's index.
+ *
+ * \return bool indicating if the field was found or not.
+ */
+bool findField(const char** pp_begin, const char** pp_end, const size_t index)
+{
+  const char* p_end = *pp_end;
+  size_t count = 0;
+
+  stripBrackets(pp_begin, &p_end);
+
+  for (const char* p_field = *pp_begin; ; )
+  {
+    const char* p_field_end = findFieldEnd(p_field, p_end);
+
+    if (p_field_end != p_field)
+    {
+      if (count == index)
+      {
+        *pp_begin = p_field;
+        *pp_end = p_field_end;
+        return true;
+      }
+      ++count;
+    }
+
+    if (p_field_end == p_end)
+    {
+      return false;
+    }
+
+    p_field = p_field_end + 1;
+  }
+}
+}
+
+/***********************************************************************************************************************
+ * Struct definitions: RAPIDSymbolDataAbstract
+ */
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void RAPIDSymbolDataAbstract::appendBinary(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    std::string value_string = constructString();
+    binaryAppendString(p_buffer, value_string.data(), static_cast<Poco::UInt32>(value_string.size()));
+  }
+}
+
+bool RAPIDSymbolDataAbstract::parseBinary(RAPIDBinaryReader* p_reader)
+{
+  const char* p_characters = 0;
+  Poco::UInt32 length = 0;
+
+  if (!p_reader || !p_reader->readString(&p_characters, &length))
+  {
+    return false;
+  }
+
+  parseString(std::string(p_characters, length));
+
+  return true;
+}
+
+bool RAPIDSymbolDataAbstract::skipBinary(RAPIDBinaryReader* p_reader) const
+{
+  const char* p_characters = 0;
+  Poco::UInt32 length = 0;
+
+  return (p_reader && p_reader->readString(&p_characters, &length));
+}
+
+bool RAPIDSymbolDataAbstract::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(getType(), p_type_name, length);
+}
+
+void RAPIDSymbolDataAbstract::parse(const char* p_value, const size_t length)
+{
+  parseString(std::string(p_value, length));
+}
+
+void RAPIDSymbolDataAbstract::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    p_buffer->append(constructString());
+  }
+}
+
+
+
+
 /***********************************************************************************************************************
  * Struct definitions: RAPIDAtomic<RAPIDAtomicTypes>
  */
@@ -86,6 +344,7 @@ std::string RAPIDAtomic<RAPID_NUM>::constructString() const
   if (value != (float) 9E9)
   {
     std::stringstream ss;
+    ss.imbue(std::locale::classic());
     ss << value;
     result = ss.str();
   }
@@ -100,6 +359,7 @@ std::string RAPIDAtomic<RAPID_DNUM>::constructString() const
   if (value != (float) 9E9)
   {
     std::stringstream ss;
+    ss.imbue(std::locale::classic());
     ss << value;
     result = ss.str();
   }
@@ -136,6 +396,217 @@ void RAPIDAtomic<RAPID_STRING>::parseString(const std::string& value_string)
   ss >> value;
 }
 
+bool RAPIDAtomic<RAPID_BOOL>::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(RAPID::TYPE_BOOL, p_type_name, length);
+}
+
+bool RAPIDAtomic<RAPID_NUM>::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(RAPID::TYPE_NUM, p_type_name, length);
+}
+
+bool RAPIDAtomic<RAPID_DNUM>::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(RAPID::TYPE_DNUM, p_type_name, length);
+}
+
+bool RAPIDAtomic<RAPID_STRING>::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(RAPID::TYPE_STRING, p_type_name, length);
+}
+
+void RAPIDAtomic<RAPID_BOOL>::parse(const char* p_value, const size_t length)
+{
+  value = equals(RAPID::RAPID_TRUE, p_value, length);
+}
+
+void RAPIDAtomic<RAPID_NUM>::parse(const char* p_value, const size_t length)
+{
+  char temp[MAX_NUMBER_LENGTH + 1];
+
+  // Fall back to parseString(...), which uses the classic "C" locale, if strtof would misread the decimal point.
+  if (hasRAPIDDecimalPoint() && copyNumber(p_value, length, temp))
+  {
+    value = std::strtof(temp, 0);
+  }
+  else
+  {
+    parseString(std::string(p_value, length));
+  }
+}
+
+void RAPIDAtomic<RAPID_DNUM>::parse(const char* p_value, const size_t length)
+{
+  char temp[MAX_NUMBER_LENGTH + 1];
+
+  // Fall back to parseString(...), which uses the classic "C" locale, if strtod would misread the decimal point.
+  if (hasRAPIDDecimalPoint() && copyNumber(p_value, length, temp))
+  {
+    value = std::strtod(temp, 0);
+  }
+  else
+  {
+    parseString(std::string(p_value, length));
+  }
+}
+
+void RAPIDAtomic<RAPID_STRING>::parse(const char* p_value, const size_t length)
+{
+  const char* p_begin = p_value;
+  const char* p_end = p_value + length;
+
+  // Remove any enclosing quotes, and then (as parseString(...)) keep the first whitespace separated word.
+  if (p_begin != p_end && *p_begin == '"')
+  {
+    ++p_begin;
+  }
+  if (p_end != p_begin && *(p_end - 1) == '"')
+  {
+    --p_end;
+  }
+  while (p_begin != p_end && std::isspace(static_cast<unsigned char>(*p_begin)))
+  {
+    ++p_begin;
+  }
+
+  const char* p_word_end = p_begin;
+  while (p_word_end != p_end && !std::isspace(static_cast<unsigned char>(*p_word_end)))
+  {
+    ++p_word_end;
+  }
+
+  value.assign(p_begin, p_word_end);
+}
+
+void RAPIDAtomic<RAPID_BOOL>::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    p_buffer->append(value ? RAPID::RAPID_TRUE : RAPID::RAPID_FALSE);
+  }
+}
+
+void RAPIDAtomic<RAPID_NUM>::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    appendNumber(p_buffer, value);
+  }
+}
+
+void RAPIDAtomic<RAPID_DNUM>::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    appendNumber(p_buffer, value);
+  }
+}
+
+void RAPIDAtomic<RAPID_STRING>::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    p_buffer->push_back('"');
+    p_buffer->append(value);
+    p_buffer->push_back('"');
+  }
+}
+
+void RAPIDAtomic<RAPID_BOOL>::appendBinary(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    binaryAppendUInt8(p_buffer, value ? 1 : 0);
+  }
+}
+
+void RAPIDAtomic<RAPID_NUM>::appendBinary(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    binaryAppendFloat(p_buffer, value);
+  }
+}
+
+void RAPIDAtomic<RAPID_DNUM>::appendBinary(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    binaryAppendDouble(p_buffer, value);
+  }
+}
+
+void RAPIDAtomic<RAPID_STRING>::appendBinary(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    binaryAppendString(p_buffer, value.data(), static_cast<Poco::UInt32>(value.size()));
+  }
+}
+
+bool RAPIDAtomic<RAPID_BOOL>::parseBinary(RAPIDBinaryReader* p_reader)
+{
+  Poco::UInt8 byte = 0;
+  bool result = (p_reader && p_reader->readUInt8(&byte));
+
+  if (result)
+  {
+    value = (byte != 0);
+  }
+
+  return result;
+}
+
+bool RAPIDAtomic<RAPID_NUM>::parseBinary(RAPIDBinaryReader* p_reader)
+{
+  return (p_reader && p_reader->readFloat(&value));
+}
+
+bool RAPIDAtomic<RAPID_DNUM>::parseBinary(RAPIDBinaryReader* p_reader)
+{
+  return (p_reader && p_reader->readDouble(&value));
+}
+
+bool RAPIDAtomic<RAPID_STRING>::parseBinary(RAPIDBinaryReader* p_reader)
+{
+  const char* p_characters = 0;
+  Poco::UInt32 length = 0;
+  bool result = (p_reader && p_reader->readString(&p_characters, &length));
+
+  if (result)
+  {
+    value.assign(p_characters, length);
+  }
+
+  return result;
+}
+
+bool RAPIDAtomic<RAPID_BOOL>::skipBinary(RAPIDBinaryReader* p_reader) const
+{
+  const char* p_bytes = 0;
+  return (p_reader && p_reader->readBytes(1, &p_bytes));
+}
+
+bool RAPIDAtomic<RAPID_NUM>::skipBinary(RAPIDBinaryReader* p_reader) const
+{
+  const char* p_bytes = 0;
+  return (p_reader && p_reader->readBytes(4, &p_bytes));
+}
+
+bool RAPIDAtomic<RAPID_DNUM>::skipBinary(RAPIDBinaryReader* p_reader) const
+{
+  const char* p_bytes = 0;
+  return (p_reader && p_reader->readBytes(8, &p_bytes));
+}
+
+bool RAPIDAtomic<RAPID_STRING>::skipBinary(RAPIDBinaryReader* p_reader) const
+{
+  const char* p_characters = 0;
+  Poco::UInt32 length = 0;
+  return (p_reader && p_reader->readString(&p_characters, &length));
+}
+
 
 
 
@@ -191,6 +662,103 @@ std::string RAPIDRecord::constructString() const
   return ss.str();
 }
 
+bool RAPIDRecord::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(record_type_name_, p_type_name, length);
+}
+
+void RAPIDRecord::parse(const char* p_value, const size_t length)
+{
+  const char* p_begin = p_value;
+  const char* p_end = p_value + length;
+
+  stripBrackets(&p_begin, &p_end);
+
+  // The first pass counts the top level fields, and the second pass parses them into the components.
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    size_t count = 0;
+
+    for (const char* p_field = p_begin; ; )
+    {
+      const char* p_field_end = findFieldEnd(p_field, p_end);
+
+      if (p_field_end != p_field)
+      {
+        if (pass == 1)
+        {
+          components_[count]->parse(p_field, p_field_end - p_field);
+        }
+        ++count;
+      }
+
+      if (p_field_end == p_end)
+      {
+        break;
+      }
+
+      p_field = p_field_end + 1;
+    }
+
+    if (count != components_.size())
+    {
+      break;
+    }
+  }
+}
+
+void RAPIDRecord::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    p_buffer->push_back('[');
+
+    for (size_t i = 0; i < components_.size(); ++i)
+    {
+      if (i != 0)
+      {
+        p_buffer->push_back(',');
+      }
+
+      components_[i]->appendTo(p_buffer);
+    }
+
+    p_buffer->push_back(']');
+  }
+}
+
+void RAPIDRecord::appendBinary(std::string* p_buffer) const
+{
+  for (size_t i = 0; i < components_.size(); ++i)
+  {
+    components_[i]->appendBinary(p_buffer);
+  }
+}
+
+bool RAPIDRecord::parseBinary(RAPIDBinaryReader* p_reader)
+{
+  bool result = (p_reader != 0);
+
+  for (size_t i = 0; i < components_.size() && result; ++i)
+  {
+    result = components_[i]->parseBinary(p_reader);
+  }
+
+  return result;
+}
+
+bool RAPIDRecord::skipBinary(RAPIDBinaryReader* p_reader) const
+{
+  bool result = (p_reader != 0);
+
+  for (size_t i = 0; i < components_.size() && result; ++i)
+  {
+    result = components_[i]->skipBinary(p_reader);
+  }
+
+  return result;
+}
+
 RAPIDRecord& RAPIDRecord::operator=(const RAPIDRecord& other)
 {
   if (this != &other)
@@ -290,5 +858,123 @@ std::vector<std::string> RAPIDRecord::extractDelimitedSubstrings(const std::stri
   return values;
 }
 
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: RAPIDLazyRecord
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RAPIDLazyRecord::RAPIDLazyRecord(const std::string& record_type_name)
+:
+record_type_name_(record_type_name)
+{}
+
+std::string RAPIDLazyRecord::getType() const
+{
+  return record_type_name_;
+}
+
+void RAPIDLazyRecord::parseString(const std::string& value_string)
+{
+  parse(value_string.data(), value_string.size());
+}
+
+std::string RAPIDLazyRecord::constructString() const
+{
+  return value_;
+}
+
+bool RAPIDLazyRecord::isType(const char* p_type_name, const size_t length) const
+{
+  return equals(record_type_name_, p_type_name, length);
+}
+
+void RAPIDLazyRecord::parse(const char* p_value, const size_t length)
+{
+  value_.assign(p_value, length);
+  fields_.clear();
+
+  const char* p_base = value_.data();
+  const char* p_begin = p_base;
+  const char* p_end = p_base + value_.size();
+
+  stripBrackets(&p_begin, &p_end);
+
+  for (const char* p_field = p_begin; ; )
+  {
+    const char* p_field_end = findFieldEnd(p_field, p_end);
+
+    if (p_field_end != p_field)
+    {
+      fields_.push_back(std::make_pair(p_field - p_base, p_field_end - p_field));
+    }
+
+    if (p_field_end == p_end)
+    {
+      break;
+    }
+
+    p_field = p_field_end + 1;
+  }
+}
+
+void RAPIDLazyRecord::appendTo(std::string* p_buffer) const
+{
+  if (p_buffer)
+  {
+    p_buffer->append(value_);
+  }
+}
+
+size_t RAPIDLazyRecord::getFieldCount() const
+{
+  return fields_.size();
+}
+
+std::string RAPIDLazyRecord::getFieldString(const size_t index) const
+{
+  return (index < fields_.size() ? value_.substr(fields_[index].first, fields_[index].second) : std::string());
+}
+
+bool RAPIDLazyRecord::getField(const size_t index, RAPIDSymbolDataAbstract* p_data) const
+{
+  bool result = (p_data && index < fields_.size());
+
+  if (result)
+  {
+    p_data->parse(value_.data() + fields_[index].first, fields_[index].second);
+  }
+
+  return result;
+}
+
+bool RAPIDLazyRecord::getField(const std::vector<size_t>& path, RAPIDSymbolDataAbstract* p_data) const
+{
+  bool result = (p_data && !path.empty() && path[0] < fields_.size());
+
+  if (result)
+  {
+    const char* p_begin = value_.data() + fields_[path[0]].first;
+    const char* p_end = p_begin + fields_[path[0]].second;
+
+    for (size_t i = 1; i < path.size() && result; ++i)
+    {
+      result = findField(&p_begin, &p_end, path[i]);
+    }
+
+    if (result)
+    {
+      p_data->parse(p_begin, p_end - p_begin);
+    }
+  }
+
+  return result;
+}
+
 } // end namespace rws
 } // end namespace abb
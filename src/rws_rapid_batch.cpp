@@ -0,0 +1,866 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <sstream>
+
+#include "abb_librws/rws_rapid_batch.h"
+
+namespace
+{
+/**
+ * \brief Number of values in a flattened RAPID robtarget record.
+ */
+const size_t ROBTARGET_VALUES = 17;
+
+/**
+ * \brief Number of values in each of a RAPID robtarget record's components (pos, orient, robconf and extax).
+ */
+const size_t ROBTARGET_GROUPS[] = {3, 4, 4, 6};
+
+/**
+ * \brief Number of values in a flattened RAPID jointtarget record.
+ */
+const size_t JOINTTARGET_VALUES = 12;
+
+/**
+ * \brief Number of values in each of a RAPID jointtarget record's components (robax and extax).
+ */
+const size_t JOINTTARGET_GROUPS[] = {6, 6};
+
+/**
+ * \brief Maximum number of characters in a numerical value string, that is parsed without allocating any memory.
+ */
+const size_t MAX_NUMBER_LENGTH = 63;
+
+/**
+ * \brief A function for checking if the C library's current locale uses '.' as decimal point (as RAPID does).
+ *
+ * Note: strtof and snprintf follow the LC_NUMERIC locale, so they can only be used directly when this holds.
+ *
+ * \return bool indicating if the decimal point is '.' or not.
+ */
+bool hasRAPIDDecimalPoint()
+{
+  const char* p_decimal_point = std::localeconv()->decimal_point;
+
+  return p_decimal_point && p_decimal_point[0] == '.' && p_decimal_point[1] == '\0';
+}
+
+/**
+ * \brief A function for skipping whitespace.
+ *
+ * \param p for the current position in a null terminated string.
+ *
+ * \return const char* pointing to the first non-whitespace character.
+ */
+const char* skipWhitespace(const char* p)
+{
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+  {
+    ++p;
+  }
+
+  return p;
+}
+
+/**
+ * \brief A function for parsing a RAPID num value, independently of the current locale.
+ *
+ * \param p for the start of the value in a null terminated string.
+ * \param p_value for storing the parsed value.
+ *
+ * \return const char* pointing to the character after the value, or 0 if it was not a valid value.
+ */
+const char* parseNum(const char* p, float* p_value)
+{
+  const char* p_begin = p;
+
+  while ((*p >= '0' && *p <= '9') || *p == '.' || *p == '+' || *p == '-' || *p == 'e' || *p == 'E')
+  {
+    ++p;
+  }
+
+  size_t length = p - p_begin;
+
+  if (length == 0 || length > MAX_NUMBER_LENGTH)
+  {
+    return 0;
+  }
+
+  if (hasRAPIDDecimalPoint())
+  {
+    char buffer[MAX_NUMBER_LENGTH + 1];
+    char* p_end = 0;
+
+    std::memcpy(buffer, p_begin, length);
+    buffer[length] = '\0';
+    *p_value = std::strtof(buffer, &p_end);
+
+    return (p_end == buffer + length ? p : 0);
+  }
+
+  std::istringstream ss(std::string(p_begin, length));
+  ss.imbue(std::locale::classic());
+  ss >> *p_value;
+
+  return (!ss.fail() && ss.peek() == std::char_traits<char>::eof() ? p : 0);
+}
+
+/**
+ * \brief A function for parsing a RAPID record value string, whose components are all bracketed lists of num values
+ *        (e.g. "[[1,2,3],[1,0,0,0],[0,0,0,0],[9E9,9E9,9E9,9E9,9E9,9E9]]" for a robtarget).
+ *
+ * The record's structure is checked, i.e. the number of components and the number of values in each component.
+ *
+ * \param input containing the string to parse.
+ * \param p_group_sizes for the number of values in each of the record's components.
+ * \param groups specifying the number of components.
+ * \param p_values for storing the values (flattened, i.e. at least the sum of p_group_sizes).
+ *
+ * \return bool indicating if the string was a valid record or not.
+ */
+bool parseNumRecord(const std::string& input, const size_t* p_group_sizes, const size_t groups, float* p_values)
+{
+  const char* p = skipWhitespace(input.c_str());
+
+  if (*p++ != '[')
+  {
+    return false;
+  }
+
+  for (size_t group = 0; group < groups; ++group)
+  {
+    p = skipWhitespace(p);
+
+    if (group != 0)
+    {
+      if (*p++ != ',')
+      {
+        return false;
+      }
+      p = skipWhitespace(p);
+    }
+
+    if (*p++ != '[')
+    {
+      return false;
+    }
+
+    for (size_t i = 0; i < p_group_sizes[group]; ++i)
+    {
+      p = skipWhitespace(p);
+
+      if (i != 0)
+      {
+        if (*p++ != ',')
+        {
+          return false;
+        }
+        p = skipWhitespace(p);
+      }
+
+      p = parseNum(p, p_values++);
+
+      if (!p)
+      {
+        return false;
+      }
+    }
+
+    p = skipWhitespace(p);
+
+    if (*p++ != ']')
+    {
+      return false;
+    }
+  }
+
+  p = skipWhitespace(p);
+
+  if (*p++ != ']')
+  {
+    return false;
+  }
+
+  return *skipWhitespace(p) == '\0';
+}
+
+/**
+ * \brief A function for appending a RAPID num value to a string (same format as RAPIDNum::constructString()).
+ *
+ * \param p_output for the string to append to.
+ * \param value specifying the value to append.
+ */
+void appendNum(std::string* p_output, const float value)
+{
+  if (value == (float) 9E9)
+  {
+    p_output->append("9000000000");
+  }
+  else if (hasRAPIDDecimalPoint())
+  {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    p_output->append(buffer, length > 0 ? length : 0);
+  }
+  else
+  {
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    ss << value;
+    p_output->append(ss.str());
+  }
+}
+
+/**
+ * \brief A function for appending a bracketed list of RAPID num values to a string.
+ *
+ * \param p_output for the string to append to.
+ * \param p_values for the values to append.
+ * \param count specifying the number of values.
+ */
+void appendNumList(std::string* p_output, const float* p_values, const size_t count)
+{
+  p_output->push_back('[');
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (i != 0)
+    {
+      p_output->push_back(',');
+    }
+    appendNum(p_output, p_values[i]);
+  }
+
+  p_output->push_back(']');
+}
+}
+
+namespace abb
+{
+namespace rws
+{
+/***********************************************************************************************************************
+ * Struct definitions: PosBatch
+ */
+
+void PosBatch::resize(const size_t size)
+{
+  x.resize(size);
+  y.resize(size);
+  z.resize(size);
+}
+
+void PosBatch::reserve(const size_t capacity)
+{
+  x.reserve(capacity);
+  y.reserve(capacity);
+  z.reserve(capacity);
+}
+
+void PosBatch::clear()
+{
+  x.clear();
+  y.clear();
+  z.clear();
+}
+
+void PosBatch::set(const size_t index, const Pos& pos)
+{
+  x.at(index) = pos.x.value;
+  y.at(index) = pos.y.value;
+  z.at(index) = pos.z.value;
+}
+
+void PosBatch::get(const size_t index, Pos* p_pos) const
+{
+  if (p_pos)
+  {
+    p_pos->x.value = x.at(index);
+    p_pos->y.value = y.at(index);
+    p_pos->z.value = z.at(index);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: OrientBatch
+ */
+
+void OrientBatch::resize(const size_t size)
+{
+  q1.resize(size);
+  q2.resize(size);
+  q3.resize(size);
+  q4.resize(size);
+}
+
+void OrientBatch::reserve(const size_t capacity)
+{
+  q1.reserve(capacity);
+  q2.reserve(capacity);
+  q3.reserve(capacity);
+  q4.reserve(capacity);
+}
+
+void OrientBatch::clear()
+{
+  q1.clear();
+  q2.clear();
+  q3.clear();
+  q4.clear();
+}
+
+void OrientBatch::set(const size_t index, const Orient& orient)
+{
+  q1.at(index) = orient.q1.value;
+  q2.at(index) = orient.q2.value;
+  q3.at(index) = orient.q3.value;
+  q4.at(index) = orient.q4.value;
+}
+
+void OrientBatch::get(const size_t index, Orient* p_orient) const
+{
+  if (p_orient)
+  {
+    p_orient->q1.value = q1.at(index);
+    p_orient->q2.value = q2.at(index);
+    p_orient->q3.value = q3.at(index);
+    p_orient->q4.value = q4.at(index);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: PoseBatch
+ */
+
+void PoseBatch::resize(const size_t size)
+{
+  pos.resize(size);
+  rot.resize(size);
+}
+
+void PoseBatch::reserve(const size_t capacity)
+{
+  pos.reserve(capacity);
+  rot.reserve(capacity);
+}
+
+void PoseBatch::clear()
+{
+  pos.clear();
+  rot.clear();
+}
+
+void PoseBatch::push_back(const Pose& pose)
+{
+  resize(size() + 1);
+  set(size() - 1, pose);
+}
+
+void PoseBatch::set(const size_t index, const Pose& pose)
+{
+  pos.set(index, pose.pos);
+  rot.set(index, pose.rot);
+}
+
+void PoseBatch::get(const size_t index, Pose* p_pose) const
+{
+  if (p_pose)
+  {
+    pos.get(index, &p_pose->pos);
+    rot.get(index, &p_pose->rot);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: ConfDataBatch
+ */
+
+void ConfDataBatch::resize(const size_t size)
+{
+  cf1.resize(size);
+  cf4.resize(size);
+  cf6.resize(size);
+  cfx.resize(size);
+}
+
+void ConfDataBatch::reserve(const size_t capacity)
+{
+  cf1.reserve(capacity);
+  cf4.reserve(capacity);
+  cf6.reserve(capacity);
+  cfx.reserve(capacity);
+}
+
+void ConfDataBatch::clear()
+{
+  cf1.clear();
+  cf4.clear();
+  cf6.clear();
+  cfx.clear();
+}
+
+void ConfDataBatch::set(const size_t index, const ConfData& robconf)
+{
+  cf1.at(index) = robconf.cf1.value;
+  cf4.at(index) = robconf.cf4.value;
+  cf6.at(index) = robconf.cf6.value;
+  cfx.at(index) = robconf.cfx.value;
+}
+
+void ConfDataBatch::get(const size_t index, ConfData* p_robconf) const
+{
+  if (p_robconf)
+  {
+    p_robconf->cf1.value = cf1.at(index);
+    p_robconf->cf4.value = cf4.at(index);
+    p_robconf->cf6.value = cf6.at(index);
+    p_robconf->cfx.value = cfx.at(index);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: RobJointBatch
+ */
+
+void RobJointBatch::resize(const size_t size)
+{
+  rax_1.resize(size);
+  rax_2.resize(size);
+  rax_3.resize(size);
+  rax_4.resize(size);
+  rax_5.resize(size);
+  rax_6.resize(size);
+}
+
+void RobJointBatch::reserve(const size_t capacity)
+{
+  rax_1.reserve(capacity);
+  rax_2.reserve(capacity);
+  rax_3.reserve(capacity);
+  rax_4.reserve(capacity);
+  rax_5.reserve(capacity);
+  rax_6.reserve(capacity);
+}
+
+void RobJointBatch::clear()
+{
+  rax_1.clear();
+  rax_2.clear();
+  rax_3.clear();
+  rax_4.clear();
+  rax_5.clear();
+  rax_6.clear();
+}
+
+void RobJointBatch::set(const size_t index, const RobJoint& robax)
+{
+  rax_1.at(index) = robax.rax_1.value;
+  rax_2.at(index) = robax.rax_2.value;
+  rax_3.at(index) = robax.rax_3.value;
+  rax_4.at(index) = robax.rax_4.value;
+  rax_5.at(index) = robax.rax_5.value;
+  rax_6.at(index) = robax.rax_6.value;
+}
+
+void RobJointBatch::get(const size_t index, RobJoint* p_robax) const
+{
+  if (p_robax)
+  {
+    p_robax->rax_1.value = rax_1.at(index);
+    p_robax->rax_2.value = rax_2.at(index);
+    p_robax->rax_3.value = rax_3.at(index);
+    p_robax->rax_4.value = rax_4.at(index);
+    p_robax->rax_5.value = rax_5.at(index);
+    p_robax->rax_6.value = rax_6.at(index);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: ExtJointBatch
+ */
+
+void ExtJointBatch::resize(const size_t size)
+{
+  eax_a.resize(size);
+  eax_b.resize(size);
+  eax_c.resize(size);
+  eax_d.resize(size);
+  eax_e.resize(size);
+  eax_f.resize(size);
+}
+
+void ExtJointBatch::reserve(const size_t capacity)
+{
+  eax_a.reserve(capacity);
+  eax_b.reserve(capacity);
+  eax_c.reserve(capacity);
+  eax_d.reserve(capacity);
+  eax_e.reserve(capacity);
+  eax_f.reserve(capacity);
+}
+
+void ExtJointBatch::clear()
+{
+  eax_a.clear();
+  eax_b.clear();
+  eax_c.clear();
+  eax_d.clear();
+  eax_e.clear();
+  eax_f.clear();
+}
+
+void ExtJointBatch::set(const size_t index, const ExtJoint& extax)
+{
+  eax_a.at(index) = extax.eax_a.value;
+  eax_b.at(index) = extax.eax_b.value;
+  eax_c.at(index) = extax.eax_c.value;
+  eax_d.at(index) = extax.eax_d.value;
+  eax_e.at(index) = extax.eax_e.value;
+  eax_f.at(index) = extax.eax_f.value;
+}
+
+void ExtJointBatch::get(const size_t index, ExtJoint* p_extax) const
+{
+  if (p_extax)
+  {
+    p_extax->eax_a.value = eax_a.at(index);
+    p_extax->eax_b.value = eax_b.at(index);
+    p_extax->eax_c.value = eax_c.at(index);
+    p_extax->eax_d.value = eax_d.at(index);
+    p_extax->eax_e.value = eax_e.at(index);
+    p_extax->eax_f.value = eax_f.at(index);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: RobTargetBatch
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void RobTargetBatch::resize(const size_t size)
+{
+  pos.resize(size);
+  orient.resize(size);
+  robconf.resize(size);
+  extax.resize(size);
+}
+
+void RobTargetBatch::reserve(const size_t capacity)
+{
+  pos.reserve(capacity);
+  orient.reserve(capacity);
+  robconf.reserve(capacity);
+  extax.reserve(capacity);
+}
+
+void RobTargetBatch::clear()
+{
+  pos.clear();
+  orient.clear();
+  robconf.clear();
+  extax.clear();
+}
+
+void RobTargetBatch::push_back(const RobTarget& robtarget)
+{
+  resize(size() + 1);
+  set(size() - 1, robtarget);
+}
+
+void RobTargetBatch::set(const size_t index, const RobTarget& robtarget)
+{
+  pos.set(index, robtarget.pos);
+  orient.set(index, robtarget.orient);
+  robconf.set(index, robtarget.robconf);
+  extax.set(index, robtarget.extax);
+}
+
+void RobTargetBatch::get(const size_t index, RobTarget* p_robtarget) const
+{
+  if (p_robtarget)
+  {
+    pos.get(index, &p_robtarget->pos);
+    orient.get(index, &p_robtarget->orient);
+    robconf.get(index, &p_robtarget->robconf);
+    extax.get(index, &p_robtarget->extax);
+  }
+}
+
+bool RobTargetBatch::parseString(const size_t index, const std::string& value_string)
+{
+  float v[ROBTARGET_VALUES] = {0.0f};
+  bool result = parseNumRecord(value_string, ROBTARGET_GROUPS, sizeof(ROBTARGET_GROUPS) / sizeof(size_t), v);
+
+  if (!result)
+  {
+    for (size_t i = 0; i < ROBTARGET_VALUES; ++i)
+    {
+      v[i] = 0.0f;
+    }
+  }
+
+  pos.x.at(index) = v[0];
+  pos.y.at(index) = v[1];
+  pos.z.at(index) = v[2];
+  orient.q1.at(index) = v[3];
+  orient.q2.at(index) = v[4];
+  orient.q3.at(index) = v[5];
+  orient.q4.at(index) = v[6];
+  robconf.cf1.at(index) = v[7];
+  robconf.cf4.at(index) = v[8];
+  robconf.cf6.at(index) = v[9];
+  robconf.cfx.at(index) = v[10];
+  extax.eax_a.at(index) = v[11];
+  extax.eax_b.at(index) = v[12];
+  extax.eax_c.at(index) = v[13];
+  extax.eax_d.at(index) = v[14];
+  extax.eax_e.at(index) = v[15];
+  extax.eax_f.at(index) = v[16];
+
+  return result;
+}
+
+std::string RobTargetBatch::constructString(const size_t index) const
+{
+  const float p[] = {pos.x.at(index), pos.y.at(index), pos.z.at(index)};
+  const float o[] = {orient.q1.at(index), orient.q2.at(index), orient.q3.at(index), orient.q4.at(index)};
+  const float c[] = {robconf.cf1.at(index), robconf.cf4.at(index), robconf.cf6.at(index), robconf.cfx.at(index)};
+  const float e[] = {extax.eax_a.at(index), extax.eax_b.at(index), extax.eax_c.at(index),
+                     extax.eax_d.at(index), extax.eax_e.at(index), extax.eax_f.at(index)};
+
+  std::string result;
+  result.reserve(ROBTARGET_VALUES * 12);
+
+  result.push_back('[');
+  appendNumList(&result, p, 3);
+  result.push_back(',');
+  appendNumList(&result, o, 4);
+  result.push_back(',');
+  appendNumList(&result, c, 4);
+  result.push_back(',');
+  appendNumList(&result, e, 6);
+  result.push_back(']');
+
+  return result;
+}
+
+size_t RobTargetBatch::parseStrings(const std::vector<std::string>& value_strings)
+{
+  size_t failures = 0;
+
+  resize(value_strings.size());
+
+  for (size_t i = 0; i < value_strings.size(); ++i)
+  {
+    if (!parseString(i, value_strings[i]))
+    {
+      ++failures;
+    }
+  }
+
+  return failures;
+}
+
+std::vector<std::string> RobTargetBatch::constructStrings() const
+{
+  std::vector<std::string> result;
+  result.reserve(size());
+
+  for (size_t i = 0; i < size(); ++i)
+  {
+    result.push_back(constructString(i));
+  }
+
+  return result;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Struct definitions: JointTargetBatch
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void JointTargetBatch::resize(const size_t size)
+{
+  robax.resize(size);
+  extax.resize(size);
+}
+
+void JointTargetBatch::reserve(const size_t capacity)
+{
+  robax.reserve(capacity);
+  extax.reserve(capacity);
+}
+
+void JointTargetBatch::clear()
+{
+  robax.clear();
+  extax.clear();
+}
+
+void JointTargetBatch::push_back(const JointTarget& jointtarget)
+{
+  resize(size() + 1);
+  set(size() - 1, jointtarget);
+}
+
+void JointTargetBatch::set(const size_t index, const JointTarget& jointtarget)
+{
+  robax.set(index, jointtarget.robax);
+  extax.set(index, jointtarget.extax);
+}
+
+void JointTargetBatch::get(const size_t index, JointTarget* p_jointtarget) const
+{
+  if (p_jointtarget)
+  {
+    robax.get(index, &p_jointtarget->robax);
+    extax.get(index, &p_jointtarget->extax);
+  }
+}
+
+bool JointTargetBatch::parseString(const size_t index, const std::string& value_string)
+{
+  float v[JOINTTARGET_VALUES] = {0.0f};
+  bool result = parseNumRecord(value_string, JOINTTARGET_GROUPS, sizeof(JOINTTARGET_GROUPS) / sizeof(size_t), v);
+
+  if (!result)
+  {
+    for (size_t i = 0; i < JOINTTARGET_VALUES; ++i)
+    {
+      v[i] = 0.0f;
+    }
+  }
+
+  robax.rax_1.at(index) = v[0];
+  robax.rax_2.at(index) = v[1];
+  robax.rax_3.at(index) = v[2];
+  robax.rax_4.at(index) = v[3];
+  robax.rax_5.at(index) = v[4];
+  robax.rax_6.at(index) = v[5];
+  extax.eax_a.at(index) = v[6];
+  extax.eax_b.at(index) = v[7];
+  extax.eax_c.at(index) = v[8];
+  extax.eax_d.at(index) = v[9];
+  extax.eax_e.at(index) = v[10];
+  extax.eax_f.at(index) = v[11];
+
+  return result;
+}
+
+std::string JointTargetBatch::constructString(const size_t index) const
+{
+  const float r[] = {robax.rax_1.at(index), robax.rax_2.at(index), robax.rax_3.at(index),
+                     robax.rax_4.at(index), robax.rax_5.at(index), robax.rax_6.at(index)};
+  const float e[] = {extax.eax_a.at(index), extax.eax_b.at(index), extax.eax_c.at(index),
+                     extax.eax_d.at(index), extax.eax_e.at(index), extax.eax_f.at(index)};
+
+  std::string result;
+  result.reserve(JOINTTARGET_VALUES * 12);
+
+  result.push_back('[');
+  appendNumList(&result, r, 6);
+  result.push_back(',');
+  appendNumList(&result, e, 6);
+  result.push_back(']');
+
+  return result;
+}
+
+size_t JointTargetBatch::parseStrings(const std::vector<std::string>& value_strings)
+{
+  size_t failures = 0;
+
+  resize(value_strings.size());
+
+  for (size_t i = 0; i < value_strings.size(); ++i)
+  {
+    if (!parseString(i, value_strings[i]))
+    {
+      ++failures;
+    }
+  }
+
+  return failures;
+}
+
+std::vector<std::string> JointTargetBatch::constructStrings() const
+{
+  std::vector<std::string> result;
+  result.reserve(size());
+
+  for (size_t i = 0; i < size(); ++i)
+  {
+    result.push_back(constructString(i));
+  }
+
+  return result;
+}
+
+} // end namespace rws
+} // end namespace abb
@@ -0,0 +1,327 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <cstring>
+
+#include "abb_librws/rws_rapid_binary.h"
+
+namespace
+{
+/**
+ * \brief Magic bytes identifying a binary message.
+ */
+const char MAGIC[] = {'R', 'W', 'S', 'B'};
+
+/**
+ * \brief Size of the fixed part of a message header (magic, version, flags and type name length).
+ */
+const size_t FIXED_HEADER_SIZE = 8;
+}
+
+namespace abb
+{
+namespace rws
+{
+/***********************************************************************************************************************
+ * Class definitions: RAPIDBinaryReader
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+bool RAPIDBinaryReader::readUInt8(Poco::UInt8* p_value)
+{
+  if (!p_value || remaining() < 1)
+  {
+    return false;
+  }
+
+  *p_value = static_cast<Poco::UInt8>(*p_current_++);
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readUInt16(Poco::UInt16* p_value)
+{
+  if (!p_value || remaining() < 2)
+  {
+    return false;
+  }
+
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(p_current_);
+  *p_value = static_cast<Poco::UInt16>(p[0] | (p[1] << 8));
+  p_current_ += 2;
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readUInt32(Poco::UInt32* p_value)
+{
+  if (!p_value || remaining() < 4)
+  {
+    return false;
+  }
+
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(p_current_);
+  *p_value = static_cast<Poco::UInt32>(p[0]) |
+             (static_cast<Poco::UInt32>(p[1]) << 8) |
+             (static_cast<Poco::UInt32>(p[2]) << 16) |
+             (static_cast<Poco::UInt32>(p[3]) << 24);
+  p_current_ += 4;
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readUInt64(Poco::UInt64* p_value)
+{
+  Poco::UInt32 low = 0;
+  Poco::UInt32 high = 0;
+
+  if (!p_value || remaining() < 8 || !readUInt32(&low) || !readUInt32(&high))
+  {
+    return false;
+  }
+
+  *p_value = (static_cast<Poco::UInt64>(high) << 32) | low;
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readFloat(float* p_value)
+{
+  Poco::UInt32 bits = 0;
+
+  if (!p_value || !readUInt32(&bits))
+  {
+    return false;
+  }
+
+  std::memcpy(p_value, &bits, sizeof(bits));
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readDouble(double* p_value)
+{
+  Poco::UInt64 bits = 0;
+
+  if (!p_value || !readUInt64(&bits))
+  {
+    return false;
+  }
+
+  std::memcpy(p_value, &bits, sizeof(bits));
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readString(const char** pp_characters, Poco::UInt32* p_length)
+{
+  const char* p_start = p_current_;
+  Poco::UInt32 length = 0;
+
+  if (!pp_characters || !p_length || !readUInt32(&length) || !readBytes(length, pp_characters))
+  {
+    p_current_ = p_start;
+    return false;
+  }
+
+  *p_length = length;
+
+  return true;
+}
+
+bool RAPIDBinaryReader::readBytes(const size_t size, const char** pp_bytes)
+{
+  if (!pp_bytes || remaining() < size)
+  {
+    return false;
+  }
+
+  *pp_bytes = p_current_;
+  p_current_ += size;
+
+  return true;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Function definitions
+ */
+
+void binaryAppendUInt8(std::string* p_buffer, const Poco::UInt8 value)
+{
+  p_buffer->push_back(static_cast<char>(value));
+}
+
+void binaryAppendUInt16(std::string* p_buffer, const Poco::UInt16 value)
+{
+  const char bytes[] = {static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF)};
+  p_buffer->append(bytes, sizeof(bytes));
+}
+
+void binaryAppendUInt32(std::string* p_buffer, const Poco::UInt32 value)
+{
+  const char bytes[] = {static_cast<char>(value & 0xFF),
+                        static_cast<char>((value >> 8) & 0xFF),
+                        static_cast<char>((value >> 16) & 0xFF),
+                        static_cast<char>((value >> 24) & 0xFF)};
+  p_buffer->append(bytes, sizeof(bytes));
+}
+
+void binaryAppendUInt64(std::string* p_buffer, const Poco::UInt64 value)
+{
+  binaryAppendUInt32(p_buffer, static_cast<Poco::UInt32>(value & 0xFFFFFFFF));
+  binaryAppendUInt32(p_buffer, static_cast<Poco::UInt32>(value >> 32));
+}
+
+void binaryAppendFloat(std::string* p_buffer, const float value)
+{
+  Poco::UInt32 bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  binaryAppendUInt32(p_buffer, bits);
+}
+
+void binaryAppendDouble(std::string* p_buffer, const double value)
+{
+  Poco::UInt64 bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  binaryAppendUInt64(p_buffer, bits);
+}
+
+void binaryAppendString(std::string* p_buffer, const char* p_characters, const Poco::UInt32 length)
+{
+  binaryAppendUInt32(p_buffer, length);
+  p_buffer->append(p_characters, length);
+}
+
+void encodeRAPIDBinary(const RAPIDSymbolDataAbstract& data, std::string* p_buffer)
+{
+  if (p_buffer)
+  {
+    const std::string type_name = data.getType();
+
+    p_buffer->append(MAGIC, sizeof(MAGIC));
+    binaryAppendUInt8(p_buffer, RAPID_BINARY_VERSION);
+    binaryAppendUInt8(p_buffer, 0);
+    binaryAppendUInt16(p_buffer, static_cast<Poco::UInt16>(type_name.size()));
+    p_buffer->append(type_name.data(), static_cast<Poco::UInt16>(type_name.size()));
+
+    // Reserve the payload size field, and fill it in once the payload has been appended.
+    const size_t size_position = p_buffer->size();
+    binaryAppendUInt32(p_buffer, 0);
+    data.appendBinary(p_buffer);
+
+    std::string size_field;
+    binaryAppendUInt32(&size_field, static_cast<Poco::UInt32>(p_buffer->size() - size_position - 4));
+    p_buffer->replace(size_position, 4, size_field);
+  }
+}
+
+std::string encodeRAPIDBinary(const RAPIDSymbolDataAbstract& data)
+{
+  std::string result;
+  encodeRAPIDBinary(data, &result);
+  return result;
+}
+
+size_t decodeRAPIDBinaryHeader(const char* p_message, const size_t size, RAPIDBinaryHeader* p_header)
+{
+  if (!p_message || !p_header || size < FIXED_HEADER_SIZE || std::memcmp(p_message, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    return 0;
+  }
+
+  RAPIDBinaryReader reader(p_message + sizeof(MAGIC), size - sizeof(MAGIC));
+  RAPIDBinaryHeader header;
+  Poco::UInt8 flags = 0;
+
+  if (!reader.readUInt8(&header.version) || header.version == 0 || header.version > RAPID_BINARY_VERSION ||
+      !reader.readUInt8(&flags) ||
+      !reader.readUInt16(&header.type_name_length) ||
+      !reader.readBytes(header.type_name_length, &header.p_type_name) ||
+      !reader.readUInt32(&header.payload_size) ||
+      !reader.readBytes(header.payload_size, &header.p_payload))
+  {
+    return 0;
+  }
+
+  *p_header = header;
+
+  return sizeof(MAGIC) + reader.position();
+}
+
+size_t decodeRAPIDBinary(const char* p_message, const size_t size, RAPIDSymbolDataAbstract* p_data)
+{
+  RAPIDBinaryHeader header;
+  size_t message_size = decodeRAPIDBinaryHeader(p_message, size, &header);
+
+  if (message_size == 0 || !p_data || !p_data->isType(header.p_type_name, header.type_name_length))
+  {
+    return 0;
+  }
+
+  // Validate the payload's layout first, so that a record is never left partly overwritten (decoding can only fail by
+  // running out of data, which the validation has then ruled out).
+  RAPIDBinaryReader validator(header.p_payload, header.payload_size);
+
+  if (!p_data->skipBinary(&validator) || validator.remaining() != 0)
+  {
+    return 0;
+  }
+
+  RAPIDBinaryReader reader(header.p_payload, header.payload_size);
+
+  if (!p_data->parseBinary(&reader))
+  {
+    return 0;
+  }
+
+  return message_size;
+}
+
+bool decodeRAPIDBinary(const std::string& message, RAPIDSymbolDataAbstract* p_data)
+{
+  const size_t message_size = decodeRAPIDBinary(message.data(), message.size(), p_data);
+
+  return (message_size > 0 && message_size == message.size());
+}
+
+} // end namespace rws
+} // end namespace abb
@@ -0,0 +1,173 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <vector>
+
+#include "Poco/Mutex.h"
+
+#include "abb_librws/rws_shared_buffer.h"
+
+namespace
+{
+/**
+ * \brief Maximum number of strings kept in the pool.
+ */
+const size_t MAX_POOLED_BUFFERS = 32;
+
+/**
+ * \brief Maximum capacity of a string kept in the pool (larger strings are deleted when released).
+ */
+const size_t MAX_POOLED_CAPACITY = 1024 * 1024;
+
+/**
+ * \brief A function for retrieving the mutex protecting the pool.
+ *
+ * The mutex (and the pool) are never destroyed, since buffers may be released during static destruction.
+ *
+ * \return Poco::FastMutex& for the mutex.
+ */
+Poco::FastMutex& poolMutex()
+{
+  static Poco::FastMutex* p_mutex = new Poco::FastMutex();
+  return *p_mutex;
+}
+
+/**
+ * \brief A function for retrieving the pool of released strings.
+ *
+ * \return std::vector<std::string*>& for the pool.
+ */
+std::vector<std::string*>& pool()
+{
+  static std::vector<std::string*>* p_pool = new std::vector<std::string*>();
+  return *p_pool;
+}
+
+/**
+ * \brief A function for acquiring an empty string, from the pool if possible.
+ *
+ * \return std::string* for the string.
+ */
+std::string* acquire()
+{
+  {
+    Poco::FastMutex::ScopedLock lock(poolMutex());
+
+    if (!pool().empty())
+    {
+      std::string* p_string = pool().back();
+      pool().pop_back();
+      return p_string;
+    }
+  }
+
+  return new std::string();
+}
+}
+
+namespace abb
+{
+namespace rws
+{
+/***********************************************************************************************************************
+ * Class definitions: BufferPoolReleasePolicy
+ */
+
+void BufferPoolReleasePolicy::release(std::string* p_string)
+{
+  if (p_string)
+  {
+    if (p_string->capacity() <= MAX_POOLED_CAPACITY)
+    {
+      p_string->clear();
+
+      Poco::FastMutex::ScopedLock lock(poolMutex());
+
+      if (pool().size() < MAX_POOLED_BUFFERS)
+      {
+        pool().push_back(p_string);
+        return;
+      }
+    }
+
+    delete p_string;
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: SharedBuffer
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+const SharedBuffer::size_type SharedBuffer::npos;
+
+const std::string SharedBuffer::EMPTY;
+
+SharedBuffer::SharedBuffer(const std::string& value)
+{
+  reset(value.size())->assign(value);
+}
+
+SharedBuffer::SharedBuffer(const char* p_value)
+{
+  if (p_value && *p_value)
+  {
+    reset()->assign(p_value);
+  }
+}
+
+std::string* SharedBuffer::reset(const size_t capacity)
+{
+  std::string* p_string = acquire();
+  p_string->reserve(capacity);
+  p_string_ = Poco::SharedPtr<std::string, Poco::ReferenceCounter, BufferPoolReleasePolicy>(p_string);
+
+  return p_string;
+}
+
+const std::string& SharedBuffer::str() const
+{
+  return (p_string_.isNull() ? EMPTY : *p_string_);
+}
+
+} // end namespace rws
+} // end namespace abb
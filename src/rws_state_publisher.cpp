@@ -0,0 +1,446 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Poco/Timestamp.h"
+
+#include "abb_librws/rws_state_publisher.h"
+
+namespace
+{
+/**
+ * \brief Offset of the data in the segment [bytes] (a cache line after the header's start).
+ */
+const size_t DATA_OFFSET = 64;
+
+/**
+ * \brief Size of the segment [bytes].
+ */
+const size_t SEGMENT_SIZE = DATA_OFFSET + sizeof(abb::rws::SharedStateData);
+
+/**
+ * \brief A function for copying a string into a fixed-size field (truncated, and always null terminated).
+ *
+ * \param source for the string to copy.
+ * \param destination for the field.
+ * \param size for the field's size.
+ */
+void copyString(const std::string& source, char* destination, const size_t size)
+{
+  const size_t length = std::min(source.size(), size - 1);
+  std::memcpy(destination, source.data(), length);
+  destination[length] = '\0';
+}
+
+/**
+ * \brief A function for converting a tri bool into its published value.
+ *
+ * \param tri_bool for the tri bool.
+ *
+ * \return Poco::UInt32 containing the value (see abb::rws::TriBool::Values).
+ */
+Poco::UInt32 toSharedValue(const abb::rws::TriBool& tri_bool)
+{
+  return (tri_bool.isUnknown() ? abb::rws::TriBool::UNKNOWN_VALUE :
+         (tri_bool.isTrue() ? abb::rws::TriBool::TRUE_VALUE : abb::rws::TriBool::FALSE_VALUE));
+}
+
+/**
+ * \brief A function for generating the published name of a RAPID symbol.
+ *
+ * \param resource for the RAPID symbol.
+ *
+ * \return std::string containing the name, as "task/module/name".
+ */
+std::string generateRAPIDName(const abb::rws::RWSClient::RAPIDResource& resource)
+{
+  return resource.task + "/" + resource.module + "/" + resource.name;
+}
+}
+
+namespace abb
+{
+namespace rws
+{
+// The seqlock requires that the sequence number can be accessed atomically from several processes.
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "Lock-free atomic integers are required for the shared-memory layout");
+static_assert(sizeof(SharedStateHeader) <= DATA_OFFSET, "The shared-memory header overlaps the data");
+
+/***********************************************************************************************************************
+ * Class definitions: SharedStateData
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+const SharedStateData::MechanicalUnit* SharedStateData::findMechanicalUnit(const std::string& name) const
+{
+  for (size_t i = 0; i < mechanical_units_count && i < MAX_MECHANICAL_UNITS; ++i)
+  {
+    if (name == mechanical_units[i].name)
+    {
+      return &mechanical_units[i];
+    }
+  }
+
+  return 0;
+}
+
+const SharedStateData::Value* SharedStateData::findIOSignal(const std::string& name) const
+{
+  for (size_t i = 0; i < io_signals_count && i < MAX_IO_SIGNALS; ++i)
+  {
+    if (name == io_signals[i].name)
+    {
+      return &io_signals[i];
+    }
+  }
+
+  return 0;
+}
+
+const SharedStateData::Value* SharedStateData::findRAPIDSymbol(const std::string& name) const
+{
+  for (size_t i = 0; i < rapid_symbols_count && i < MAX_RAPID_SYMBOLS; ++i)
+  {
+    if (name == rapid_symbols[i].name)
+    {
+      return &rapid_symbols[i];
+    }
+  }
+
+  return 0;
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: RWSStatePublisher
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RWSStatePublisher::RWSStatePublisher(RWSInterface& interface,
+                                     const std::string& segment_name,
+                                     const Configuration& configuration)
+:
+interface_(interface),
+configuration_(configuration),
+segment_(segment_name, SEGMENT_SIZE, Poco::SharedMemory::AM_WRITE, 0, true),
+p_header_(reinterpret_cast<SharedStateHeader*>(segment_.begin())),
+p_data_(reinterpret_cast<SharedStateData*>(segment_.begin() + DATA_OFFSET)),
+interval_(0),
+running_(false),
+runnable_(*this, &RWSStatePublisher::run)
+{
+  if (configuration_.mechanical_units.size() > SharedStateData::MAX_MECHANICAL_UNITS ||
+      configuration_.io_signals.size() > SharedStateData::MAX_IO_SIGNALS ||
+      configuration_.rapid_symbols.size() > SharedStateData::MAX_RAPID_SYMBOLS)
+  {
+    throw std::invalid_argument("RWSStatePublisher: Too many published items for the shared-memory layout");
+  }
+
+  // Names are used for lookups, so they must not be truncated.
+  std::vector<std::string> names(configuration_.mechanical_units);
+  names.insert(names.end(), configuration_.io_signals.begin(), configuration_.io_signals.end());
+  for (size_t i = 0; i < configuration_.rapid_symbols.size(); ++i)
+  {
+    names.push_back(generateRAPIDName(configuration_.rapid_symbols[i]));
+  }
+
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    if (names[i].size() >= SharedStateData::NAME_SIZE)
+    {
+      throw std::invalid_argument("RWSStatePublisher: Too long name for the shared-memory layout: " + names[i]);
+    }
+  }
+
+  // Initialize the segment, and mark it as compatible last (a previous publisher may have left it behind).
+  p_header_->magic.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memset(static_cast<void*>(p_data_), 0, sizeof(SharedStateData));
+  p_header_->version = SharedStateHeader::VERSION;
+  p_header_->data_size = static_cast<Poco::UInt32>(sizeof(SharedStateData));
+  p_header_->sequence.store(0, std::memory_order_relaxed);
+  p_header_->magic.store(SharedStateHeader::MAGIC, std::memory_order_release);
+}
+
+RWSStatePublisher::~RWSStatePublisher()
+{
+  stop();
+}
+
+void RWSStatePublisher::publish()
+{
+  // Collect the update first, so the seqlock is only held while copying.
+  SharedStateData data;
+  std::memset(static_cast<void*>(&data), 0, sizeof(data));
+  collect(&data);
+
+  Poco::ScopedLock<Poco::Mutex> lock(publish_mutex_);
+
+  const Poco::UInt32 sequence = p_header_->sequence.load(std::memory_order_relaxed);
+
+  p_header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::memcpy(static_cast<void*>(p_data_), &data, sizeof(data));
+
+  p_header_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void RWSStatePublisher::start(const Poco::Int64 interval)
+{
+  stop();
+
+  interval_ = interval;
+  running_ = true;
+  stop_event_.reset();
+  thread_.start(runnable_);
+}
+
+void RWSStatePublisher::stop()
+{
+  if (running_)
+  {
+    running_ = false;
+    stop_event_.set();
+    thread_.join();
+  }
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void RWSStatePublisher::run()
+{
+  long wait = 0;
+
+  do
+  {
+    Poco::Timestamp started;
+    publish();
+
+    // Keep a fixed rate, unless an update takes longer than the interval.
+    wait = static_cast<long>(std::max(interval_ - started.elapsed(), static_cast<Poco::Int64>(0)) / 1000);
+  } while (!stop_event_.tryWait(std::max(wait, 1L)));
+}
+
+void RWSStatePublisher::collect(SharedStateData* p_data)
+{
+  RWSInterface::RuntimeInfo runtime_info = interface_.collectRuntimeInfo();
+
+  p_data->timestamp = Poco::Timestamp().epochMicroseconds();
+  p_data->auto_mode = toSharedValue(runtime_info.auto_mode);
+  p_data->motors_on = toSharedValue(runtime_info.motors_on);
+  p_data->rapid_running = toSharedValue(runtime_info.rapid_running);
+  p_data->rws_connected = runtime_info.rws_connected;
+  p_data->mechanical_units_count = static_cast<Poco::UInt32>(configuration_.mechanical_units.size());
+  p_data->io_signals_count = static_cast<Poco::UInt32>(configuration_.io_signals.size());
+  p_data->rapid_symbols_count = static_cast<Poco::UInt32>(configuration_.rapid_symbols.size());
+
+  for (size_t i = 0; i < configuration_.mechanical_units.size(); ++i)
+  {
+    SharedStateData::MechanicalUnit& unit = p_data->mechanical_units[i];
+    copyString(configuration_.mechanical_units[i], unit.name, SharedStateData::NAME_SIZE);
+  }
+
+  for (size_t i = 0; i < configuration_.io_signals.size(); ++i)
+  {
+    copyString(configuration_.io_signals[i], p_data->io_signals[i].name, SharedStateData::NAME_SIZE);
+  }
+
+  for (size_t i = 0; i < configuration_.rapid_symbols.size(); ++i)
+  {
+    copyString(generateRAPIDName(configuration_.rapid_symbols[i]),
+               p_data->rapid_symbols[i].name,
+               SharedStateData::NAME_SIZE);
+  }
+
+  // Skip the remaining requests if the controller is not reachable (everything is then marked as invalid).
+  if (!runtime_info.rws_connected)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < configuration_.mechanical_units.size(); ++i)
+  {
+    SharedStateData::MechanicalUnit& unit = p_data->mechanical_units[i];
+    JointTarget jointtarget;
+    RobTarget robtarget;
+
+    if (interface_.getMechanicalUnitJointTarget(configuration_.mechanical_units[i], &jointtarget))
+    {
+      const RAPIDNum* robax[] = {&jointtarget.robax.rax_1, &jointtarget.robax.rax_2, &jointtarget.robax.rax_3,
+                                 &jointtarget.robax.rax_4, &jointtarget.robax.rax_5, &jointtarget.robax.rax_6};
+      const RAPIDNum* extax[] = {&jointtarget.extax.eax_a, &jointtarget.extax.eax_b, &jointtarget.extax.eax_c,
+                                 &jointtarget.extax.eax_d, &jointtarget.extax.eax_e, &jointtarget.extax.eax_f};
+
+      for (size_t j = 0; j < 6; ++j)
+      {
+        unit.robax[j] = robax[j]->value;
+        unit.jointtarget_extax[j] = extax[j]->value;
+      }
+
+      unit.jointtarget_valid = 1;
+    }
+
+    if (interface_.getMechanicalUnitRobTarget(configuration_.mechanical_units[i], &robtarget))
+    {
+      const RAPIDNum* pos[] = {&robtarget.pos.x, &robtarget.pos.y, &robtarget.pos.z};
+      const RAPIDNum* orient[] = {&robtarget.orient.q1, &robtarget.orient.q2, &robtarget.orient.q3,
+                                  &robtarget.orient.q4};
+      const RAPIDNum* robconf[] = {&robtarget.robconf.cf1, &robtarget.robconf.cf4, &robtarget.robconf.cf6,
+                                   &robtarget.robconf.cfx};
+      const RAPIDNum* extax[] = {&robtarget.extax.eax_a, &robtarget.extax.eax_b, &robtarget.extax.eax_c,
+                                 &robtarget.extax.eax_d, &robtarget.extax.eax_e, &robtarget.extax.eax_f};
+
+      for (size_t j = 0; j < 3; ++j)
+      {
+        unit.pos[j] = pos[j]->value;
+      }
+
+      for (size_t j = 0; j < 4; ++j)
+      {
+        unit.orient[j] = orient[j]->value;
+        unit.robconf[j] = robconf[j]->value;
+      }
+
+      for (size_t j = 0; j < 6; ++j)
+      {
+        unit.robtarget_extax[j] = extax[j]->value;
+      }
+
+      unit.robtarget_valid = 1;
+    }
+  }
+
+  for (size_t i = 0; i < configuration_.io_signals.size(); ++i)
+  {
+    SharedStateData::Value& signal = p_data->io_signals[i];
+    std::string value = interface_.getIOSignal(configuration_.io_signals[i]);
+
+    copyString(value, signal.value, SharedStateData::VALUE_SIZE);
+    signal.valid = !value.empty();
+  }
+
+  for (size_t i = 0; i < configuration_.rapid_symbols.size(); ++i)
+  {
+    const RWSClient::RAPIDResource& resource = configuration_.rapid_symbols[i];
+    SharedStateData::Value& symbol = p_data->rapid_symbols[i];
+    std::string value = interface_.getRAPIDSymbolData(resource.task, resource.module, resource.name);
+
+    copyString(value, symbol.value, SharedStateData::VALUE_SIZE);
+    symbol.valid = (!value.empty() && value.size() < SharedStateData::VALUE_SIZE);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: RWSStateReader
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+RWSStateReader::RWSStateReader(const std::string& segment_name)
+:
+segment_(segment_name, SEGMENT_SIZE, Poco::SharedMemory::AM_READ, 0, false),
+p_header_(reinterpret_cast<const SharedStateHeader*>(segment_.begin())),
+p_data_(reinterpret_cast<const SharedStateData*>(segment_.begin() + DATA_OFFSET))
+{}
+
+bool RWSStateReader::isCompatible() const
+{
+  return (p_header_->magic.load(std::memory_order_acquire) == SharedStateHeader::MAGIC &&
+          p_header_->version == SharedStateHeader::VERSION &&
+          p_header_->data_size == sizeof(SharedStateData));
+}
+
+bool RWSStateReader::read(SharedStateData* p_data, const unsigned int max_attempts) const
+{
+  if (!p_data || !isCompatible())
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < max_attempts; ++i)
+  {
+    const Poco::UInt32 before = p_header_->sequence.load(std::memory_order_acquire);
+
+    // Nothing has been published yet.
+    if (before == 0)
+    {
+      return false;
+    }
+
+    // Retry directly if an update is being written, otherwise copy and check that no update was written meanwhile.
+    if ((before & 1) == 0)
+    {
+      std::memcpy(static_cast<void*>(p_data), p_data_, sizeof(SharedStateData));
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (p_header_->sequence.load(std::memory_order_relaxed) == before)
+      {
+        return true;
+      }
+    }
+
+    Poco::Thread::yield();
+  }
+
+  return false;
+}
+
+Poco::UInt32 RWSStateReader::sequence() const
+{
+  return p_header_->sequence.load(std::memory_order_acquire);
+}
+
+} // end namespace rws
+} // end namespace abb
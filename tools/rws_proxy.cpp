@@ -0,0 +1,1029 @@
+/***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, ABB Schweiz AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with
+ * or without modification, are permitted provided that
+ * the following conditions are met:
+ *
+ *    * Redistributions of source code must retain the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the
+ *      above copyright notice, this list of conditions
+ *      and the following disclaimer in the documentation
+ *      and/or other materials provided with the
+ *      distribution.
+ *    * Neither the name of ABB nor the names of its
+ *      contributors may be used to endorse or promote
+ *      products derived from this software without
+ *      specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***********************************************************************************************************************
+ */
+
+#include <deque>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Poco/Condition.h"
+#include "Poco/Mutex.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/WebSocket.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/String.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/Thread.h"
+#include "Poco/Util/HelpFormatter.h"
+#include "Poco/Util/Option.h"
+#include "Poco/Util/OptionSet.h"
+#include "Poco/Util/ServerApplication.h"
+
+#include "abb_librws/rws_client.h"
+
+/*
+ * A local RWS proxy, which multiplexes many local clients onto one session with a robot controller.
+ *
+ * - Regular requests are forwarded on the proxy's session. Reads are coalesced (and optionally cached), so the load
+ *   on the controller does not grow with the number of local clients. The "X-RWS-Priority" header ("control",
+ *   "interactive" or "bulk") selects the request's priority lane.
+ * - Only static resources (controller, configuration and mechanical unit information) are cached by default. The
+ *   RAPID program and panel classes change outside the proxy (e.g. modules loaded from the FlexPendant), so they are
+ *   only cached if given a time to live of their own. The RAPID tasks (with their execution states), controller state
+ *   and operation mode are never cached.
+ * - Subscription events, for the resources given on the command line, are received on one subscription channel and
+ *   fanned out to all local WebSocket clients connected to "/proxy/subscription".
+ * - Requests that would disturb the shared session (logout and subscription management) are rejected.
+ *
+ * The proxy does not authenticate local clients, so by default it only listens on the loopback interface.
+ */
+
+using namespace Poco;
+using namespace Poco::Net;
+using namespace Poco::Util;
+using abb::rws::POCOClient;
+using abb::rws::RWSClient;
+using abb::rws::SystemConstants;
+
+namespace
+{
+/**
+ * \brief The local URI for subscription events.
+ */
+const char PROXY_SUBSCRIPTION_URI[] = "/proxy/subscription";
+
+/**
+ * \brief Time to wait before a failed controller subscription is restarted [milliseconds].
+ */
+const long SUBSCRIPTION_RETRY_DELAY = 1000;
+
+/**
+ * \brief Send timeout for local WebSocket clients [microseconds]. Slower clients are disconnected.
+ */
+const Poco::Int64 LOCAL_SEND_TIMEOUT = 1000000;
+
+/**
+ * \brief Maximum number of queued events per local WebSocket client. Clients that fall further behind are disconnected.
+ */
+const size_t LOCAL_QUEUE_CAPACITY = 64;
+
+/**
+ * \brief Interval for checking a local WebSocket client for incoming frames (e.g. pings), while waiting for events
+ *        [milliseconds].
+ */
+const long LOCAL_POLL_INTERVAL = 100;
+
+
+
+
+/***********************************************************************************************************************
+ * Class declarations
+ */
+
+/**
+ * \brief A class for a local WebSocket client's bounded queue of subscription events.
+ *
+ * The hub only queues events (without blocking), and the client's own handler thread sends them, so a slow client
+ * never delays the other clients.
+ */
+class LocalSubscriber
+{
+public:
+  /**
+   * \brief A default constructor.
+   */
+  LocalSubscriber() : closed_(false) {}
+
+  /**
+   * \brief A method for queuing an event. The subscriber is closed if its queue is full.
+   *
+   * \param event for the event's content.
+   *
+   * \return bool indicating if the event was queued (not if the queue is full, or the subscriber is closed).
+   */
+  bool push(const std::string& event);
+
+  /**
+   * \brief A method for waiting for, and taking, the queued events.
+   *
+   * \param p_events for storing the events (in order).
+   * \param timeout for the maximum time to wait [milliseconds].
+   *
+   * \return bool indicating if the subscriber is still open (false if it has been closed).
+   */
+  bool wait(std::deque<std::string>* p_events, const long timeout);
+
+  /**
+   * \brief A method for closing the subscriber (which wakes a waiting handler).
+   */
+  void close();
+
+private:
+  /**
+   * \brief A mutex for protecting the queue.
+   */
+  Mutex mutex_;
+
+  /**
+   * \brief A condition for signaling queued events (and closing).
+   */
+  Condition condition_;
+
+  /**
+   * \brief The queued events.
+   */
+  std::deque<std::string> events_;
+
+  /**
+   * \brief Flag indicating if the subscriber has been closed.
+   */
+  bool closed_;
+};
+
+/**
+ * \brief A class for keeping the controller subscription, and fanning out its events to local WebSocket clients.
+ */
+class SubscriptionHub
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param client for the client with the controller session.
+   * \param resources for the resources to subscribe to.
+   */
+  SubscriptionHub(RWSClient& client, const RWSClient::SubscriptionResources& resources)
+  :
+  client_(client),
+  resources_(resources),
+  running_(false),
+  runnable_(*this, &SubscriptionHub::run)
+  {}
+
+  /**
+   * \brief A method for starting the subscription thread.
+   */
+  void start();
+
+  /**
+   * \brief A method for ending the controller subscription, and stopping the subscription thread.
+   */
+  void stop();
+
+  /**
+   * \brief A method for adding a local WebSocket client.
+   *
+   * \param p_subscriber for the client's event queue.
+   */
+  void add(const SharedPtr<LocalSubscriber>& p_subscriber);
+
+  /**
+   * \brief A method for removing a local WebSocket client.
+   *
+   * \param p_subscriber for the client's event queue.
+   */
+  void remove(const SharedPtr<LocalSubscriber>& p_subscriber);
+
+private:
+  /**
+   * \brief The subscription thread's loop.
+   */
+  void run();
+
+  /**
+   * \brief A method for queuing an event for all local WebSocket clients.
+   *
+   * \param event for the event's content.
+   */
+  void publish(const std::string& event);
+
+  /**
+   * \brief The client with the controller session.
+   */
+  RWSClient& client_;
+
+  /**
+   * \brief The resources to subscribe to.
+   */
+  RWSClient::SubscriptionResources resources_;
+
+  /**
+   * \brief A mutex for protecting the local WebSocket clients.
+   */
+  Mutex subscribers_mutex_;
+
+  /**
+   * \brief The local WebSocket clients' event queues.
+   */
+  std::set<SharedPtr<LocalSubscriber> > subscribers_;
+
+  /**
+   * \brief Flag indicating if the subscription thread should keep running.
+   */
+  volatile bool running_;
+
+  /**
+   * \brief The subscription thread.
+   */
+  Thread thread_;
+
+  /**
+   * \brief Adapter for running the loop in the thread.
+   */
+  RunnableAdapter<SubscriptionHub> runnable_;
+};
+
+/**
+ * \brief A class for forwarding a local request on the controller session.
+ */
+class ForwardingHandler : public HTTPRequestHandler
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param client for the client with the controller session.
+   */
+  ForwardingHandler(RWSClient& client) : client_(client) {}
+
+  /**
+   * \brief A method for handling a request.
+   *
+   * \param request for the local request.
+   * \param response for the local response.
+   */
+  void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+
+private:
+  /**
+   * \brief The client with the controller session.
+   */
+  RWSClient& client_;
+};
+
+/**
+ * \brief A class for connecting a local WebSocket client to the subscription events.
+ */
+class SubscriptionHandler : public HTTPRequestHandler
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param hub for the subscription hub.
+   */
+  SubscriptionHandler(SubscriptionHub& hub) : hub_(hub) {}
+
+  /**
+   * \brief A method for handling a request.
+   *
+   * \param request for the local request.
+   * \param response for the local response.
+   */
+  void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response);
+
+private:
+  /**
+   * \brief The subscription hub.
+   */
+  SubscriptionHub& hub_;
+};
+
+/**
+ * \brief A class for creating the handlers of local requests.
+ */
+class HandlerFactory : public HTTPRequestHandlerFactory
+{
+public:
+  /**
+   * \brief A constructor.
+   *
+   * \param client for the client with the controller session.
+   * \param hub for the subscription hub.
+   */
+  HandlerFactory(RWSClient& client, SubscriptionHub& hub) : client_(client), hub_(hub) {}
+
+  /**
+   * \brief A method for creating a request's handler.
+   *
+   * \param request for the local request.
+   *
+   * \return HTTPRequestHandler* to the handler.
+   */
+  HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request);
+
+private:
+  /**
+   * \brief The client with the controller session.
+   */
+  RWSClient& client_;
+
+  /**
+   * \brief The subscription hub.
+   */
+  SubscriptionHub& hub_;
+};
+
+/**
+ * \brief A class for the proxy application.
+ */
+class RWSProxy : public ServerApplication
+{
+public:
+  /**
+   * \brief A default constructor.
+   */
+  RWSProxy()
+  :
+  help_requested_(false),
+  port_(SystemConstants::General::DEFAULT_PORT_NUMBER),
+  username_(SystemConstants::General::DEFAULT_USERNAME),
+  password_(SystemConstants::General::DEFAULT_PASSWORD),
+  https_(false),
+  listen_address_("127.0.0.1"),
+  listen_port_(8080),
+  cache_ttl_(0),
+  threads_(32)
+  {}
+
+protected:
+  /**
+   * \brief A method for defining the command line options.
+   *
+   * \param options for the option set.
+   */
+  void defineOptions(OptionSet& options);
+
+  /**
+   * \brief A method for handling a command line option.
+   *
+   * \param name for the option's name.
+   * \param value for the option's value.
+   */
+  void handleOption(const std::string& name, const std::string& value);
+
+  /**
+   * \brief The application's main method.
+   *
+   * \param args for the remaining command line arguments.
+   *
+   * \return int containing the exit code.
+   */
+  int main(const std::vector<std::string>& args);
+
+private:
+  /**
+   * \brief Flag indicating if the help was requested.
+   */
+  bool help_requested_;
+
+  /**
+   * \brief The robot controller's IP address.
+   */
+  std::string controller_;
+
+  /**
+   * \brief The port used by the RWS server.
+   */
+  unsigned short port_;
+
+  /**
+   * \brief The username to the RWS authentication process.
+   */
+  std::string username_;
+
+  /**
+   * \brief The password to the RWS authentication process.
+   */
+  std::string password_;
+
+  /**
+   * \brief Flag indicating if HTTPS should be used towards the robot controller.
+   */
+  bool https_;
+
+  /**
+   * \brief The local address to listen on.
+   */
+  std::string listen_address_;
+
+  /**
+   * \brief The local port to listen on.
+   */
+  unsigned short listen_port_;
+
+  /**
+   * \brief The time to live for cached responses of static resources [microseconds] (0 disables the caching).
+   */
+  Poco::Int64 cache_ttl_;
+
+  /**
+   * \brief Times to live for cached responses of specific cache classes [microseconds] (overriding cache_ttl_).
+   */
+  std::map<RWSClient::CacheClass, Poco::Int64> class_cache_ttls_;
+
+  /**
+   * \brief The maximum number of local requests handled concurrently (including WebSocket clients).
+   */
+  int threads_;
+
+  /**
+   * \brief The resources to subscribe to.
+   */
+  RWSClient::SubscriptionResources resources_;
+};
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: LocalSubscriber
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+bool LocalSubscriber::push(const std::string& event)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (closed_)
+  {
+    return false;
+  }
+
+  // Disconnect a client that can not keep up, instead of buffering without bound.
+  if (events_.size() >= LOCAL_QUEUE_CAPACITY)
+  {
+    closed_ = true;
+    condition_.broadcast();
+    return false;
+  }
+
+  events_.push_back(event);
+  condition_.broadcast();
+
+  return true;
+}
+
+bool LocalSubscriber::wait(std::deque<std::string>* p_events, const long timeout)
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  if (events_.empty() && !closed_)
+  {
+    condition_.tryWait(mutex_, timeout);
+  }
+
+  p_events->swap(events_);
+  events_.clear();
+
+  return !closed_;
+}
+
+void LocalSubscriber::close()
+{
+  ScopedLock<Mutex> lock(mutex_);
+
+  closed_ = true;
+  condition_.broadcast();
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: SubscriptionHub
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void SubscriptionHub::start()
+{
+  if (!resources_.getResources().empty())
+  {
+    running_ = true;
+    thread_.start(runnable_);
+  }
+}
+
+void SubscriptionHub::stop()
+{
+  if (running_)
+  {
+    running_ = false;
+    client_.endSubscription();
+    client_.forceCloseSubscription();
+    thread_.join();
+  }
+
+  // The handlers shut down their clients' WebSockets when they notice that the subscribers have been closed.
+  ScopedLock<Mutex> lock(subscribers_mutex_);
+
+  for (std::set<SharedPtr<LocalSubscriber> >::iterator it = subscribers_.begin(); it != subscribers_.end(); ++it)
+  {
+    (*it)->close();
+  }
+}
+
+void SubscriptionHub::add(const SharedPtr<LocalSubscriber>& p_subscriber)
+{
+  ScopedLock<Mutex> lock(subscribers_mutex_);
+  subscribers_.insert(p_subscriber);
+}
+
+void SubscriptionHub::remove(const SharedPtr<LocalSubscriber>& p_subscriber)
+{
+  ScopedLock<Mutex> lock(subscribers_mutex_);
+  subscribers_.erase(p_subscriber);
+}
+
+/************************************************************
+ * Auxiliary methods
+ */
+
+void SubscriptionHub::run()
+{
+  while (running_)
+  {
+    if (!client_.webSocketExist() && !client_.startSubscription(resources_).success)
+    {
+      Thread::sleep(SUBSCRIPTION_RETRY_DELAY);
+      continue;
+    }
+
+    POCOClient::POCOResult result = client_.webSocketReceiveFrame();
+
+    if (result.status == POCOClient::POCOResult::OK && !result.poco_info.websocket.frame_content.empty())
+    {
+      publish(result.poco_info.websocket.frame_content);
+    }
+    else if (result.status != POCOClient::POCOResult::OK && running_)
+    {
+      // Start over with a new subscription (the old one expires on the controller).
+      client_.forceCloseSubscription();
+      Thread::sleep(SUBSCRIPTION_RETRY_DELAY);
+    }
+  }
+}
+
+void SubscriptionHub::publish(const std::string& event)
+{
+  // Only queue the event (which never blocks), since each client's own handler thread sends it.
+  ScopedLock<Mutex> lock(subscribers_mutex_);
+
+  std::vector<SharedPtr<LocalSubscriber> > failed;
+
+  for (std::set<SharedPtr<LocalSubscriber> >::iterator it = subscribers_.begin(); it != subscribers_.end(); ++it)
+  {
+    if (!(*it)->push(event))
+    {
+      failed.push_back(*it);
+    }
+  }
+
+  // Forget clients that can not keep up (their handlers disconnect them), so they never delay the other clients.
+  for (size_t i = 0; i < failed.size(); ++i)
+  {
+    subscribers_.erase(failed[i]);
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: ForwardingHandler
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void ForwardingHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+{
+  const std::string& uri = request.getURI();
+  const std::string& method = request.getMethod();
+
+  // Requests that would disturb the shared session are not forwarded.
+  if (uri.compare(0, SystemConstants::RWS::Resources::LOGOUT.size(), SystemConstants::RWS::Resources::LOGOUT) == 0 ||
+      uri.compare(0, SystemConstants::RWS::Services::SUBSCRIPTION.size(),
+                  SystemConstants::RWS::Services::SUBSCRIPTION) == 0 ||
+      uri.compare(0, 6, "/poll/") == 0)
+  {
+    response.setStatusAndReason(HTTPResponse::HTTP_FORBIDDEN);
+    response.send() << "Not allowed through the proxy (use " << PROXY_SUBSCRIPTION_URI << " for subscriptions)";
+    return;
+  }
+
+  POCOClient::Priority priority = POCOClient::INTERACTIVE;
+  const std::string priority_name = Poco::toLower(request.get("X-RWS-Priority", ""));
+  if (priority_name == "control")
+  {
+    priority = POCOClient::CONTROL;
+  }
+  else if (priority_name == "bulk")
+  {
+    priority = POCOClient::BULK;
+  }
+
+  POCOClient::PriorityScope priority_scope(client_, priority);
+  POCOClient::POCOResult result;
+
+  if (method == HTTPRequest::HTTP_GET)
+  {
+    result = client_.readResource(uri);
+  }
+  else
+  {
+    std::string content;
+    StreamCopier::copyToString(request.stream(), content);
+
+    if (method == HTTPRequest::HTTP_POST)
+    {
+      result = client_.httpPost(uri, content);
+    }
+    else if (method == HTTPRequest::HTTP_PUT)
+    {
+      result = client_.httpPut(uri, content);
+    }
+    else if (method == HTTPRequest::HTTP_DELETE)
+    {
+      result = client_.httpDelete(uri);
+    }
+    else
+    {
+      response.setStatusAndReason(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+      response.send();
+      return;
+    }
+  }
+
+  if (result.status != POCOClient::POCOResult::OK)
+  {
+    response.setStatusAndReason(HTTPResponse::HTTP_BAD_GATEWAY);
+    response.send() << result.mapGeneralStatus() << ": " << result.exception_message;
+    return;
+  }
+
+  const POCOClient::POCOResult::POCOInfo::HTTPInfo::ResponseInfo& info = result.poco_info.http.response;
+
+  response.setStatusAndReason(info.status);
+
+  const std::string content_type = info.header("Content-Type");
+  if (!content_type.empty())
+  {
+    response.setContentType(content_type);
+  }
+
+  const std::string location = info.location();
+  if (!location.empty())
+  {
+    response.set("Location", location);
+  }
+
+  response.setContentLength(info.content.size());
+  response.send().write(info.content.data(), info.content.size());
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: SubscriptionHandler
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void SubscriptionHandler::handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+{
+  SharedPtr<WebSocket> p_websocket;
+
+  try
+  {
+    p_websocket = new WebSocket(request, response);
+  }
+  catch (WebSocketException&)
+  {
+    response.setStatusAndReason(HTTPResponse::HTTP_BAD_REQUEST);
+    response.setContentLength(0);
+    response.send();
+    return;
+  }
+
+  p_websocket->setSendTimeout(Timespan(LOCAL_SEND_TIMEOUT));
+
+  SharedPtr<LocalSubscriber> p_subscriber(new LocalSubscriber());
+  hub_.add(p_subscriber);
+
+  // This thread is the WebSocket's only writer (of both events and PONG frames), so frames never interleave. It sends
+  // the queued events, and reads (and discards) frames from the client in between, until either side disconnects.
+  std::deque<std::string> events;
+  char buffer[1024];
+  bool connected = true;
+
+  try
+  {
+    while (connected && p_subscriber->wait(&events, LOCAL_POLL_INTERVAL))
+    {
+      for (; !events.empty(); events.pop_front())
+      {
+        p_websocket->sendFrame(events.front().data(), static_cast<int>(events.front().size()), WebSocket::FRAME_TEXT);
+      }
+
+      while (connected && p_websocket->poll(Timespan(0), Socket::SELECT_READ))
+      {
+        int flags = 0;
+        int number_of_bytes_received = 0;
+
+        try
+        {
+          number_of_bytes_received = p_websocket->receiveFrame(buffer, sizeof(buffer), flags);
+        }
+        catch (TimeoutException&)
+        {
+          break;
+        }
+
+        if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING)
+        {
+          p_websocket->sendFrame(buffer,
+                                 number_of_bytes_received,
+                                 WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG);
+        }
+
+        connected = (number_of_bytes_received > 0 &&
+                     (flags & WebSocket::FRAME_OP_BITMASK) != WebSocket::FRAME_OP_CLOSE);
+      }
+    }
+  }
+  catch (Poco::Exception&)
+  {
+  }
+
+  hub_.remove(p_subscriber);
+
+  try
+  {
+    p_websocket->shutdown();
+  }
+  catch (Poco::Exception&)
+  {
+  }
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: HandlerFactory
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+HTTPRequestHandler* HandlerFactory::createRequestHandler(const HTTPServerRequest& request)
+{
+  if (request.getURI() == PROXY_SUBSCRIPTION_URI)
+  {
+    return new SubscriptionHandler(hub_);
+  }
+
+  return new ForwardingHandler(client_);
+}
+
+
+
+
+/***********************************************************************************************************************
+ * Class definitions: RWSProxy
+ */
+
+/************************************************************
+ * Primary methods
+ */
+
+void RWSProxy::defineOptions(OptionSet& options)
+{
+  ServerApplication::defineOptions(options);
+
+  options.addOption(Option("help", "h", "Display the help.").required(false).repeatable(false));
+  options.addOption(Option("controller", "c", "The robot controller's IP address.")
+                    .required(false).repeatable(false).argument("address"));
+  options.addOption(Option("port", "p", "The port used by the RWS server.")
+                    .required(false).repeatable(false).argument("port"));
+  options.addOption(Option("username", "u", "The username to the RWS authentication process.")
+                    .required(false).repeatable(false).argument("username"));
+  options.addOption(Option("password", "w", "The password to the RWS authentication process.")
+                    .required(false).repeatable(false).argument("password"));
+  options.addOption(Option("https", "s", "Use HTTPS towards the robot controller.")
+                    .required(false).repeatable(false));
+  options.addOption(Option("listen-address", "a", "The local address to listen on (default 127.0.0.1).")
+                    .required(false).repeatable(false).argument("address"));
+  options.addOption(Option("listen-port", "l", "The local port to listen on (default 8080).")
+                    .required(false).repeatable(false).argument("port"));
+  options.addOption(Option("cache-ttl", "t", "Time to live for cached responses of static resources [ms].")
+                    .required(false).repeatable(false).argument("ms"));
+  options.addOption(Option("class-cache-ttl", "k", "Time to live for a cache class (controller, configuration, "
+                           "mechunits, rapid or panel) [ms].")
+                    .required(false).repeatable(true).argument("class:ms"));
+  options.addOption(Option("threads", "n", "Maximum number of concurrent local requests (default 32).")
+                    .required(false).repeatable(false).argument("count"));
+  options.addOption(Option("signal", "i", "An IO signal to subscribe to.")
+                    .required(false).repeatable(true).argument("name"));
+  options.addOption(Option("rapid", "r", "A persistent RAPID variable to subscribe to.")
+                    .required(false).repeatable(true).argument("task/module/name"));
+}
+
+void RWSProxy::handleOption(const std::string& name, const std::string& value)
+{
+  ServerApplication::handleOption(name, value);
+
+  if (name == "help")
+  {
+    help_requested_ = true;
+    stopOptionsProcessing();
+  }
+  else if (name == "controller")
+  {
+    controller_ = value;
+  }
+  else if (name == "port")
+  {
+    port_ = static_cast<unsigned short>(NumberParser::parseUnsigned(value));
+  }
+  else if (name == "username")
+  {
+    username_ = value;
+  }
+  else if (name == "password")
+  {
+    password_ = value;
+  }
+  else if (name == "https")
+  {
+    https_ = true;
+  }
+  else if (name == "listen-address")
+  {
+    listen_address_ = value;
+  }
+  else if (name == "listen-port")
+  {
+    listen_port_ = static_cast<unsigned short>(NumberParser::parseUnsigned(value));
+  }
+  else if (name == "cache-ttl")
+  {
+    cache_ttl_ = static_cast<Poco::Int64>(NumberParser::parseUnsigned(value)) * 1000;
+  }
+  else if (name == "class-cache-ttl")
+  {
+    StringTokenizer tokens(value, ":", StringTokenizer::TOK_TRIM);
+    const char* class_names[] = {"controller", "configuration", "mechunits", "rapid", "panel"};
+    int cache_class = RWSClient::CACHE_CLASSES;
+
+    for (int i = 0; i < RWSClient::CACHE_CLASSES && tokens.count() == 2; ++i)
+    {
+      if (tokens[0] == class_names[i])
+      {
+        cache_class = i;
+      }
+    }
+
+    if (cache_class == RWSClient::CACHE_CLASSES)
+    {
+      throw InvalidArgumentException("Expected class:ms", value);
+    }
+
+    class_cache_ttls_[static_cast<RWSClient::CacheClass>(cache_class)] =
+      static_cast<Poco::Int64>(NumberParser::parseUnsigned(tokens[1])) * 1000;
+  }
+  else if (name == "threads")
+  {
+    threads_ = NumberParser::parse(value);
+  }
+  else if (name == "signal")
+  {
+    resources_.addIOSignal(value, RWSClient::SubscriptionResources::MEDIUM);
+  }
+  else if (name == "rapid")
+  {
+    StringTokenizer tokens(value, "/", StringTokenizer::TOK_TRIM);
+
+    if (tokens.count() != 3)
+    {
+      throw InvalidArgumentException("Expected task/module/name", value);
+    }
+
+    resources_.addRAPIDPersistantVariable(RWSClient::RAPIDResource(tokens[0], tokens[1], tokens[2]),
+                                          RWSClient::SubscriptionResources::MEDIUM);
+  }
+}
+
+int RWSProxy::main(const std::vector<std::string>& args)
+{
+  if (help_requested_ || controller_.empty())
+  {
+    HelpFormatter help_formatter(options());
+    help_formatter.setCommand(commandName());
+    help_formatter.setUsage("--controller=<address> [options]");
+    help_formatter.setHeader("A local RWS proxy, which multiplexes many local clients onto one controller session.");
+    help_formatter.format(std::cout);
+    return (help_requested_ ? Application::EXIT_OK : Application::EXIT_USAGE);
+  }
+
+  POCOClient::TLSOptions tls;
+  tls.enabled = https_;
+
+  RWSClient client(controller_, port_, username_, password_, tls);
+
+  // Only the static classes use the common time to live, since the others change outside the proxy.
+  client.setCacheTTL(RWSClient::CACHE_CONTROLLER, cache_ttl_);
+  client.setCacheTTL(RWSClient::CACHE_CONFIGURATION, cache_ttl_);
+  client.setCacheTTL(RWSClient::CACHE_MECHANICAL_UNITS, cache_ttl_);
+
+  for (std::map<RWSClient::CacheClass, Poco::Int64>::const_iterator i = class_cache_ttls_.begin();
+       i != class_cache_ttls_.end();
+       ++i)
+  {
+    client.setCacheTTL(i->first, i->second);
+  }
+
+  client.startSessionKeeper(SystemConstants::RWS::Resources::RW_PANEL_CTRLSTATE);
+
+  SubscriptionHub hub(client, resources_);
+  hub.start();
+
+  HTTPServerParams::Ptr p_params = new HTTPServerParams();
+  p_params->setMaxThreads(threads_);
+
+  HTTPServer server(new HandlerFactory(client, hub), ServerSocket(SocketAddress(listen_address_, listen_port_)), p_params);
+  server.start();
+
+  logger().information("Proxying " + controller_ + " on " + listen_address_ + ":" +
+                       NumberFormatter::format(listen_port_));
+
+  waitForTerminationRequest();
+
+  server.stop();
+  hub.stop();
+  client.stopSessionKeeper();
+
+  return Application::EXIT_OK;
+}
+
+} // end namespace
+
+POCO_SERVER_MAIN(RWSProxy)